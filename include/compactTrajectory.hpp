@@ -0,0 +1,217 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include "generationPool.hpp"
+#include <cstddef>
+#include <cstdlib>
+
+//----------------------------------------------------------------------------//
+//                             Compact Trajectory                             //
+//----------------------------------------------------------------------------//
+
+/**
+ * A motion profile stored as only what a follower reads: one column of float
+ * velocities per track and a single timestep, instead of a 64 byte Segment
+ * per track per step. A two track (left/right) chassis path takes 8 bytes per
+ * step instead of 128, so every autonomous route can stay loaded at once.
+ *
+ * Owned trajectories keep all their columns in one malloc block; trajectories
+ * that view constant tables (e.g. compiled paths) or memory in a
+ * GenerationPool own nothing.
+ * @tparam TRACKS number of velocity columns
+ *  - 2 for a skid-steer chassis: left then right
+ *  - one per axis for mechanisms moved together (SyncedProfileController)
+ */
+template <std::size_t TRACKS>
+struct CompactTrajectory
+{
+    static_assert(TRACKS > 0, "A trajectory needs at least one track");
+
+    //Velocity of each track at each step (m/s for paths, degrees/s for
+    //mechanisms)
+    const float * velocity[TRACKS];
+    int length;
+    //Time each step lasts (s)
+    float dt;
+    //Whether the columns are one malloc block, freed by release()
+    bool owned;
+
+    /**
+     * allocates an owned trajectory's columns, left for the caller to fill
+     * through column()
+     * @param ilength number of steps
+     * @param idt time each step lasts
+     *  - units s
+     * @return the trajectory; its columns are null if allocation failed
+     */
+    static CompactTrajectory allocate(int ilength, float idt)
+    {
+        CompactTrajectory trajectory{};
+        auto * block = static_cast<float *>(std::malloc(TRACKS * ilength * sizeof(float)));
+        if(block == nullptr)
+        {
+            return trajectory;
+        }
+
+        for(std::size_t track = 0; track < TRACKS; track++)
+        {
+            trajectory.velocity[track] = block + track * ilength;
+        }
+        trajectory.length = ilength;
+        trajectory.dt = idt;
+        trajectory.owned = true;
+        return trajectory;
+    }
+
+    /**
+     * allocates a trajectory's columns from a pool, e.g. to build one that is
+     * only kept long enough to copy it; the pool frees them, not release()
+     * @param ilength number of steps
+     * @param idt time each step lasts
+     *  - units s
+     * @param ipool pool to take the columns from
+     * @return the trajectory; its columns are null if allocation failed
+     */
+    static CompactTrajectory allocate(int ilength, float idt, GenerationPool &ipool)
+    {
+        CompactTrajectory trajectory{};
+        auto * block = static_cast<float *>(ipool.allocate(TRACKS * ilength * sizeof(float), alignof(float)));
+        if(block == nullptr)
+        {
+            return trajectory;
+        }
+
+        for(std::size_t track = 0; track < TRACKS; track++)
+        {
+            trajectory.velocity[track] = block + track * ilength;
+        }
+        trajectory.length = ilength;
+        trajectory.dt = idt;
+        return trajectory;
+    }
+
+    /**
+     * copies the velocities out of Pathfinder segments
+     * @param itracks segments of each track, all ilength long
+     * @param ilength number of segments
+     * @return the trajectory; its columns are null if allocation failed
+     */
+    static CompactTrajectory fromSegments(const Segment * const (&itracks)[TRACKS], int ilength)
+    {
+        return copySegments(allocate(ilength, (ilength > 0) ? itracks[0][0].dt : 0), itracks, ilength);
+    }
+
+    /**
+     * copies the velocities out of Pathfinder segments into a pool; see
+     * allocate()
+     * @param itracks segments of each track, all ilength long
+     * @param ilength number of segments
+     * @param ipool pool to take the columns from
+     * @return the trajectory; its columns are null if allocation failed
+     */
+    static CompactTrajectory fromSegments(const Segment * const (&itracks)[TRACKS], int ilength,
+        GenerationPool &ipool)
+    {
+        return copySegments(allocate(ilength, (ilength > 0) ? itracks[0][0].dt : 0, ipool), itracks, ilength);
+    }
+
+    /**
+     * fills a trajectory's columns from Pathfinder segments
+     */
+    static CompactTrajectory copySegments(CompactTrajectory trajectory, const Segment * const (&itracks)[TRACKS],
+        int ilength)
+    {
+        if(!trajectory.isValid())
+        {
+            return trajectory;
+        }
+
+        for(std::size_t track = 0; track < TRACKS; track++)
+        {
+            float * out = trajectory.column(track);
+            for(int i = 0; i < ilength; i++)
+            {
+                out[i] = itracks[track][i].velocity;
+            }
+        }
+        return trajectory;
+    }
+
+    /**
+     * @return whether the trajectory has columns
+     */
+    bool isValid() const
+    {
+        return velocity[0] != nullptr;
+    }
+
+    /**
+     * @param track column index
+     * @return a column of an owned trajectory, for filling it
+     */
+    float * column(std::size_t track) const
+    {
+        return const_cast<float *>(velocity[track]);
+    }
+
+    /**
+     * @return memory the columns take
+     *  - units bytes
+     */
+    std::size_t bytes() const
+    {
+        return TRACKS * length * sizeof(float);
+    }
+
+    /**
+     * @return time the trajectory takes to follow
+     *  - units s
+     */
+    double duration() const
+    {
+        return length * static_cast<double>(dt);
+    }
+
+    /**
+     * samples a track at any time, interpolating linearly between steps, so
+     * a follower can run at its own period instead of the timestep. At the
+     * start of each step this is that step's velocity, which a stepped
+     * follower would play; over the last step it ramps to zero.
+     * @param track column index
+     * @param time time since the start of the trajectory
+     *  - units s
+     * @return the velocity; zero before the start and from the end on
+     */
+    float sample(std::size_t track, double time) const
+    {
+        //Also false for NaN
+        if(!(time >= 0) || length == 0)
+        {
+            return 0;
+        }
+
+        const double position = time / dt;
+        if(position >= length)
+        {
+            return 0;
+        }
+
+        const int step = static_cast<int>(position);
+        const float from = velocity[track][step];
+        const float to = (step + 1 < length) ? velocity[track][step + 1] : 0.0f;
+        return from + static_cast<float>(position - step) * (to - from);
+    }
+
+    /**
+     * frees the columns if the trajectory owns them
+     */
+    void release() const
+    {
+        if(owned)
+        {
+            //Every column is in the block the first one starts
+            std::free(column(0));
+        }
+    }
+};
@@ -0,0 +1,179 @@
+//Generated by sim/bin/pathCompiler from paths/autonomous.paths; do not edit.
+//Regenerate with: make -C sim paths
+
+//Header guard
+#pragma once
+
+#include "pathController.hpp"
+
+namespace CompiledPaths
+{
+
+inline constexpr float TO_NEAR_FLAGS_LEFT[] = {
+    0.0199999996, 0.0299999993, 0.0500000007, 0.0700000003, 0.0900000036, 0.109999999, 0.129999995, 0.150000006,
+    0.170000002, 0.189999998, 0.209999993, 0.230000004, 0.25, 0.270000011, 0.289999992, 0.310000002,
+    0.330000013, 0.349999994, 0.370000005, 0.389999986, 0.409999996, 0.430000007, 0.449999988, 0.469999999,
+    0.49000001, 0.50999999, 0.529999971, 0.550000012, 0.569999993, 0.589999974, 0.610000014, 0.629999995,
+    0.649999976, 0.670000017, 0.689999998, 0.709999979, 0.730000019, 0.75, 0.769999981, 0.790000021,
+    0.810000002, 0.829999983, 0.850000024, 0.870000005, 0.889999986, 0.910000026, 0.930000007, 0.949999988,
+    0.970000029, 0.989997387, 0.999923348, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 0.999999404, 0.996787131, 0.978803158, 0.958803177, 0.938803196, 0.918803155,
+    0.898803174, 0.878803194, 0.858803153, 0.838803172, 0.818803191, 0.798803151, 0.77880317, 0.758803189,
+    0.738803148, 0.718803167, 0.698803186, 0.678803146, 0.658803165, 0.638803184, 0.618803144, 0.598803163,
+    0.578803182, 0.558803141, 0.53880316, 0.518803179, 0.498803169, 0.478803158, 0.458803177, 0.438803166,
+    0.418803155, 0.398803174, 0.378803164, 0.358803183, 0.338803172, 0.318803161, 0.29880318, 0.27880317,
+    0.258803159, 0.238803163, 0.218803167, 0.198803172, 0.178803176, 0.158803165, 0.138803169, 0.118803173,
+    0.09880317, 0.0788031667, 0.0588031709, 0.0388031714, 0.01880317, 0.00193739508,
+};
+
+inline constexpr float TO_NEAR_FLAGS_RIGHT[] = {
+    0.0199999996, 0.0299999993, 0.0500000007, 0.0700000003, 0.0900000036, 0.109999999, 0.129999995, 0.150000006,
+    0.170000002, 0.189999998, 0.209999993, 0.230000004, 0.25, 0.270000011, 0.289999992, 0.310000002,
+    0.330000013, 0.349999994, 0.370000005, 0.389999986, 0.409999996, 0.430000007, 0.449999988, 0.469999999,
+    0.49000001, 0.50999999, 0.529999971, 0.550000012, 0.569999993, 0.589999974, 0.610000014, 0.629999995,
+    0.649999976, 0.670000017, 0.689999998, 0.709999979, 0.730000019, 0.75, 0.769999981, 0.790000021,
+    0.810000002, 0.829999983, 0.850000024, 0.870000005, 0.889999986, 0.910000026, 0.930000007, 0.949999988,
+    0.970000029, 0.989997387, 0.999923348, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 0.999999404, 0.996787131, 0.978803158, 0.958803177, 0.938803196, 0.918803155,
+    0.898803174, 0.878803194, 0.858803153, 0.838803172, 0.818803191, 0.798803151, 0.77880317, 0.758803189,
+    0.738803148, 0.718803167, 0.698803186, 0.678803146, 0.658803165, 0.638803184, 0.618803144, 0.598803163,
+    0.578803182, 0.558803141, 0.53880316, 0.518803179, 0.498803169, 0.478803158, 0.458803177, 0.438803166,
+    0.418803155, 0.398803174, 0.378803164, 0.358803183, 0.338803172, 0.318803161, 0.29880318, 0.27880317,
+    0.258803159, 0.238803163, 0.218803167, 0.198803172, 0.178803176, 0.158803165, 0.138803169, 0.118803173,
+    0.09880317, 0.0788031667, 0.0588031709, 0.0388031714, 0.01880317, 0.00193739508,
+};
+
+inline constexpr CompiledPath TO_NEAR_FLAGS{"toNearFlags", TO_NEAR_FLAGS_LEFT, TO_NEAR_FLAGS_RIGHT, 142, 0.00999999978, 0.3175};
+
+inline constexpr float TO_CAP_LEFT[] = {
+    0.0117265219, 0.0224991851, 0.037500076, 0.0525049232, 0.0675161183, 0.0825360417, 0.0975670666, 0.11261154,
+    0.127671778, 0.14275004, 0.15782702, 0.173043519, 0.188174024, 0.203333154, 0.218505517, 0.233689368,
+    0.248907447, 0.264148951, 0.279403776, 0.294696212, 0.310005188, 0.325343549, 0.340710342, 0.356098861,
+    0.371519327, 0.386961073, 0.402432114, 0.41792658, 0.433443576, 0.448986232, 0.464545816, 0.480126232,
+    0.495722473, 0.511330068, 0.526947558, 0.542571366, 0.558195233, 0.573814452, 0.589423656, 0.605016828,
+    0.620586693, 0.636125505, 0.651625037, 0.667076349, 0.682469845, 0.697795331, 0.713041842, 0.728197873,
+    0.743251443, 0.758190036, 0.773000658, 0.787564814, 0.798091412, 0.800004423, 0.800003946, 0.800002873,
+    0.800003648, 0.800004482, 0.800004423, 0.800003409, 0.800003171, 0.800004303, 0.800004423, 0.800003409,
+    0.800003052, 0.800004184, 0.800004065, 0.800002873, 0.80000335, 0.800004005, 0.80000335, 0.800002635,
+    0.800003648, 0.800003409, 0.799917221, 0.799960434, 0.800000608, 0.800037563, 0.800073981, 0.800107419,
+    0.8000018, 0.800002515, 0.800002277, 0.8000018, 0.800002396, 0.800001919, 0.800001979, 0.800002277,
+    0.80000174, 0.800002217, 0.800001919, 0.800002038, 0.800002217, 0.80000186, 0.800002337, 0.800001919,
+    0.800002337, 0.800002158, 0.800002396, 0.800002396, 0.800002456, 0.800002575, 0.800002575, 0.800002813,
+    0.800002694, 0.800002992, 0.800002933, 0.800003171, 0.800003231, 0.80000329, 0.800003588, 0.800003469,
+    0.800004005, 0.800003648, 0.800096571, 0.800070465, 0.800044358, 0.799568713, 0.793830991, 0.784454763,
+    0.775138378, 0.765969992, 0.75704807, 0.748166502, 0.739405334, 0.730755746, 0.722212672, 0.713768363,
+    0.705418825, 0.6971578, 0.688982129, 0.680886865, 0.672869802, 0.664899588, 0.655120611, 0.639460146,
+    0.623286605, 0.607379377, 0.591736138, 0.576351702, 0.561221421, 0.546343029, 0.53171134, 0.517322123,
+    0.503171921, 0.489257365, 0.47557351, 0.462116182, 0.448881209, 0.43586424, 0.423060834, 0.410466313,
+    0.398075908, 0.385884732, 0.373809397, 0.362010866, 0.350395471, 0.338957816, 0.327692479, 0.316594034,
+    0.305657059, 0.294876009, 0.284243584, 0.273755163, 0.263406098, 0.253190517, 0.243099168, 0.233130902,
+    0.223279446, 0.213534415, 0.203898638, 0.194357201, 0.184913948, 0.175555065, 0.166284129, 0.157085642,
+    0.147968009, 0.138910294, 0.129923999, 0.120994858, 0.112113461, 0.103292726, 0.094515726, 0.0857739002,
+    0.0770682842, 0.0684089139, 0.0597763956, 0.051165618, 0.0425733775, 0.0339965336, 0.0254319627, 0.0168765858,
+    0.00832733605, 0.00146976917,
+};
+
+inline constexpr float TO_CAP_RIGHT[] = {
+    0.0117265219, 0.0126767531, 0.0211224612, 0.0295610074, 0.0379900038, 0.0464070886, 0.054809913, 0.0631961524,
+    0.0715635121, 0.0799097121, 0.0882205069, 0.0965710729, 0.10483212, 0.113064542, 0.121256702, 0.129404753,
+    0.13751851, 0.145589411, 0.153609499, 0.161589995, 0.169517383, 0.177397087, 0.18522726, 0.193003237,
+    0.200729996, 0.208401531, 0.216022447, 0.223590359, 0.231106058, 0.238573149, 0.245989472, 0.253360391,
+    0.260687202, 0.267972291, 0.275220633, 0.282436758, 0.289625019, 0.296791434, 0.303942829, 0.311086774,
+    0.318231344, 0.325385541, 0.332559377, 0.339763701, 0.347010255, 0.354311645, 0.361681312, 0.369133562,
+    0.376683444, 0.384346843, 0.39214018, 0.400027066, 0.406100333, 0.408026695, 0.409201562, 0.410597712,
+    0.412216276, 0.414055765, 0.416114777, 0.418391973, 0.420886517, 0.42359665, 0.426518589, 0.429649472,
+    0.432987154, 0.436528474, 0.440268278, 0.444202483, 0.448328406, 0.452640533, 0.457133323, 0.461802483,
+    0.466643929, 0.47165072, 0.476766646, 0.482114464, 0.487610996, 0.493250608, 0.499029368, 0.504940271,
+    0.510890484, 0.517029822, 0.523285925, 0.529654026, 0.53613013, 0.542708099, 0.549384594, 0.556155086,
+    0.563014865, 0.569961548, 0.576990426, 0.584099293, 0.591285169, 0.598545134, 0.605878234, 0.613281608,
+    0.620755196, 0.62829715, 0.635907829, 0.643586755, 0.651334643, 0.659152508, 0.667041421, 0.675003827,
+    0.683041513, 0.691157937, 0.699356019, 0.707640231, 0.716014743, 0.724484682, 0.733055949, 0.741734207,
+    0.750527442, 0.759441674, 0.768576026, 0.777736068, 0.78704375, 0.796059132, 0.799892724, 0.799962938,
+    0.799935997, 0.799910247, 0.800000608, 0.800000191, 0.800000489, 0.799999893, 0.80000025, 0.799999654,
+    0.799999952, 0.799999475, 0.799999714, 0.799999297, 0.799999475, 0.799965799, 0.797626555, 0.787825942,
+    0.776946366, 0.765937746, 0.754803896, 0.743544519, 0.732159853, 0.720652938, 0.709023237, 0.697271109,
+    0.685398102, 0.673406124, 0.661295116, 0.64906615, 0.636720657, 0.624260008, 0.611685753, 0.59899956,
+    0.586203218, 0.573298514, 0.560169637, 0.547066927, 0.533861816, 0.520556808, 0.507154346, 0.493657231,
+    0.480068624, 0.466391534, 0.452626228, 0.438777596, 0.424850404, 0.410847485, 0.396766275, 0.382617354,
+    0.368402869, 0.354118049, 0.339779913, 0.325375885, 0.310924441, 0.296414286, 0.281863242, 0.267256677,
+    0.252620161, 0.237929165, 0.223214298, 0.208461791, 0.193665847, 0.178858995, 0.164022043, 0.149149835,
+    0.134253696, 0.119360514, 0.104445718, 0.0895093456, 0.0745546222, 0.0595847294, 0.0446028151, 0.0296119861,
+    0.0146153234, 0.0025798704,
+};
+
+inline constexpr CompiledPath TO_CAP{"toCap", TO_CAP_LEFT, TO_CAP_RIGHT, 194, 0.00999999978, 0.3175};
+
+inline constexpr float CAP_TO_NEAR_FLAGS_LEFT[] = {
+    0.0117265219, 0.0126767531, 0.0211224612, 0.0295610074, 0.0379900038, 0.0464070886, 0.054809913, 0.0631961524,
+    0.0715635121, 0.0799097121, 0.0882205069, 0.0965710729, 0.10483212, 0.113064542, 0.121256702, 0.129404753,
+    0.13751851, 0.145589411, 0.153609499, 0.161589995, 0.169517383, 0.177397087, 0.18522726, 0.193003237,
+    0.200729996, 0.208401531, 0.216022447, 0.223590359, 0.231106058, 0.238573149, 0.245989472, 0.253360391,
+    0.260687202, 0.267972291, 0.275220633, 0.282436758, 0.289625019, 0.296791434, 0.303942829, 0.311086774,
+    0.318231344, 0.325385541, 0.332559377, 0.339763701, 0.347010255, 0.354311645, 0.361681312, 0.369133562,
+    0.376683444, 0.384346843, 0.39214018, 0.400027066, 0.406100333, 0.408026695, 0.409201562, 0.410597712,
+    0.412216276, 0.414055765, 0.416114777, 0.418391973, 0.420886517, 0.42359665, 0.426518589, 0.429649472,
+    0.432987154, 0.436528474, 0.440268278, 0.444202483, 0.448328406, 0.452640533, 0.457133323, 0.461802483,
+    0.466643929, 0.47165072, 0.476766646, 0.482114464, 0.487610996, 0.493250608, 0.499029368, 0.504940271,
+    0.510890484, 0.517029822, 0.523285925, 0.529654026, 0.53613013, 0.542708099, 0.549384594, 0.556155086,
+    0.563014865, 0.569961548, 0.576990426, 0.584099293, 0.591285169, 0.598545134, 0.605878234, 0.613281608,
+    0.620755196, 0.62829715, 0.635907829, 0.643586755, 0.651334643, 0.659152508, 0.667041421, 0.675003827,
+    0.683041513, 0.691157937, 0.699356019, 0.707640231, 0.716014743, 0.724484682, 0.733055949, 0.741734207,
+    0.750527442, 0.759441674, 0.768576026, 0.777736068, 0.78704375, 0.796059132, 0.799892724, 0.799962938,
+    0.799935997, 0.799910247, 0.800000608, 0.800000191, 0.800000489, 0.799999893, 0.80000025, 0.799999654,
+    0.799999952, 0.799999475, 0.799999714, 0.799999297, 0.799999475, 0.799965799, 0.797626555, 0.787825942,
+    0.776946366, 0.765937746, 0.754803896, 0.743544519, 0.732159853, 0.720652938, 0.709023237, 0.697271109,
+    0.685398102, 0.673406124, 0.661295116, 0.64906615, 0.636720657, 0.624260008, 0.611685753, 0.59899956,
+    0.586203218, 0.573298514, 0.560169637, 0.547066927, 0.533861816, 0.520556808, 0.507154346, 0.493657231,
+    0.480068624, 0.466391534, 0.452626228, 0.438777596, 0.424850404, 0.410847485, 0.396766275, 0.382617354,
+    0.368402869, 0.354118049, 0.339779913, 0.325375885, 0.310924441, 0.296414286, 0.281863242, 0.267256677,
+    0.252620161, 0.237929165, 0.223214298, 0.208461791, 0.193665847, 0.178858995, 0.164022043, 0.149149835,
+    0.134253696, 0.119360514, 0.104445718, 0.0895093456, 0.0745546222, 0.0595847294, 0.0446028151, 0.0296119861,
+    0.0146153234, 0.0025798704,
+};
+
+inline constexpr float CAP_TO_NEAR_FLAGS_RIGHT[] = {
+    0.0117265219, 0.0224991851, 0.037500076, 0.0525049232, 0.0675161183, 0.0825360417, 0.0975670666, 0.11261154,
+    0.127671778, 0.14275004, 0.15782702, 0.173043519, 0.188174024, 0.203333154, 0.218505517, 0.233689368,
+    0.248907447, 0.264148951, 0.279403776, 0.294696212, 0.310005188, 0.325343549, 0.340710342, 0.356098861,
+    0.371519327, 0.386961073, 0.402432114, 0.41792658, 0.433443576, 0.448986232, 0.464545816, 0.480126232,
+    0.495722473, 0.511330068, 0.526947558, 0.542571366, 0.558195233, 0.573814452, 0.589423656, 0.605016828,
+    0.620586693, 0.636125505, 0.651625037, 0.667076349, 0.682469845, 0.697795331, 0.713041842, 0.728197873,
+    0.743251443, 0.758190036, 0.773000658, 0.787564814, 0.798091412, 0.800004423, 0.800003946, 0.800002873,
+    0.800003648, 0.800004482, 0.800004423, 0.800003409, 0.800003171, 0.800004303, 0.800004423, 0.800003409,
+    0.800003052, 0.800004184, 0.800004065, 0.800002873, 0.80000335, 0.800004005, 0.80000335, 0.800002635,
+    0.800003648, 0.800003409, 0.799917221, 0.799960434, 0.800000608, 0.800037563, 0.800073981, 0.800107419,
+    0.8000018, 0.800002515, 0.800002277, 0.8000018, 0.800002396, 0.800001919, 0.800001979, 0.800002277,
+    0.80000174, 0.800002217, 0.800001919, 0.800002038, 0.800002217, 0.80000186, 0.800002337, 0.800001919,
+    0.800002337, 0.800002158, 0.800002396, 0.800002396, 0.800002456, 0.800002575, 0.800002575, 0.800002813,
+    0.800002694, 0.800002992, 0.800002933, 0.800003171, 0.800003231, 0.80000329, 0.800003588, 0.800003469,
+    0.800004005, 0.800003648, 0.800096571, 0.800070465, 0.800044358, 0.799568713, 0.793830991, 0.784454763,
+    0.775138378, 0.765969992, 0.75704807, 0.748166502, 0.739405334, 0.730755746, 0.722212672, 0.713768363,
+    0.705418825, 0.6971578, 0.688982129, 0.680886865, 0.672869802, 0.664899588, 0.655120611, 0.639460146,
+    0.623286605, 0.607379377, 0.591736138, 0.576351702, 0.561221421, 0.546343029, 0.53171134, 0.517322123,
+    0.503171921, 0.489257365, 0.47557351, 0.462116182, 0.448881209, 0.43586424, 0.423060834, 0.410466313,
+    0.398075908, 0.385884732, 0.373809397, 0.362010866, 0.350395471, 0.338957816, 0.327692479, 0.316594034,
+    0.305657059, 0.294876009, 0.284243584, 0.273755163, 0.263406098, 0.253190517, 0.243099168, 0.233130902,
+    0.223279446, 0.213534415, 0.203898638, 0.194357201, 0.184913948, 0.175555065, 0.166284129, 0.157085642,
+    0.147968009, 0.138910294, 0.129923999, 0.120994858, 0.112113461, 0.103292726, 0.094515726, 0.0857739002,
+    0.0770682842, 0.0684089139, 0.0597763956, 0.051165618, 0.0425733775, 0.0339965336, 0.0254319627, 0.0168765858,
+    0.00832733605, 0.00146976917,
+};
+
+inline constexpr CompiledPath CAP_TO_NEAR_FLAGS{"capToNearFlags", CAP_TO_NEAR_FLAGS_LEFT, CAP_TO_NEAR_FLAGS_RIGHT, 194, 0.00999999978, 0.3175};
+
+//Every compiled path, for registering them all at once
+inline constexpr const CompiledPath * ALL[] = {
+    &TO_NEAR_FLAGS,
+    &TO_CAP,
+    &CAP_TO_NEAR_FLAGS,
+};
+
+} // namespace CompiledPaths
@@ -0,0 +1,162 @@
+//Header guard
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                               Generation Pool                              //
+//----------------------------------------------------------------------------//
+
+/**
+ * Memory for the buffers a path needs only while it is generated: its
+ * splines, speed samples, segments and velocity columns. Buffers are handed
+ * out from large blocks one after another and none is freed on its own;
+ * reset() frees them all at once and keeps the blocks for the next path. A
+ * match day of regenerated routes reuses the same few blocks instead of
+ * leaving differently sized holes all over the heap.
+ *
+ * Not thread safe; each generating task needs its own.
+ */
+class GenerationPool
+{
+    public:
+        //Memory the pool is using, in bytes
+        struct Usage
+        {
+            //Handed out since the last reset()
+            std::size_t used;
+            //Most ever handed out between resets
+            std::size_t peak;
+            //Held in blocks, handed out or not
+            std::size_t reserved;
+        };
+
+        //Size of a block, unless one buffer needs more; holds a typical
+        //path's splines and samples
+        static const std::size_t DEFAULT_BLOCK_BYTES = 32 * 1024;
+
+        /**
+         * @param iblockBytes size of each block
+         *  - units bytes
+         */
+        explicit GenerationPool(std::size_t iblockBytes = DEFAULT_BLOCK_BYTES);
+
+        ~GenerationPool();
+
+        //Buffers point into the blocks, so the pool stays put
+        GenerationPool(const GenerationPool &) = delete;
+        GenerationPool &operator=(const GenerationPool &) = delete;
+
+        /**
+         * hands out a buffer, valid until reset() or release()
+         * @param ibytes size of the buffer
+         *  - units bytes
+         * @param ialignment alignment of the buffer; a power of two no more
+         *  than alignof(std::max_align_t)
+         * @return the buffer; null if a block couldn't be allocated
+         */
+        void * allocate(std::size_t ibytes, std::size_t ialignment);
+
+        /**
+         * frees every buffer at once, keeping the blocks for reuse
+         */
+        void reset();
+
+        /**
+         * frees every buffer and every block
+         */
+        void release();
+
+        Usage getUsage() const;
+
+    protected:
+        struct Block
+        {
+            unsigned char * data;
+            std::size_t size;
+        };
+
+        std::size_t blockBytes;
+        std::vector<Block> blocks{};
+        //Block being filled, and how much of it is handed out
+        std::size_t current{0};
+        std::size_t offset{0};
+        std::size_t used{0};
+        std::size_t peak{0};
+};
+
+/**
+ * Standard allocator that takes memory from a GenerationPool, so containers
+ * can hold generation buffers. Freeing is left to the pool. Without a pool,
+ * it uses the heap like std::allocator.
+ * @tparam T element type
+ */
+template <typename T>
+class PoolAllocator
+{
+    public:
+        using value_type = T;
+        //Containers moved into each other keep the moved-from pool
+        using propagate_on_container_move_assignment = std::true_type;
+
+        PoolAllocator() noexcept = default;
+
+        /**
+         * @param ipool pool to take memory from, or nullptr for the heap;
+         *  must outlive every buffer taken from it
+         */
+        explicit PoolAllocator(GenerationPool * ipool) noexcept : pool(ipool)
+        {
+        }
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U> &other) noexcept : pool(other.getPool())
+        {
+        }
+
+        T * allocate(std::size_t n)
+        {
+            void * buffer = pool ? pool->allocate(n * sizeof(T), alignof(T)) : std::malloc(n * sizeof(T));
+            if(buffer == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(buffer);
+        }
+
+        void deallocate(T * p, std::size_t) noexcept
+        {
+            if(!pool)
+            {
+                std::free(p);
+            }
+        }
+
+        GenerationPool * getPool() const noexcept
+        {
+            return pool;
+        }
+
+        template <typename U>
+        bool operator==(const PoolAllocator<U> &other) const noexcept
+        {
+            return pool == other.getPool();
+        }
+
+        template <typename U>
+        bool operator!=(const PoolAllocator<U> &other) const noexcept
+        {
+            return pool != other.getPool();
+        }
+
+    protected:
+        GenerationPool * pool{nullptr};
+};
+
+//A vector whose elements can live in a GenerationPool
+template <typename T>
+using PoolVector = std::vector<T, PoolAllocator<T>>;
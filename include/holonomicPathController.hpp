@@ -0,0 +1,239 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include "compactTrajectory.hpp"
+#include "splineArcLength.hpp"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                          Holonomic Path Controller                         //
+//----------------------------------------------------------------------------//
+
+/**
+ * A waypoint of a holonomic path, in the units generation works in
+ */
+struct HolonomicWaypoint
+{
+    //Position (m)
+    double x;
+    double y;
+    //Direction the robot is travelling at the waypoint (rad)
+    double travel;
+    //Direction the robot is facing at the waypoint (rad)
+    double heading;
+};
+
+/**
+ * A waypoint of a holonomic path
+ */
+struct HolonomicPoint
+{
+    QLength x;
+    QLength y;
+    //Direction the robot is travelling at the waypoint
+    QAngle travel;
+    //Direction the robot is facing at the waypoint
+    QAngle heading;
+};
+
+/**
+ * Generates and follows 2D motion profiles for an X-drive chassis, whose
+ * heading is independent of the direction it drives in: the path is a spline
+ * through the waypoints' positions and travel directions, and the heading
+ * turns from each waypoint's to the next along the way. The robot can strafe
+ * along a route and arrive facing wherever it needs to, instead of turning,
+ * driving and turning again.
+ *
+ * Each step is stored as the four wheel velocities, in the order XDriveModel
+ * keeps its motors. The speed along the path is the fastest that keeps every
+ * wheel within the velocity and acceleration limits (and the velocity limit
+ * within the gearset's), counting the turning as well as the driving; a
+ * chassis drives diagonally no faster than straight, but a wheel's share of a
+ * straight drive is only 1/sqrt(2) of the robot's speed. Speeding up along
+ * the path and swinging the heading are each held to the acceleration limit,
+ * so while doing both at once a wheel can briefly reach twice it.
+ *
+ * Paths are played open loop, by the clock: the follower samples the path at
+ * the time since it started, so it can run at any period set with
+ * setControlPeriod().
+ */
+class HolonomicPathController : public AsyncPositionController<std::string, Point>
+{
+    public:
+        //Top left, top right, bottom right then bottom left wheel velocities
+        using WheelTrajectory = CompactTrajectory<4>;
+
+        /**
+         * @param itimeUtil time utilities for the follower
+         * @param imaxVel maximum wheel velocity; lowered to the gearset's
+         *  top speed if it is above it
+         *  - units m/s
+         * @param imaxAccel maximum wheel acceleration
+         *  - units m/s/s
+         * @param imodel chassis model to control
+         * @param iscales chassis scales; the wheelbase width is the distance
+         *  between the left and right wheels of the square the wheels sit on
+         * @param ipair gearset and gear ratio of the drive
+         */
+        HolonomicPathController(const TimeUtil &itimeUtil, double imaxVel, double imaxAccel,
+            const std::shared_ptr<XDriveModel> &imodel, const ChassisScales &iscales,
+            AbstractMotor::GearsetRatioPair ipair);
+
+        ~HolonomicPathController() override;
+
+        /**
+         * generates a path through the waypoints and saves it as ipathId;
+         * throws std::runtime_error if the path is impossible
+         * @param iwaypoints the waypoints to hit on the path; each must be
+         *  somewhere other than the last
+         * @param ipathId identifier to save the path with
+         */
+        void generatePath(std::initializer_list<HolonomicPoint> iwaypoints, const std::string &ipathId);
+
+        /**
+         * removes a path and frees its memory; stops the follower if it is
+         * following the path
+         * @param ipathId identifier previously passed to generatePath()
+         */
+        void removePath(const std::string &ipathId);
+
+        /**
+         * @return identifiers of all saved paths
+         */
+        std::vector<std::string> getPaths();
+
+        /**
+         * follows a saved path; targets set while a path is followed are
+         * ignored
+         * @param ipathId identifier previously passed to generatePath()
+         */
+        void setTarget(std::string ipathId) override;
+
+        void controllerSet(std::string ivalue) override;
+
+        std::string getTarget() override;
+
+        /**
+         * blocks until the path being followed is finished
+         */
+        void waitUntilSettled() override;
+
+        /**
+         * @return zero; paths are played open loop
+         */
+        Point getError() const override;
+
+        bool isSettled() override;
+
+        /**
+         * stops following the current path
+         */
+        void reset() override;
+
+        void flipDisable() override;
+
+        void flipDisable(bool iisDisabled) override;
+
+        bool isDisabled() const override;
+
+        /**
+         * starts the follower thread; HolonomicPathControllerFactory calls
+         * this
+         */
+        void startThread();
+
+        /**
+         * sets how often the follower updates the motors; takes effect from
+         * the next path
+         * @param iperiod time between updates, or 0 for each path's timestep
+         *  - units s
+         *  - default 0
+         */
+        void setControlPeriod(double iperiod);
+
+        /**
+         * generates the wheel velocities of a holonomic path. Throws
+         * std::runtime_error if the path is impossible.
+         * @param ipoints the waypoints to hit on the path
+         * @param imaxVel maximum wheel velocity
+         *  - units m/s
+         * @param imaxAccel maximum wheel acceleration
+         *  - units m/s/s
+         * @param iwheelbaseWidth distance between the left and right wheels
+         *  - units m
+         * @param iarcLengthTolerance bound on the arc length error of each
+         *  spline
+         *  - units m
+         *  - default DEFAULT_ARC_LENGTH_TOLERANCE
+         * @return the wheel velocities, owned by the caller
+         */
+        static WheelTrajectory generateTrajectory(const std::vector<HolonomicWaypoint> &ipoints, double imaxVel,
+            double imaxAccel, double iwheelbaseWidth, double iarcLengthTolerance = DEFAULT_ARC_LENGTH_TOLERANCE);
+
+    protected:
+        Logger * logger;
+        //Guards paths
+        pros::Mutex pathsLock{};
+        std::map<std::string, WheelTrajectory> paths{};
+        double maxVel{0};
+        double maxAccel{0};
+        std::shared_ptr<XDriveModel> model;
+        ChassisScales scales;
+        AbstractMotor::GearsetRatioPair pair;
+        TimeUtil timeUtil;
+
+        //Path last set as the target, guarded by pathsLock
+        std::string currentPath{""};
+        //Path the follower is playing, guarded by pathsLock; if it is removed
+        //meanwhile, the follower stops and frees it
+        WheelTrajectory playing{};
+        std::atomic_bool playingRemoved{false};
+        std::atomic_bool isRunning{false};
+        //Follower period (s); 0 for each path's timestep
+        std::atomic<double> controlPeriod{0};
+        std::atomic_bool disabled{false};
+        std::atomic_bool dtorCalled{false};
+        CrossplatformThread * task{nullptr};
+
+        static void trampoline(void * context);
+        void loop();
+
+        /**
+         * follows a path by the clock; stops early if the controller is
+         * disabled or the path is removed
+         */
+        virtual void executeSinglePath(const WheelTrajectory &path, std::unique_ptr<AbstractRate> rate);
+
+        /**
+         * converts linear wheel speed to motor speed
+         */
+        QAngularSpeed convertLinearToRotational(QSpeed linear) const;
+
+        /**
+         * describes an impossible path for an exception message
+         */
+        static std::string getPathErrorMessage(const std::vector<HolonomicWaypoint> &points);
+};
+
+class HolonomicPathControllerFactory
+{
+    public:
+        /**
+         * creates a holonomic path controller for an X-drive chassis and
+         * starts its thread; throws std::invalid_argument if the chassis
+         * isn't an X-drive
+         * @param imaxVel maximum wheel velocity
+         *  - units m/s
+         * @param imaxAccel maximum wheel acceleration
+         *  - units m/s/s
+         * @param ichassis chassis to follow paths with
+         * @return the running controller
+         */
+        static std::shared_ptr<HolonomicPathController> create(double imaxVel, double imaxAccel,
+            const ChassisController &ichassis);
+};
@@ -0,0 +1,161 @@
+//Header guard
+#pragma once
+
+#include <cmath>
+#include <ratio>
+
+//----------------------------------------------------------------------------//
+//                               Joystick Curves                              //
+//----------------------------------------------------------------------------//
+
+namespace JoystickCurveMath
+{
+    /**
+     * natural log, usable in constant expressions
+     * @param x argument
+     *  - range (0, inf)
+     * @return ln(x)
+     */
+    constexpr double log(double x)
+    {
+        //Bring x into [0.5, 1] so the series below converges quickly
+        const double LN_2 = 0.693147180559945309417;
+        int exponent = 0;
+        while(x > 1)
+        {
+            x /= 2;
+            exponent++;
+        }
+        while(x < 0.5)
+        {
+            x *= 2;
+            exponent--;
+        }
+
+        //ln(x) = 2 * atanh((x - 1) / (x + 1))
+        double z = (x - 1) / (x + 1);
+        double term = z;
+        double sum = 0;
+        for(int n = 1; n < 60; n += 2)
+        {
+            sum += term / n;
+            term *= z * z;
+        }
+        return 2 * sum + exponent * LN_2;
+    }
+
+    /**
+     * e raised to a power, usable in constant expressions
+     * @param x power
+     * @return e^x
+     */
+    constexpr double exp(double x)
+    {
+        //Sum the series for |x| so its terms never cancel
+        double magnitude = (x < 0) ? -x : x;
+        double term = 1;
+        double sum = 1;
+        for(int n = 1; n < 100 && term > sum * 1e-17; n++)
+        {
+            term *= magnitude / n;
+            sum += term;
+        }
+        return (x < 0) ? 1 / sum : sum;
+    }
+
+    /**
+     * raises a non-negative base to a power, usable in constant expressions
+     * @param base base
+     *  - range [0, inf)
+     * @param power power
+     *  - range (0, inf)
+     * @return base^power
+     */
+    constexpr double pow(double base, double power)
+    {
+        return (base == 0) ? 0 : exp(power * log(base));
+    }
+}
+
+/**
+ * A joystick response curve, tabulated at compile time for every stick value.
+ * Each entry is expCurve(scaleDeadband(input, DEADBAND), EXPONENT, 127), so
+ * looking a value up gives what those functions would have returned without
+ * any floating point work at runtime.
+ * @tparam DEADBAND stick value at/below which the output is 0
+ *  - range [0, 127)
+ * @tparam EXPONENT power to which the scaled input is raised, as a std::ratio
+ *  - default 1
+ */
+template <int DEADBAND, typename EXPONENT = std::ratio<1>>
+class JoystickCurve
+{
+    static_assert(DEADBAND >= 0 && DEADBAND < 127, "Deadband must be within [0, 127)");
+    static_assert(EXPONENT::num > 0, "Exponent must be positive");
+
+    public:
+        static constexpr int MAX_INPUT = 127;
+
+        /**
+         * looks up the curve's output for a stick value
+         * @param input stick value
+         *  - range [-127, 127]
+         * @return shaped value
+         *  - range [-127, 127]
+         */
+        static constexpr double at(int input)
+        {
+            return table.values[clamp(input) + MAX_INPUT];
+        }
+
+        /**
+         * looks up the curve's output for an okapi controller reading
+         * @param analog axis value, as returned by Controller::getAnalog
+         *  - range [-1, 1]
+         * @return shaped value
+         *  - range [-127, 127]
+         */
+        static double fromAnalog(double analog)
+        {
+            return at(static_cast<int>(std::lround(analog * MAX_INPUT)));
+        }
+
+    protected:
+        struct Table
+        {
+            double values[2 * MAX_INPUT + 1];
+        };
+
+        static constexpr int clamp(int input)
+        {
+            return (input > MAX_INPUT) ? MAX_INPUT : (input < -MAX_INPUT) ? -MAX_INPUT : input;
+        }
+
+        /**
+         * evaluates scaleDeadband() then expCurve() for one stick value
+         */
+        static constexpr double evaluate(int input)
+        {
+            int magnitude = (input < 0) ? -input : input;
+            if(magnitude <= DEADBAND)
+            {
+                return 0;
+            }
+            double scaled = (magnitude - DEADBAND) * (static_cast<double>(MAX_INPUT) / (MAX_INPUT - DEADBAND));
+            double shaped = MAX_INPUT *
+                JoystickCurveMath::pow(scaled / MAX_INPUT, static_cast<double>(EXPONENT::num) / EXPONENT::den);
+            return (input < 0) ? -shaped : shaped;
+        }
+
+        static constexpr Table generate()
+        {
+            Table generated{};
+            for(int input = -MAX_INPUT; input <= MAX_INPUT; input++)
+            {
+                generated.values[input + MAX_INPUT] = evaluate(input);
+            }
+            return generated;
+        }
+
+        static constexpr Table table = generate();
+};
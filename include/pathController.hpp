@@ -0,0 +1,919 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include "compactTrajectory.hpp"
+#include "poseSource.hpp"
+#include "splineArcLength.hpp"
+#include "trajectoryRegistry.hpp"
+#include "trajectoryStream.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                               Path Controller                              //
+//----------------------------------------------------------------------------//
+
+/**
+ * A path generated ahead of time by sim/bin/pathCompiler and built into the
+ * program as constant tables, so it costs no generation time or heap
+ */
+struct CompiledPath
+{
+    const char * name;
+    //Wheel velocities at each step (m/s)
+    const float * leftVelocity;
+    const float * rightVelocity;
+    int length;
+    //Time each step lasts (s)
+    float dt;
+    //Wheelbase width the path was compiled for (m)
+    double wheelbaseWidth;
+};
+
+/**
+ * A path queued with PathController::generatePathAsync(). The controller
+ * generates queued paths one at a time on a low priority task; this reports
+ * how far along one is.
+ */
+class PathGeneration
+{
+    public:
+        enum class Status
+        {
+            queued,
+            generating,
+            ready,
+            failed
+        };
+
+        /**
+         * @param ipathId identifier the path is saved with
+         * @param ipoints the waypoints to hit on the path
+         *  - units m, radians
+         */
+        PathGeneration(const std::string &ipathId, const std::vector<Waypoint> &ipoints);
+
+        /**
+         * @return identifier the path is saved with
+         */
+        const std::string &getPathId() const;
+
+        /**
+         * @return handle the path is saved with, for setTarget(); invalid if
+         *  the path was never queued
+         */
+        PathHandle getHandle() const;
+
+        Status getStatus() const;
+
+        /**
+         * @return whether the path is ready or failed
+         */
+        bool isDone() const;
+
+        /**
+         * blocks until the path is ready or failed
+         * @return whether the path is ready
+         */
+        bool wait() const;
+
+        /**
+         * @return why the path failed; empty unless it did
+         */
+        std::string getError() const;
+
+    protected:
+        friend class PathController;
+
+        const std::string pathId;
+        const std::vector<Waypoint> points;
+        //Set before the path is queued
+        PathHandle handle{};
+        std::uint16_t set{0};
+        std::atomic<Status> status{Status::queued};
+        //Written before status is set to failed
+        std::string error{};
+
+        void fail(const std::string &ierror);
+};
+
+/**
+ * How generated paths are timed
+ */
+enum class PathProfile
+{
+    //Pathfinder's jerk limited profile; the limits hold for the center of the
+    //chassis, so the outer wheel goes faster on turns
+    center,
+    //Time optimal along the curve; the velocity and acceleration limits hold
+    //for each wheel, so straights run at full speed and only tight arcs slow
+    //down. Jerk is not limited.
+    wheel
+};
+
+/**
+ * Generates and follows 2D motion profiles for a skid-steer chassis. Works like
+ * okapi's AsyncMotionProfileController, whose source isn't built into this
+ * project, so the path pipeline can be changed here.
+ *
+ * Generated paths are cached in a directory (the SD card by default), keyed by
+ * everything that affects them, so paths that were generated on an earlier
+ * boot are read back instead of regenerated. Paths can also be generated in the
+ * background with generatePathAsync(); following one waits only if it isn't
+ * done yet.
+ *
+ * Saved paths are identified by name, or by the PathHandle generatePath() and
+ * addPath() return; setting a target by handle copies and looks up no strings.
+ * Generated paths share one arena instead of a heap block each, and can be
+ * grouped into route sets that are freed together. The splines, samples and
+ * segments of a path being generated come from a GenerationPool that is
+ * reused for every path, so regenerating routes doesn't fragment the heap.
+ *
+ * Paths queued with queueTarget() are followed back to back without stopping:
+ * each one's deceleration is overlapped with the next one's acceleration.
+ *
+ * Paths are played open loop by default. Given a PoseSource, the follower
+ * instead steers toward where the path should have taken the robot by then,
+ * with the RAMSETE controller, so drift from slipping or lagging wheels is
+ * corrected as the path runs.
+ *
+ * Saved paths play by the clock rather than one step per loop: the follower
+ * samples the path at the time since it started, interpolating between steps,
+ * so it can run at any period set with setControlPeriod() and a late loop
+ * catches up instead of putting the rest of the path behind.
+ *
+ * With setStreaming(), moveTo() starts driving as soon as the speed limits
+ * along the path are worked out, and the follower generates the steps a chunk
+ * at a time just ahead of the one it is playing.
+ */
+class PathController : public AsyncPositionController<std::string, Point>
+{
+    public:
+        //Left then right wheel velocities
+        using TrajectoryPair = CompactTrajectory<2>;
+
+        //Every field of every segment, for tools that look at more than the
+        //follower does
+        struct SegmentPair
+        {
+            std::vector<Segment> left;
+            std::vector<Segment> right;
+        };
+
+        //A path for generateTrajectories(), with generateTrajectory()'s
+        //limits
+        struct PathRequest
+        {
+            std::vector<Waypoint> points;
+            double maxVel;
+            double maxAccel;
+            double maxJerk;
+            PathProfile profile;
+        };
+
+        //What generateTrajectories() made of a request
+        struct PathResult
+        {
+            //Null columns if the path was impossible
+            TrajectoryPair trajectory{};
+            //Why the path was impossible; empty if it wasn't
+            std::string error{};
+        };
+
+        //Memory paths take, in bytes
+        struct MemoryUsage
+        {
+            //Arena of saved paths, now and at most
+            std::size_t saved;
+            std::size_t savedPeak;
+            //Generation buffers of the largest path so far, and the blocks
+            //kept for the next one
+            std::size_t generationPeak;
+            std::size_t generationReserved;
+        };
+
+        //Version of the path cache file format; bump when the format or the
+        //generation pipeline changes so stale files are regenerated
+        static const std::uint32_t CACHE_VERSION = 3;
+
+        //Priority of the generator task; paths generate while every other
+        //task is waiting
+        static const std::uint32_t GENERATOR_PRIORITY = TASK_PRIORITY_MIN;
+
+        //Default RAMSETE gains: how hard position error is corrected
+        //(rad^2/m^2) and the damping of the correction. The correction rate
+        //scales with sqrt(b) * velocity, so b is higher than the usual 2 to
+        //converge within a few feet at VEX speeds (tuned with
+        //sim/bin/followerAccuracy).
+        static constexpr double DEFAULT_RAMSETE_B = 20.0;
+        static constexpr double DEFAULT_RAMSETE_ZETA = 0.7;
+
+        //Steps a streamed path is generated in at a time, and the most that
+        //are held ahead of the follower
+        static const int STREAM_CHUNK_STEPS = 16;
+        static const std::size_t STREAM_BUFFER_STEPS = 2 * STREAM_CHUNK_STEPS;
+
+        //Legs a route holds before queueTarget() has to grow it
+        static const std::size_t ROUTE_CAPACITY = 16;
+
+        /**
+         * @param itimeUtil time utilities for the follower
+         * @param imaxVel maximum velocity
+         *  - units m/s
+         * @param imaxAccel maximum acceleration
+         *  - units m/s/s
+         * @param imaxJerk maximum jerk
+         *  - units m/s/s/s
+         * @param imodel chassis model to control
+         * @param iscales chassis scales; the wheelbase width shapes the paths
+         * @param ipair gearset and gear ratio of the drive
+         */
+        PathController(const TimeUtil &itimeUtil, double imaxVel, double imaxAccel, double imaxJerk,
+            const std::shared_ptr<ChassisModel> &imodel, const ChassisScales &iscales,
+            AbstractMotor::GearsetRatioPair ipair);
+
+        ~PathController() override;
+
+        /**
+         * generates a path through the waypoints and saves it as ipathId, or
+         * reads it from the cache if it was generated before; throws
+         * std::runtime_error if the path is impossible
+         * @param iwaypoints the waypoints to hit on the path
+         * @param ipathId identifier to save the path with
+         * @return handle to the path; the same one if ipathId was saved
+         *  before
+         */
+        PathHandle generatePath(std::initializer_list<Point> iwaypoints, const std::string &ipathId);
+
+        /**
+         * generates a path through waypoints built at runtime; see
+         * generatePath() above
+         * @param ipoints the waypoints to hit on the path
+         *  - units m, radians
+         * @param ipathId identifier to save the path with
+         * @return handle to the path
+         */
+        PathHandle generatePath(const std::vector<Waypoint> &ipoints, const std::string &ipathId);
+
+        /**
+         * generates a path through a range of waypoints, e.g. read from a
+         * file or made by an optimizer; see generatePath() above
+         * @tparam Iterator iterator over Points, or Waypoints in m and radians
+         * @param ifirst the first waypoint
+         * @param ilast one past the last waypoint
+         * @param ipathId identifier to save the path with
+         * @return handle to the path
+         */
+        template <typename Iterator>
+        PathHandle generatePath(Iterator ifirst, Iterator ilast, const std::string &ipathId)
+        {
+            return generatePath(toWaypoints(ifirst, ilast), ipathId);
+        }
+
+        /**
+         * queues a path to be generated (or read from the cache) on the
+         * controller's generator task and returns without waiting for it.
+         * Paths are generated in the order they are queued, except that
+         * setTarget() moves the path it needs to the front. A path already
+         * saved under the identifier stays until the new one is generated.
+         * @param iwaypoints the waypoints to hit on the path
+         * @param ipathId identifier to save the path with
+         * @return the queued path; fails if it is impossible, or is replaced
+         *  or removed before it is generated
+         */
+        std::shared_ptr<PathGeneration> generatePathAsync(std::initializer_list<Point> iwaypoints,
+            const std::string &ipathId);
+
+        /**
+         * queues a path through waypoints built at runtime; see
+         * generatePathAsync() above
+         * @param ipoints the waypoints to hit on the path
+         *  - units m, radians
+         * @param ipathId identifier to save the path with
+         */
+        std::shared_ptr<PathGeneration> generatePathAsync(const std::vector<Waypoint> &ipoints,
+            const std::string &ipathId);
+
+        /**
+         * queues a path through a range of waypoints; see generatePathAsync()
+         * above
+         * @tparam Iterator iterator over Points, or Waypoints in m and radians
+         * @param ifirst the first waypoint
+         * @param ilast one past the last waypoint
+         * @param ipathId identifier to save the path with
+         */
+        template <typename Iterator>
+        std::shared_ptr<PathGeneration> generatePathAsync(Iterator ifirst, Iterator ilast, const std::string &ipathId)
+        {
+            return generatePathAsync(toWaypoints(ifirst, ilast), ipathId);
+        }
+
+        /**
+         * saves a compiled path under its name without copying it; warns if
+         * it was compiled for a different wheelbase
+         * @param ipath the path's tables
+         * @return handle to the path
+         */
+        PathHandle addPath(const CompiledPath &ipath);
+
+        /**
+         * removes a path and frees its memory, or cancels it if it is still
+         * queued; a path being followed is freed once the follower is done
+         * with it
+         * @param ipathId identifier previously passed to generatePath()
+         */
+        void removePath(const std::string &ipathId);
+
+        /**
+         * @return identifiers of all saved paths
+         */
+        std::vector<std::string> getPaths();
+
+        /**
+         * @param ipathId identifier previously passed to generatePath()
+         * @return handle to the path, valid until it is removed; invalid if
+         *  there is no such path
+         */
+        PathHandle getHandle(const std::string &ipathId);
+
+        /**
+         * sets the route set paths generated from now on are saved in, e.g.
+         * one per autonomous routine; paths already queued keep theirs
+         * @param iset the set
+         *  - default 0
+         */
+        void setRouteSet(std::uint16_t iset);
+
+        /**
+         * removes every path in a route set at once, cancelling any still
+         * queued, and frees the memory the set took; a path being followed
+         * is freed once the follower is done with it, and the route's other
+         * legs in the set are skipped
+         * @param iset the set
+         * @return number of paths removed
+         */
+        std::size_t removeRouteSet(std::uint16_t iset);
+
+        /**
+         * @return memory saved paths take, and the most generating one took
+         */
+        MemoryUsage getMemoryUsage();
+
+        /**
+         * sets the directory generated paths are cached in; moveTo()'s
+         * paths are never cached
+         * @param idirectory directory, or empty to stop caching
+         *  - default "/usd"
+         */
+        void setCacheDirectory(const std::string &idirectory);
+
+        /**
+         * sets how accurately spline lengths are measured when generating
+         * paths; looser is faster
+         * @param itolerance bound on the arc length error of each spline
+         *  - units m
+         *  - default DEFAULT_ARC_LENGTH_TOLERANCE
+         */
+        void setArcLengthTolerance(double itolerance);
+
+        /**
+         * sets how generated paths are timed
+         * @param iprofile how the limits are applied
+         *  - default PathProfile::wheel
+         */
+        void setProfile(PathProfile iprofile);
+
+        /**
+         * sets where the follower reads the robot's pose from; takes effect
+         * from the next path
+         * @param isource pose source, or nullptr to follow paths open loop
+         *  - default nullptr
+         */
+        void setPoseSource(const std::shared_ptr<PoseSource> &isource);
+
+        /**
+         * sets the RAMSETE gains used when following paths closed loop
+         * @param ib how hard position error is corrected; higher converges
+         *  faster
+         *  - units rad^2/m^2
+         *  - default DEFAULT_RAMSETE_B
+         * @param izeta damping of the correction
+         *  - range (0, 1)
+         *  - default DEFAULT_RAMSETE_ZETA
+         */
+        void setRamseteGains(double ib, double izeta);
+
+        /**
+         * sets whether moveTo() streams its path: the follower generates it
+         * in chunks while driving instead of all of it first, so the robot
+         * starts moving sooner and the path is never held whole. Streamed
+         * paths are timed with PathProfile::wheel and aren't cached.
+         * @param istreaming whether to stream
+         *  - default false
+         */
+        void setStreaming(bool istreaming);
+
+        /**
+         * sets how often the follower updates the motors while playing saved
+         * paths; takes effect from the next path. Paths don't need
+         * regenerating for a new period. Streamed paths still play one step
+         * per timestep.
+         * @param iperiod time between updates, or 0 for each path's timestep
+         *  - units s
+         *  - default 0
+         */
+        void setControlPeriod(double iperiod);
+
+        /**
+         * follows a saved path, first waiting for it if it was queued with
+         * generatePathAsync() and isn't generated yet; targets set while a
+         * path is followed are ignored
+         * @param ipathId identifier previously passed to generatePath()
+         */
+        void setTarget(std::string ipathId) override;
+
+        /**
+         * follows a saved path
+         * @param ipathId identifier previously passed to generatePath()
+         * @param ibackwards whether to follow the path backwards
+         */
+        void setTarget(std::string ipathId, bool ibackwards);
+
+        /**
+         * follows a saved path like setTarget(std::string) does, without
+         * copying or looking up its name
+         * @param ihandle handle returned when the path was saved
+         */
+        void setTarget(PathHandle ihandle);
+
+        /**
+         * follows a saved path
+         * @param ihandle handle returned when the path was saved
+         * @param ibackwards whether to follow the path backwards
+         */
+        void setTarget(PathHandle ihandle, bool ibackwards);
+
+        /**
+         * adds a saved path to the end of the route being followed, or starts
+         * a new route with it if none is. Each leg of a route starts where
+         * the last one ends, and consecutive legs are blended: the steps where
+         * one slows to a stop are played at the same time as the steps where
+         * the next speeds up, adding their wheel velocities. Each wheel still
+         * travels the same distance, so the robot ends at the same heading;
+         * legs made with the same acceleration blend at a steady speed, and
+         * a corner between curved legs is rounded off. A leg queued after
+         * the previous one started slowing down is followed from rest.
+         * Waits for the path like setTarget() does.
+         * @param ipathId identifier previously passed to generatePath()
+         */
+        void queueTarget(const std::string &ipathId);
+
+        /**
+         * queues a saved path like queueTarget(const std::string &) does
+         * @param ihandle handle returned when the path was saved
+         */
+        void queueTarget(PathHandle ihandle);
+
+        /**
+         * @return index of the leg being followed among the paths set with
+         *  setTarget() and queueTarget() since the route started, or -1 if
+         *  none is; never blocks
+         */
+        int getCurrentLeg() const;
+
+        void controllerSet(std::string ivalue) override;
+
+        std::string getTarget() override;
+
+        /**
+         * blocks until the path being followed is finished
+         */
+        void waitUntilSettled() override;
+
+        /**
+         * generates a path through the waypoints, follows it and removes it;
+         * when streaming, generates it while following it instead, and
+         * returns at once if a path is already being followed
+         * @param iwaypoints the waypoints to hit on the path
+         */
+        void moveTo(std::initializer_list<Point> iwaypoints);
+
+        /**
+         * moves through waypoints built at runtime; see moveTo() above
+         * @param ipoints the waypoints to hit on the path
+         *  - units m, radians
+         */
+        void moveTo(const std::vector<Waypoint> &ipoints);
+
+        /**
+         * moves through a range of waypoints; see moveTo() above
+         * @tparam Iterator iterator over Points, or Waypoints in m and radians
+         * @param ifirst the first waypoint
+         * @param ilast one past the last waypoint
+         */
+        template <typename Iterator>
+        void moveTo(Iterator ifirst, Iterator ilast)
+        {
+            moveTo(toWaypoints(ifirst, ilast));
+        }
+
+        /**
+         * @return how far the robot is from where the path should have taken
+         *  it, in the robot's frame (x ahead, y left); zero when following
+         *  open loop
+         */
+        Point getError() const override;
+
+        bool isSettled() override;
+
+        /**
+         * stops following the current path
+         */
+        void reset() override;
+
+        void flipDisable() override;
+
+        void flipDisable(bool iisDisabled) override;
+
+        bool isDisabled() const override;
+
+        /**
+         * starts the follower and generator threads; PathControllerFactory
+         * calls this
+         */
+        void startThread();
+
+        /**
+         * runs the Pathfinder pipeline, measuring the splines with
+         * splineArcLength.hpp instead of Pathfinder's fixed sample counts;
+         * the controller and the offline path compiler both use this, so
+         * compiled and generated paths match. Throws std::runtime_error if
+         * the path is impossible.
+         * @param ipoints the waypoints to hit on the path
+         *  - units m, radians
+         * @param imaxVel maximum velocity
+         *  - units m/s
+         * @param imaxAccel maximum acceleration
+         *  - units m/s/s
+         * @param imaxJerk maximum jerk
+         *  - units m/s/s/s
+         * @param iwheelbaseWidth distance between the left and right wheels
+         *  - units m
+         * @param iarcLengthTolerance bound on the arc length error of each
+         *  spline
+         *  - units m
+         *  - default DEFAULT_ARC_LENGTH_TOLERANCE
+         * @param iprofile how the limits are applied; jerk is only limited by
+         *  PathProfile::center
+         *  - default PathProfile::wheel
+         * @return the left and right wheel velocities, owned by the caller
+         */
+        static TrajectoryPair generateTrajectory(const std::vector<Waypoint> &ipoints, double imaxVel,
+            double imaxAccel, double imaxJerk, double iwheelbaseWidth,
+            double iarcLengthTolerance = DEFAULT_ARC_LENGTH_TOLERANCE, PathProfile iprofile = PathProfile::wheel);
+
+        /**
+         * generateTrajectory() with every buffer, the result included, taken
+         * from a pool; see generateTrajectory() for the other parameters
+         * @param ipool pool to generate in
+         * @return the left and right wheel velocities, valid until the pool
+         *  is reset
+         */
+        static TrajectoryPair generateTrajectory(const std::vector<Waypoint> &ipoints, double imaxVel,
+            double imaxAccel, double imaxJerk, double iwheelbaseWidth, double iarcLengthTolerance,
+            PathProfile iprofile, GenerationPool &ipool);
+
+        /**
+         * runs the same pipeline as generateTrajectory() but keeps every
+         * field of the left and right segments; see generateTrajectory() for
+         * the parameters
+         */
+        static SegmentPair generateSegments(const std::vector<Waypoint> &ipoints, double imaxVel,
+            double imaxAccel, double imaxJerk, double iwheelbaseWidth,
+            double iarcLengthTolerance = DEFAULT_ARC_LENGTH_TOLERANCE, PathProfile iprofile = PathProfile::wheel);
+
+        /**
+         * runs generateTrajectory() on many paths at once, e.g. to compile
+         * paths offline or to compare candidate routes. On the host
+         * (THREADS_STD) the paths are shared out between threads; on the
+         * robot they are generated one after another on the calling task.
+         * An impossible path doesn't stop the others.
+         * @param irequests the paths
+         * @param iwheelbaseWidth distance between the left and right wheels
+         *  - units m
+         * @param iarcLengthTolerance bound on the arc length error of each
+         *  spline
+         *  - units m
+         *  - default DEFAULT_ARC_LENGTH_TOLERANCE
+         * @param ithreads most threads to use, counting the calling one; each
+         *  generates in a GenerationPool of its own
+         *  - default 0, one per hardware thread
+         * @return one result per request, in the same order; the
+         *  trajectories are owned by the caller
+         */
+        static std::vector<PathResult> generateTrajectories(const std::vector<PathRequest> &irequests,
+            double iwheelbaseWidth, double iarcLengthTolerance = DEFAULT_ARC_LENGTH_TOLERANCE, unsigned ithreads = 0);
+
+    protected:
+        using PathPin = TrajectoryRegistry<2>::Pin;
+
+        //One step of a streamed path, as the follower buffers it (m/s)
+        struct WheelStep
+        {
+            float left;
+            float right;
+        };
+
+        //Closed loop state over one run of the follower
+        struct Tracking
+        {
+            //Null when following open loop
+            std::shared_ptr<PoseSource> source;
+            double b;
+            double zeta;
+            //Pose when the run started
+            Pose start;
+            //Where the path should have taken the robot, relative to start
+            Pose reference;
+            //Center velocity (m/s) and turn rate (rad/s) of the last step
+            double velocity;
+            double turnRate;
+        };
+
+        //Cache file header; the left then right velocity columns follow
+        struct CacheHeader
+        {
+            char magic[4];
+            std::uint32_t version;
+            std::uint64_t key;
+            std::int32_t length;
+            float dt;
+        };
+
+        Logger * logger;
+        //Guards paths, generationQueue and pendingPaths, which the generator
+        //task changes
+        pros::Mutex pathsLock{};
+        TrajectoryRegistry<2> paths{};
+        //Route set new paths are saved in, guarded by pathsLock
+        std::uint16_t routeSet{0};
+        //Guards generationPool, which generatePath() and the generator task
+        //both generate in, and the settings paths are generated and cached
+        //with; taken before pathsLock, never while holding it
+        pros::Mutex generationLock{};
+        GenerationPool generationPool{};
+        std::deque<std::shared_ptr<PathGeneration>> generationQueue{};
+        //Latest queued or generating path for each identifier
+        std::map<std::string, std::shared_ptr<PathGeneration>> pendingPaths{};
+        double maxVel{0};
+        double maxAccel{0};
+        double maxJerk{0};
+        std::shared_ptr<ChassisModel> model;
+        ChassisScales scales;
+        AbstractMotor::GearsetRatioPair pair;
+        TimeUtil timeUtil;
+        std::string cacheDirectory{"/usd"};
+        double arcLengthTolerance{DEFAULT_ARC_LENGTH_TOLERANCE};
+        PathProfile profile{PathProfile::wheel};
+        std::shared_ptr<PoseSource> poseSource{nullptr};
+        std::atomic<double> ramseteB{DEFAULT_RAMSETE_B};
+        std::atomic<double> ramseteZeta{DEFAULT_RAMSETE_ZETA};
+        //Latest closed loop tracking error (m, m, rad)
+        std::atomic<double> errorX{0};
+        std::atomic<double> errorY{0};
+        std::atomic<double> errorTheta{0};
+        std::atomic_bool streaming{false};
+        //Follower period (s); 0 for each path's timestep
+        std::atomic<double> controlPeriod{0};
+
+        //Path last set as the target, guarded by pathsLock
+        PathHandle currentPath{};
+        //Paths of the route being followed, guarded by pathsLock
+        std::vector<PathHandle> route{};
+        std::atomic_int currentLeg{-1};
+        //Path moveTo() is streaming, guarded by pathsLock
+        std::shared_ptr<TrajectoryStream> stream{nullptr};
+        std::atomic_bool isRunning{false};
+        //1 forwards or -1 backwards; set under pathsLock along with the path
+        std::atomic_int direction{1};
+        std::atomic_bool disabled{false};
+        std::atomic_bool dtorCalled{false};
+        CrossplatformThread * task{nullptr};
+        CrossplatformThread * generatorTask{nullptr};
+
+        static void trampoline(void * context);
+        void loop();
+
+        static void generatorTrampoline(void * context);
+        void generatorLoop();
+
+        /**
+         * reads a path from the cache, or generates and caches it; throws
+         * std::runtime_error if the path is impossible. generationLock must
+         * be held.
+         * @return the path, in generationPool until it is reset
+         */
+        TrajectoryPair buildPath(const std::vector<Waypoint> &points, const std::string &ipathId);
+
+        /**
+         * cancels a pending path and frees a saved one; pathsLock must be held
+         */
+        void removePathLocked(const std::string &ipathId);
+
+        /**
+         * cancels a pending path, leaving any saved one; pathsLock must be
+         * held
+         */
+        void cancelPendingLocked(const std::string &ipathId);
+
+        /**
+         * follows a saved path unless one is already being followed
+         * @param ihandle handle of the path
+         * @param idirection 1 to follow it forwards, -1 backwards, or 0 to
+         *  keep the last direction
+         */
+        void startPath(PathHandle ihandle, int idirection);
+
+        /**
+         * waits for a path queued with generatePathAsync(), generating it
+         * before the rest of the queue; returns at once if it isn't queued
+         */
+        void waitForGeneration(const std::string &ipathId);
+
+        /**
+         * waits for a path by handle; looks up its name only if any path is
+         * queued
+         */
+        void waitForGeneration(PathHandle ihandle);
+
+        /**
+         * follows the route from a leg on by the clock, closed loop if there
+         * is a pose source; stops early if the controller is disabled
+         * @param ifirstLeg index in route of the first leg to follow
+         * @return index in route of the first leg not followed
+         */
+        virtual std::size_t executeRoute(std::size_t ifirstLeg, std::unique_ptr<AbstractRate> rate);
+
+        /**
+         * follows a path while generating it, closed loop if there is a pose
+         * source; stops early if the controller is disabled
+         * @param istream the path, from its start
+         */
+        virtual void executeStream(TrajectoryStream &istream, std::unique_ptr<AbstractRate> rate);
+
+        /**
+         * resets the tracking error and reads the starting pose
+         * @return closed loop state for a new run
+         */
+        Tracking startTracking();
+
+        /**
+         * drives the chassis for one step, correcting the wheel velocities
+         * toward the reference pose if there is a pose source
+         * @param ileft left wheel velocity
+         *  - units m/s
+         * @param iright right wheel velocity
+         *  - units m/s
+         * @param ielapsed time since the last step, which the reference
+         *  moves on by; 0 for the first
+         *  - units s
+         * @param tracking closed loop state
+         */
+        void driveStep(double ileft, double iright, double ielapsed, Tracking &tracking);
+
+        /**
+         * finds the first leg of the route at or after an index whose path
+         * exists, warning about the ones that don't
+         * @param ileg index to start from; left at the leg found, or at the
+         *  end of the route
+         * @param out the leg's path, pinned until unpinLegs()
+         * @param outId the leg's identifier
+         * @return whether a leg was found
+         */
+        bool findLeg(std::size_t &ileg, PathPin &out, std::string &outId);
+
+        /**
+         * lets go of the legs findLeg() pinned, freeing any that were removed
+         * while they were followed
+         */
+        void unpinLegs(const PathPin &ipin, const PathPin &inextPin);
+
+        /**
+         * @return first step of the deceleration at the end of a path
+         */
+        static int slowdownStart(const TrajectoryPair &path);
+
+        /**
+         * @return number of steps the end of one leg and the start of the
+         *  next overlap by: the shorter of the first's deceleration and the
+         *  second's acceleration
+         */
+        static int blendSteps(const TrajectoryPair &from, const TrajectoryPair &to);
+
+        /**
+         * hashes everything a generated path depends on; generationLock
+         * must be held
+         * @return the path's cache key
+         */
+        std::uint64_t cacheKey(const std::vector<Waypoint> &points) const;
+
+        /**
+         * @return the cache file for a key
+         */
+        std::string cacheFile(std::uint64_t key) const;
+
+        /**
+         * reads a path from the cache
+         * @param out the path, if it was read
+         * @param ipool pool to read the path into
+         * @return whether a valid cached path was found
+         */
+        bool loadCachedPath(std::uint64_t key, TrajectoryPair &out, GenerationPool &ipool) const;
+
+        /**
+         * writes a path to the cache; failures are logged and otherwise
+         * ignored
+         */
+        void saveCachedPath(std::uint64_t key, const TrajectoryPair &path) const;
+
+        /**
+         * converts linear chassis speed to motor speed
+         */
+        QAngularSpeed convertLinearToRotational(QSpeed linear) const;
+
+        /**
+         * fits and measures a spline between each pair of waypoints; throws
+         * std::runtime_error if there are fewer than two
+         * @param outLength total length of the splines
+         *  - units m
+         * @param ipool pool to hold the splines, or nullptr for the heap
+         */
+        static PoolVector<Spline> fitSplines(const std::vector<Waypoint> &ipoints, double iarcLengthTolerance,
+            double &outLength, GenerationPool * ipool);
+
+        /**
+         * profiles a path with PathProfile::wheel without generating any of
+         * its steps; throws std::runtime_error if the path is impossible
+         * @param ipool pool to hold the splines and samples, or nullptr for
+         *  the heap
+         */
+        static std::unique_ptr<TrajectoryStream> streamTrajectory(const std::vector<Waypoint> &ipoints,
+            double imaxVel, double imaxAccel, double iwheelbaseWidth, double iarcLengthTolerance,
+            GenerationPool * ipool = nullptr);
+
+        /**
+         * generates the left and right segments of a PathProfile::center
+         * path, as generateSegments() does
+         * @param ipool pool to hold the splines and segments, or nullptr for
+         *  the heap
+         */
+        static void generateCenterSegments(const std::vector<Waypoint> &ipoints, double imaxVel,
+            double imaxAccel, double imaxJerk, double iwheelbaseWidth, double iarcLengthTolerance,
+            GenerationPool * ipool, PoolVector<Segment> &outLeft, PoolVector<Segment> &outRight);
+
+        /**
+         * converts a range of waypoints into generation's units
+         */
+        template <typename Iterator>
+        static std::vector<Waypoint> toWaypoints(Iterator ifirst, Iterator ilast)
+        {
+            std::vector<Waypoint> points;
+            for(; ifirst != ilast; ++ifirst)
+            {
+                points.push_back(toWaypoint(*ifirst));
+            }
+            return points;
+        }
+
+        static Waypoint toWaypoint(const Point &ipoint);
+        static Waypoint toWaypoint(const Waypoint &ipoint);
+
+        /**
+         * describes an impossible path for an exception message
+         */
+        static std::string getPathErrorMessage(const std::vector<Waypoint> &points, int length);
+};
+
+class PathControllerFactory
+{
+    public:
+        /**
+         * creates a path controller for a chassis and starts its thread
+         * @param imaxVel maximum velocity
+         *  - units m/s
+         * @param imaxAccel maximum acceleration
+         *  - units m/s/s
+         * @param imaxJerk maximum jerk
+         *  - units m/s/s/s
+         * @param ichassis chassis to follow paths with
+         * @return the running controller
+         */
+        static std::shared_ptr<PathController> create(double imaxVel, double imaxAccel, double imaxJerk,
+            const ChassisController &ichassis);
+};
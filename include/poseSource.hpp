@@ -0,0 +1,77 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include <memory>
+
+//----------------------------------------------------------------------------//
+//                                Pose Source                                 //
+//----------------------------------------------------------------------------//
+
+/**
+ * Position and heading of the robot on the field
+ */
+struct Pose
+{
+    //Position (m)
+    double x;
+    double y;
+    //Heading, counterclockwise from +x (rad)
+    double theta;
+};
+
+/**
+ * Something that knows where the robot is, for closed loop path following.
+ * Only changes in pose matter to PathController, so a source may start
+ * anywhere.
+ */
+class PoseSource
+{
+    public:
+        virtual ~PoseSource() = default;
+
+        /**
+         * @return the robot's current pose
+         */
+        virtual Pose getPose() = 0;
+};
+
+/**
+ * Dead reckoning from a skid-steer chassis's drive encoders. Sees the
+ * wheels' speed, not the robot's, so it corrects for the motors lagging
+ * their targets but not for wheels slipping on the tiles.
+ */
+class EncoderOdometry : public PoseSource
+{
+    public:
+        /**
+         * @param imodel chassis whose encoders to read
+         * @param iscales chassis scales
+         * @param iratio gear ratio from the motors to the wheels
+         */
+        EncoderOdometry(const std::shared_ptr<ChassisModel> &imodel, const ChassisScales &iscales,
+            double iratio = 1);
+
+        /**
+         * integrates the encoder changes since the last call; call at least
+         * as often as the heading changes by a few degrees
+         * @return the robot's current pose
+         */
+        Pose getPose() override;
+
+        /**
+         * sets the current pose
+         * @param ipose the robot's pose
+         */
+        void setPose(const Pose &ipose);
+
+    protected:
+        std::shared_ptr<ChassisModel> model;
+        //Encoder units per meter of wheel travel
+        double ticksPerMeter;
+        double wheelbaseWidth;
+        pros::Mutex lock{};
+        Pose pose{0, 0, 0};
+        double lastLeft{0};
+        double lastRight{0};
+};
@@ -0,0 +1,79 @@
+//Header guard
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+//----------------------------------------------------------------------------//
+//                                 Ring Buffer                                //
+//----------------------------------------------------------------------------//
+
+/**
+ * A fixed-size queue from one producer task to one consumer task. Neither
+ * side takes a lock or allocates, and neither ever waits on the other: the
+ * producer's push fails when the buffer is full, and the consumer's pop
+ * returns nothing when it is empty.
+ * @tparam T item type
+ * @tparam CAPACITY number of items the buffer holds
+ *  - a power of two
+ */
+template <typename T, std::size_t CAPACITY>
+class RingBuffer
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "RingBuffer capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "RingBuffer items must be trivially copyable");
+
+    protected:
+        //Free-running counts of pushed and popped items; only the producer
+        //writes head and only the consumer writes tail
+        std::atomic<std::size_t> head{0};
+        std::atomic<std::size_t> tail{0};
+        T items[CAPACITY];
+
+    public:
+        /**
+         * adds an item; only the producer task may call this
+         * @param item item to add
+         * @return whether there was room for it
+         */
+        bool push(const T &item)
+        {
+            std::size_t write = head.load(std::memory_order_relaxed);
+            if(write - tail.load(std::memory_order_acquire) == CAPACITY)
+            {
+                return false;
+            }
+            items[write & (CAPACITY - 1)] = item;
+            head.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * removes the oldest items; only the consumer task may call this
+         * @param out where to copy the items
+         * @param maxCount most items to remove
+         * @return number of items removed
+         */
+        std::size_t pop(T * out, std::size_t maxCount)
+        {
+            std::size_t read = tail.load(std::memory_order_relaxed);
+            std::size_t available = head.load(std::memory_order_acquire) - read;
+            std::size_t count = (available < maxCount) ? available : maxCount;
+            for(std::size_t i = 0; i < count; i++)
+            {
+                out[i] = items[(read + i) & (CAPACITY - 1)];
+            }
+            tail.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @return number of items waiting; exact only when called by the
+         *  producer or consumer
+         */
+        std::size_t size() const
+        {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+};
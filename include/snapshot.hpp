@@ -0,0 +1,75 @@
+//Header guard
+#pragma once
+
+#include "api.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+//----------------------------------------------------------------------------//
+//                                   Seqlock                                  //
+//----------------------------------------------------------------------------//
+
+/**
+ * Publishes a value from one writer task to any number of reader tasks
+ * without a mutex. The writer never waits; a reader that catches the writer
+ * mid-publish copies the value again. Readers must not run at a higher
+ * priority than the writer, or a retry could wait on a writer that cannot run.
+ */
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock values must be trivially copyable");
+
+    protected:
+        //Odd while a write is in progress
+        std::atomic<std::uint32_t> sequence{0};
+        T value{};
+
+    public:
+        /**
+         * publishes a new value; only one task may write
+         * @param newValue value to publish
+         */
+        void write(const T &newValue)
+        {
+            std::uint32_t start = sequence.load(std::memory_order_relaxed);
+            sequence.store(start + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            value = newValue;
+            sequence.store(start + 2, std::memory_order_release);
+        }
+
+        /**
+         * copies the latest published value
+         * @return the value, never a mix of two writes
+         */
+        T read() const
+        {
+            while(true)
+            {
+                std::uint32_t start = sequence.load(std::memory_order_acquire);
+                if(start & 1)
+                {
+                    //Let the writer finish
+                    pros::delay(1);
+                    continue;
+                }
+                T copy = value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(sequence.load(std::memory_order_relaxed) == start)
+                {
+                    return copy;
+                }
+            }
+        }
+
+        /**
+         * returns whether any value has been published yet
+         * @return whether write() has been called
+         */
+        bool hasValue() const
+        {
+            return sequence.load(std::memory_order_acquire) != 0;
+        }
+};
@@ -0,0 +1,82 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+
+//----------------------------------------------------------------------------//
+//                             Spline Arc Length                              //
+//----------------------------------------------------------------------------//
+
+/**
+ * Arc length of Pathfinder splines by adaptive Simpson quadrature.
+ * pf_spline_distance() and pf_spline_progress_for_distance() integrate with a
+ * fixed number of samples (1000 for PATHFINDER_SAMPLES_FAST), and the second
+ * starts over from the beginning of the spline for every segment. These
+ * subdivide only where the curve bends, so a gentle spline takes a few dozen
+ * evaluations, and they stop at an error bound instead of a sample count.
+ */
+
+//---------- Globals ---------//
+
+//Default bound on arc length error
+//  - units m
+const double DEFAULT_ARC_LENGTH_TOLERANCE = 1e-6;
+
+//--------- Functions --------//
+
+/**
+ * computes the length of part of a spline
+ * @param spline the spline
+ * @param fromProgress where to start measuring
+ *  - range [0, 1]
+ * @param toProgress where to stop measuring
+ *  - range [fromProgress, 1]
+ * @param tolerance bound on the error
+ *  - units m
+ * @return arc length
+ *  - units m
+ */
+double splineArcLength(const Spline &spline, double fromProgress, double toProgress,
+    double tolerance = DEFAULT_ARC_LENGTH_TOLERANCE);
+
+/**
+ * computes the length of a whole spline and stores it in spline.arc_length,
+ * like pf_spline_distance()
+ * @param spline the spline
+ * @param tolerance bound on the error
+ *  - units m
+ * @return arc length
+ *  - units m
+ */
+double splineDistance(Spline &spline, double tolerance = DEFAULT_ARC_LENGTH_TOLERANCE);
+
+/**
+ * computes a spline's curvature
+ * @param spline the spline
+ * @param progress where along the spline
+ *  - range [0, 1]
+ * @return curvature, positive turning counterclockwise
+ *  - units 1/m
+ */
+double splineCurvature(const Spline &spline, double progress);
+
+/**
+ * finds how far along a spline a distance is, like
+ * pf_spline_progress_for_distance(). Passing a known earlier point (e.g. the
+ * previous segment's) measures only the part of the spline after it.
+ * @param spline the spline
+ * @param distance distance from the start of the spline
+ *  - units m
+ * @param tolerance bound on the distance error
+ *  - units m
+ * @param fromProgress progress of a point before distance
+ *  - range [0, 1]
+ *  - default 0
+ * @param fromDistance distance of that point from the start of the spline
+ *  - units m
+ *  - default 0
+ * @return progress along the spline
+ *  - range [0, 1]
+ */
+double splineProgressForDistance(const Spline &spline, double distance,
+    double tolerance = DEFAULT_ARC_LENGTH_TOLERANCE, double fromProgress = 0, double fromDistance = 0);
@@ -1,6 +1,14 @@
 //Header guard
 #pragma once
 
+#include "joystickCurve.hpp"
+#include "pathController.hpp"
+#include "ringBuffer.hpp"
+#include "snapshot.hpp"
+#include "syncedProfileController.hpp"
+#include <atomic>
+#include <memory>
+
 //----------------------------------------------------------------------------//
 //                                Miscellaneous                               //
 //----------------------------------------------------------------------------//
@@ -8,6 +16,9 @@
 //---------- Globals ---------//
 
 extern Controller masterController;
+//Driver profile: opcontrol's stick shaping, swapped by changing these
+using LinearCurve = JoystickCurve<8>;
+using SensitiveCurve = JoystickCurve<8, std::ratio<13, 10>>;
 
 //--------- Functions --------//
 
@@ -32,6 +43,326 @@ double scaleDeadband(double input, double threshold);
  */
 double expCurve(double input, double power, double maxValue);
 
+//----------------------------------------------------------------------------//
+//                                   Sensors                                  //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+//Motors read into each sensor snapshot
+enum SensedMotor
+{
+    DRIVE_LEFT_FRONT,
+    DRIVE_LEFT_BACK,
+    DRIVE_RIGHT_FRONT,
+    DRIVE_RIGHT_BACK,
+    CAP_LIFT,
+    PUNCHER,
+    ANGLE_ADJUSTER,
+    INTAKE,
+    NUM_SENSED_MOTORS
+};
+
+struct MotorSample
+{
+    //Position and target position, in the motor's encoder units
+    double position;
+    double targetPosition;
+    //Velocity (RPM)
+    double velocity;
+    //Current draw (mA)
+    std::int32_t current;
+    //Temperature (degrees C)
+    double temperature;
+};
+
+struct SensorSnapshot
+{
+    //Time the motors were read (ms)
+    std::uint32_t timestamp;
+    MotorSample motors[NUM_SENSED_MOTORS];
+};
+
+extern Seqlock<SensorSnapshot> sensorSnapshot;
+
+//--------- Functions --------//
+
+/**
+ * reads every motor once
+ * @return the readings
+ */
+SensorSnapshot sampleSensors();
+
+/**
+ * gets the latest sensor snapshot, reading the motors directly if the sensor
+ * task hasn't published one yet
+ * @return readings of every motor from the same tick
+ */
+SensorSnapshot getSensorSnapshot();
+
+/**
+ * publishes a sensor snapshot every REFRESH_MS; started by initialize()
+ * @param param unused null parameter
+ */
+void sensorHandler(void * param);
+
+//----------------------------------------------------------------------------//
+//                              Controller Input                              //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+const int NUM_CONTROLLER_AXES = 4;
+const int NUM_CONTROLLER_BUTTONS = 12;
+
+struct ControllerSnapshot
+{
+    //Time the controller was read (ms)
+    std::uint32_t timestamp;
+    //Joystick axes in ControllerAnalog order, in [-1, 1]
+    float analog[NUM_CONTROLLER_AXES];
+    //One bit per button in ControllerDigital order, L1 in bit 0: held now,
+    //pressed since the previous read, released since the previous read
+    std::uint16_t held;
+    std::uint16_t risen;
+    std::uint16_t fallen;
+    //Presses and releases of each button since the input task started
+    std::uint32_t presses[NUM_CONTROLLER_BUTTONS];
+    std::uint32_t releases[NUM_CONTROLLER_BUTTONS];
+};
+
+extern Seqlock<ControllerSnapshot> controllerSnapshot;
+
+/**
+ * One task's view of the controller. Each update() takes the latest snapshot
+ * and reports the presses and releases since that reader's previous update,
+ * so a task running slower than the input task still sees every press once.
+ */
+class ControllerReader
+{
+    protected:
+        ControllerSnapshot latest{};
+        std::uint32_t lastPresses[NUM_CONTROLLER_BUTTONS] = {};
+        std::uint32_t lastReleases[NUM_CONTROLLER_BUTTONS] = {};
+        std::uint16_t newPresses = 0;
+        std::uint16_t newReleases = 0;
+
+    public:
+        /**
+         * starts from the latest snapshot, so presses made before the reader
+         * existed are not reported
+         */
+        ControllerReader();
+
+        /**
+         * takes the latest controller snapshot
+         */
+        void update();
+
+        /**
+         * @param axis joystick axis
+         * @return axis value at the last update
+         *  - range [-1, 1]
+         */
+        double getAnalog(ControllerAnalog axis) const;
+
+        /**
+         * @param button controller button
+         * @return whether the button was held at the last update
+         */
+        bool isPressed(ControllerDigital button) const;
+
+        /**
+         * @param button controller button
+         * @return whether the button was pressed between the last two updates
+         */
+        bool isNewPress(ControllerDigital button) const;
+
+        /**
+         * @param button controller button
+         * @return whether the button was released between the last two updates
+         */
+        bool isNewRelease(ControllerDigital button) const;
+
+        /**
+         * @return time the controller was read for the last update
+         *  - units ms
+         */
+        std::uint32_t getTimestamp() const;
+};
+
+//--------- Functions --------//
+
+/**
+ * reads every axis and button once
+ * @param last the previous reading, to find edges against
+ * @return the reading
+ */
+ControllerSnapshot sampleController(const ControllerSnapshot &last);
+
+/**
+ * publishes a controller snapshot every REFRESH_MS; started by initialize()
+ * @param param unused null parameter
+ */
+void controllerHandler(void * param);
+
+//----------------------------------------------------------------------------//
+//                                  Telemetry                                 //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+enum TelemetryChannel : std::uint16_t
+{
+    //Drive inputs after slew control, as given to arcade(): y, r in [-1, 1]
+    TELEMETRY_DRIVE,
+    //Cap lift position (degrees), velocity (RPM), current (mA)
+    TELEMETRY_CAP_LIFT,
+    //Puncher target and actual position (degrees), angle adjuster position
+    TELEMETRY_PUNCHER
+};
+
+//One record as written to the telemetry file, in the V5's little-endian layout
+struct TelemetryRecord
+{
+    //Time the record was logged (ms)
+    std::uint32_t timestamp;
+    std::uint16_t channel;
+    //Records on this log dropped just before this one because it was full
+    std::uint16_t dropped;
+    float values[3];
+};
+
+/**
+ * Timestamped records from one control task, held until the telemetry task
+ * writes them out. Logging copies 20 bytes into a ring buffer, so it is cheap
+ * enough to do every tick.
+ */
+class TelemetryLog
+{
+    protected:
+        RingBuffer<TelemetryRecord, 256> records;
+        std::uint16_t dropped = 0;
+
+    public:
+        /**
+         * records values; only the task that owns the log may call this
+         * @param channel what the values are
+         * @param a first value
+         * @param b second value
+         * @param c third value
+         *  - default 0
+         */
+        void log(TelemetryChannel channel, float a, float b, float c = 0);
+
+        /**
+         * removes the oldest records; only the telemetry task may call this
+         * @param out where to copy the records
+         * @param maxCount most records to remove
+         * @return number of records removed
+         */
+        std::size_t drain(TelemetryRecord * out, std::size_t maxCount);
+};
+
+//Written by the competition task running opcontrol() or autonomous()
+extern TelemetryLog controlTelemetry;
+//Written by puncherHandler()
+extern TelemetryLog puncherTelemetry;
+//File the telemetry task writes to; it falls back to the serial stream if the
+//file can't be opened (no SD card)
+extern const char * telemetryFile;
+const std::uint32_t TELEMETRY_PERIOD_MS = 50;
+
+//--------- Functions --------//
+
+/**
+ * writes out every log's records every TELEMETRY_PERIOD_MS; started by
+ * initialize() at low priority so file writes never delay the control tasks
+ * @param param unused null parameter
+ */
+void telemetryHandler(void * param);
+
+//----------------------------------------------------------------------------//
+//                                  Profiling                                 //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+//Parts of the control loops timed by a LoopProfiler
+enum LoopSection
+{
+    //Reading the controller
+    SECTION_INPUT,
+    SECTION_DRIVE,
+    SECTION_CAP_LIFT,
+    SECTION_LCD,
+    SECTION_INTAKE,
+    SECTION_PUNCHER,
+    NUM_LOOP_SECTIONS
+};
+
+struct LoopSample
+{
+    //Start of the iteration on the period clock (ns)
+    std::uint64_t start;
+    //Time spent in each section on the cost clock (ns)
+    std::uint64_t sections[NUM_LOOP_SECTIONS];
+};
+
+/**
+ * Times a control loop's iterations section by section. It does nothing until
+ * it is given clocks, so the loops can stay instrumented on the robot.
+ * Samples wait in a ring buffer for whichever task drains them.
+ */
+class LoopProfiler
+{
+    public:
+        //Returns a time in nanoseconds
+        using Clock = std::uint64_t (*)();
+
+    protected:
+        Clock costClock = nullptr;
+        Clock periodClock = nullptr;
+        LoopSample current{};
+        std::uint64_t lastMark = 0;
+        RingBuffer<LoopSample, 1024> samples;
+
+    public:
+        /**
+         * starts profiling; call before the loop's task starts
+         * @param icostClock clock the sections are timed with
+         * @param iperiodClock clock the iteration starts are read from
+         */
+        void enable(Clock icostClock, Clock iperiodClock);
+
+        /**
+         * marks the start of an iteration
+         */
+        void beginIteration();
+
+        /**
+         * charges the time since the last mark to a section
+         * @param section section that just finished
+         */
+        void endSection(LoopSection section);
+
+        /**
+         * marks the end of an iteration's work, before the loop sleeps
+         */
+        void endIteration();
+
+        /**
+         * removes the oldest samples; only one task may call this
+         * @param out where to copy the samples
+         * @param maxCount most samples to remove
+         * @return number of samples removed
+         */
+        std::size_t drain(LoopSample * out, std::size_t maxCount);
+};
+
+extern LoopProfiler opcontrolProfiler;
+extern LoopProfiler puncherProfiler;
+
 //----------------------------------------------------------------------------//
 //                                 Drivetrain                                 //
 //----------------------------------------------------------------------------//
@@ -39,6 +370,8 @@ double expCurve(double input, double power, double maxValue);
 //---------- Globals ---------//
 
 extern ChassisControllerPID drivetrain;
+//Follows autonomous paths; the compiled paths are added in initialize()
+extern std::shared_ptr<PathController> drivetrainPaths;
 extern bool slewEnabled;
 //Slew rate in [-1, 1] units per second
 extern double slewRate_y;
@@ -48,6 +381,15 @@ extern double r_last;
 
 //--------- Functions --------//
 
+/**
+ * limits how far a value may move toward its target in one update
+ * @param target desired value
+ * @param last value after the previous update
+ * @param rate maximum change per update
+ * @return target, or last moved toward target by rate
+ */
+double slewLimit(double target, double last, double rate);
+
 /**
  * sets drivetrain velocity
  * @param y desired forward-backward component
@@ -105,13 +447,19 @@ extern Motor capLiftMotor;
 //---------- Globals ---------//
 
 const int CAPLIFT_VOLTAGE_HOLD = 1500;
+//How far past the puncher's interference range aimAndClearCapLift() sends
+//the cap lift (degrees at the lift)
+const double CAPLIFT_CLEARANCE = 3;
 
 //--------- Functions --------//
 
 /**
  * gets angle of cap lift relative to home/starting position
+ * @param sensors the snapshot to read from
+ *  - default the latest snapshot
  * @return angle of capLiftMotor / gear ratio = angle of cap lift
  */
+double getCapLiftPos(const SensorSnapshot &sensors);
 double getCapLiftPos();
 
 /**
@@ -120,6 +468,12 @@ double getCapLiftPos();
  */
 bool capLiftInterfering();
 
+/**
+ * moves the cap lift to the nearer side of the puncher's interference range
+ * and holds it there; blocks until it is clear
+ */
+void unobstructCapLift();
+
 //----------------------------------------------------------------------------//
 //                                  Puncher                                   //
 //----------------------------------------------------------------------------//
@@ -131,6 +485,9 @@ extern Motor angleAdjuster;
 
 //---------- Globals ---------//
 
+//Moves the angle adjuster and cap lift together, in that order
+extern std::shared_ptr<SyncedProfileController<2>> aimingProfiles;
+
 extern int numLaunches;
 extern bool puncherReady;
 namespace PuncherAngles
@@ -180,15 +537,18 @@ void waitForPuncherReady();
 void setPuncherAngle(PuncherAngle &angle, int speed = 50, bool blocking = false);
 
 /**
- * runs double shot macro
- * @param firstAngle the first angle at which to set the puncher angle
- *  adjuster arm
- *  - units degrees
- * @param secondAngle the second angle at which to set the puncher angle
- *  adjuster arm
- *  - units degrees
+ * sets the angle of the puncher angle adjuster arm and, if the cap lift would
+ * be in the punch's path at that angle, moves it to the nearer side of the
+ * interference range at the same time; both arrive together. Otherwise the
+ * cap lift is left alone. An aim still under way is stopped first.
+ * @param angle the angle at which to set the puncher
+ * @param blocking whether or not to wait for both to arrive
+ *  - default false
+ * @return whether the cap lift is moved; whoever drives it otherwise should
+ *  leave it alone until aimingProfiles settles. False, with the current angle
+ *  unchanged, if another task started a move first.
  */
-void doubleShot(PuncherAngle &firstAngle, PuncherAngle &secondAngle);
+bool aimAndClearCapLift(PuncherAngle &angle, bool blocking = false);
 
 /**
  * handles puncher during opcontrol
@@ -196,6 +556,129 @@ void doubleShot(PuncherAngle &firstAngle, PuncherAngle &secondAngle);
  */
 void puncherHandler(void * param);
 
+//----------------------------------------------------------------------------//
+//                           Puncher State Machine                            //
+//----------------------------------------------------------------------------//
+
+/**
+ * Runs the puncher, angle adjuster and intake macros one step per tick
+ * without blocking, so the task driving it keeps reading the controller while
+ * a shot is in progress. The angle adjuster and, when it is in the punch's
+ * path, the cap lift move together on aimingProfiles. While a macro is moving
+ * the cap lift or loading a ball it owns that motor, and opcontrol leaves it
+ * alone.
+ */
+class PuncherStateMachine
+{
+    public:
+        enum class State
+        {
+            IDLE,
+            //Moving the angle adjuster, and the cap lift if it is in the way,
+            //on its own or before a double shot's first shot
+            AIMING,
+            //Moving the cap lift out of the punch's path before a shot
+            CLEARING_CAP_LIFT,
+            //Puncher turning through a shot
+            FIRING
+        };
+
+    protected:
+        State state = State::IDLE;
+        //Second angle of a double shot still waiting for its shot
+        PuncherAngle * secondAngle = nullptr;
+        //Whether the current shot is the last of a double shot
+        bool finishingDoubleShot = false;
+        //Requests made during a macro, started when it finishes
+        bool launchQueued = false;
+        PuncherAngle * queuedAngle = nullptr;
+        //Puncher position at the end of the current shot (degrees)
+        double puncherTarget = 0;
+        std::atomic<bool> capLiftOwned{false};
+        std::atomic<bool> intakeOwned{false};
+        std::unique_ptr<SettledUtil> puncherSettledUtil;
+        std::unique_ptr<SettledUtil> angleSettledUtil;
+
+        /**
+         * sets the puncher angle, clearing the cap lift along with it if it
+         * is in the punch's path there, and restarts the angle settle timer
+         */
+        void aim(PuncherAngle &angle);
+
+        /**
+         * clears the cap lift if it is in the punch's path, then fires
+         */
+        void startLaunch();
+
+        /**
+         * starts the puncher through one shot
+         */
+        void startFiring();
+
+        /**
+         * ends the current shot and starts whatever follows it
+         */
+        void finishShot();
+
+        /**
+         * hands the cap lift back, goes idle and starts anything requested
+         * during the macro
+         */
+        void finishMacro();
+
+    public:
+        PuncherStateMachine();
+
+        /**
+         * fires one ball; queued if a macro is running
+         */
+        void requestLaunch();
+
+        /**
+         * aims the puncher, clearing the cap lift on the way if it is in the
+         * punch's path; queued if a macro is running
+         * @param angle the angle at which to set the puncher
+         */
+        void requestAngle(PuncherAngle &angle);
+
+        /**
+         * runs the double shot macro: aim, fire, then load the second ball
+         * and fire it while the angle adjuster moves to the second angle;
+         * ignored if a macro is running
+         * @param firstAngle the angle of the first shot
+         * @param secondAngle the angle of the second shot
+         */
+        void requestDoubleShot(PuncherAngle &firstAngle, PuncherAngle &secondAngle);
+
+        /**
+         * advances the macros by one tick; never blocks
+         * @param sensors the tick's sensor snapshot
+         */
+        void update(const SensorSnapshot &sensors);
+
+        /**
+         * @return the current state
+         */
+        State getState() const;
+
+        /**
+         * @return whether a macro is running
+         */
+        bool isBusy() const;
+
+        /**
+         * @return whether the macro is driving the cap lift
+         */
+        bool ownsCapLift() const;
+
+        /**
+         * @return whether the macro is driving the intake
+         */
+        bool ownsIntake() const;
+};
+
+extern PuncherStateMachine puncherStateMachine;
+
 //----------------------------------------------------------------------------//
 //                                   Intake                                   //
 //----------------------------------------------------------------------------//
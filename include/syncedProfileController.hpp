@@ -0,0 +1,431 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include "compactTrajectory.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+//----------------------------------------------------------------------------//
+//                          Synced Profile Controller                         //
+//----------------------------------------------------------------------------//
+
+/**
+ * Moves several motors to absolute positions at once, each on a trapezoidal
+ * profile timed so that every axis finishes at the same moment: the earliest
+ * one the slowest axis allows. Works like okapi's
+ * AsyncLinearMotionProfileController, which drives a single output, so
+ * mechanisms that have to move together don't wait on each other.
+ *
+ * The profiles are stored as one velocity column per axis. Each axis keeps
+ * its own acceleration limit and cruises only as fast as it has to to finish
+ * on time. When the profiles end, every motor holds its target with its own
+ * position controller. A move can leave some axes out, which are then not
+ * driven at all.
+ * @tparam AXES number of motors moved together
+ */
+template <std::size_t AXES>
+class SyncedProfileController : public AsyncPositionController<std::array<double, AXES>, std::array<double, AXES>>
+{
+    public:
+        //Motor positions, one per axis (degrees)
+        using Targets = std::array<double, AXES>;
+        //Which axes a move drives
+        using Axes = std::array<bool, AXES>;
+        //Velocity of each axis at each step (degrees/s)
+        using ProfileSet = CompactTrajectory<AXES>;
+
+        //Limits of one axis, at the motor shaft
+        struct AxisLimits
+        {
+            //Maximum velocity (degrees/s)
+            double maxVel;
+            //Maximum acceleration (degrees/s/s)
+            double maxAccel;
+        };
+
+        /**
+         * @param itimeUtil time utilities for the follower
+         * @param imotors motor of each axis, reading degrees
+         * @param ilimits limits of each axis
+         */
+        SyncedProfileController(const TimeUtil &itimeUtil,
+            const std::array<std::shared_ptr<AbstractMotor>, AXES> &imotors,
+            const std::array<AxisLimits, AXES> &ilimits)
+            : logger(Logger::instance()), motors(imotors), limits(ilimits), timeUtil(itimeUtil)
+        {
+            for(const AxisLimits &limit : limits)
+            {
+                if(!(limit.maxVel > 0 && limit.maxAccel > 0))
+                {
+                    logger->error("SyncedProfileController: Axis limits must be positive.");
+                    throw std::invalid_argument("SyncedProfileController: Axis limits must be positive.");
+                }
+            }
+        }
+
+        ~SyncedProfileController() override
+        {
+            dtorCalled.store(true, std::memory_order_release);
+            delete task;
+        }
+
+        /**
+         * times a move so that every axis finishes together, as early as
+         * the limits allow
+         * @param idistances signed distance each axis moves
+         *  - units degrees
+         * @param ilimits limits of each axis
+         * @param idt timestep
+         *  - units s
+         * @return the velocity of each axis at each step, owned by the caller;
+         *  integrating a column over the steps gives exactly its distance.
+         *  The columns are null if allocation failed.
+         */
+        static ProfileSet generateProfiles(const Targets &idistances, const std::array<AxisLimits, AXES> &ilimits,
+            double idt = 0.010)
+        {
+            //Shortest time each axis could make its move in; the slowest one
+            //sets the time for all of them
+            double duration = 0;
+            for(std::size_t axis = 0; axis < AXES; axis++)
+            {
+                duration = std::max(duration, minimumTime(std::abs(idistances[axis]), ilimits[axis]));
+            }
+
+            //At least one step, so a move that goes nowhere still has columns
+            const int length = std::max(1, static_cast<int>(std::ceil(duration / idt - 1e-9)));
+            ProfileSet profiles = ProfileSet::allocate(length, static_cast<float>(idt));
+            if(!profiles.isValid())
+            {
+                return profiles;
+            }
+
+            for(std::size_t axis = 0; axis < AXES; axis++)
+            {
+                //Ramp at the axis's own acceleration to the cruise velocity
+                //that covers the distance in exactly the shared time:
+                //d = v * (T - v / a)
+                const double distance = std::abs(idistances[axis]);
+                const double accel = ilimits[axis].maxAccel;
+                const double root = std::max(0.0, accel * accel * duration * duration - 4 * accel * distance);
+                const double cruise = (accel * duration - std::sqrt(root)) / 2;
+                const double sign = (idistances[axis] < 0) ? -1 : 1;
+
+                //Each step's velocity is its average, so the column sums to
+                //the distance however the steps line up with the ramps
+                float * out = profiles.column(axis);
+                double last = 0;
+                for(int i = 0; i < length; i++)
+                {
+                    const double next = trapezoidPosition(std::min((i + 1) * idt, duration), duration, cruise,
+                        accel);
+                    out[i] = static_cast<float>(sign * (next - last) / idt);
+                    last = next;
+                }
+            }
+            return profiles;
+        }
+
+        /**
+         * moves every axis to its position from wherever it is now; targets
+         * set while a move is running are ignored
+         * @param itargets position of each motor
+         *  - units degrees
+         */
+        void setTarget(Targets itargets) override
+        {
+            Axes all;
+            all.fill(true);
+            setTarget(itargets, all);
+        }
+
+        /**
+         * moves some of the axes to their positions, leaving the others to
+         * whatever else drives them; see setTarget() above
+         * @param itargets position of each motor; ignored for axes left out
+         *  - units degrees
+         * @param imoving whether the move drives each axis
+         * @return whether the move was started; false if one was running
+         */
+        bool setTarget(Targets itargets, Axes imoving)
+        {
+            lock.take(TIMEOUT_MAX);
+            const bool running = isRunning.load(std::memory_order_acquire);
+            if(!running)
+            {
+                targets = itargets;
+                moving = imoving;
+                isRunning.store(true, std::memory_order_release);
+            }
+            lock.give();
+
+            if(running)
+            {
+                logger->info("SyncedProfileController: Ignoring target because a move is running");
+            }
+            return !running;
+        }
+
+        void controllerSet(Targets ivalue) override
+        {
+            setTarget(ivalue);
+        }
+
+        /**
+         * @return the last target set
+         */
+        Targets getTarget() override
+        {
+            lock.take(TIMEOUT_MAX);
+            Targets current = targets;
+            lock.give();
+            return current;
+        }
+
+        /**
+         * @return how far each motor is from its target; zero for axes the
+         *  last move left out
+         *  - units degrees
+         */
+        Targets getError() const override
+        {
+            lock.take(TIMEOUT_MAX);
+            Targets error = targets;
+            const Axes moved = moving;
+            lock.give();
+
+            for(std::size_t axis = 0; axis < AXES; axis++)
+            {
+                error[axis] = moved[axis] ? error[axis] - motors[axis]->getPosition() : 0;
+            }
+            return error;
+        }
+
+        /**
+         * blocks until the move is finished
+         */
+        void waitUntilSettled() override
+        {
+            auto rate = timeUtil.getRate();
+            while(!isSettled())
+            {
+                rate->delayUntil(10_ms);
+            }
+        }
+
+        /**
+         * @return whether the profiles have finished, or the controller is
+         *  disabled
+         */
+        bool isSettled() override
+        {
+            return isDisabled() || !isRunning.load(std::memory_order_acquire);
+        }
+
+        /**
+         * stops the current move
+         */
+        void reset() override
+        {
+            flipDisable(true);
+
+            auto rate = timeUtil.getRate();
+            while(isRunning.load(std::memory_order_acquire))
+            {
+                rate->delayUntil(1_ms);
+            }
+
+            flipDisable(false);
+        }
+
+        void flipDisable() override
+        {
+            flipDisable(!disabled.load(std::memory_order_acquire));
+        }
+
+        void flipDisable(bool iisDisabled) override
+        {
+            disabled.store(iisDisabled, std::memory_order_release);
+        }
+
+        bool isDisabled() const override
+        {
+            return disabled.load(std::memory_order_acquire);
+        }
+
+        /**
+         * starts the follower thread; SyncedProfileControllerFactory calls
+         * this
+         */
+        void startThread()
+        {
+            if(!task)
+            {
+                task = new CrossplatformThread(trampoline, this);
+            }
+        }
+
+    protected:
+        Logger * logger;
+        std::array<std::shared_ptr<AbstractMotor>, AXES> motors;
+        std::array<AxisLimits, AXES> limits;
+        TimeUtil timeUtil;
+        //Guards targets and moving
+        mutable pros::Mutex lock{};
+        Targets targets{};
+        Axes moving{};
+        std::atomic_bool isRunning{false};
+        std::atomic_bool disabled{false};
+        std::atomic_bool dtorCalled{false};
+        CrossplatformThread * task{nullptr};
+
+        static void trampoline(void * context)
+        {
+            if(context)
+            {
+                static_cast<SyncedProfileController *>(context)->loop();
+            }
+        }
+
+        void loop()
+        {
+            auto rate = timeUtil.getRate();
+
+            while(!dtorCalled.load(std::memory_order_acquire))
+            {
+                if(isRunning.load(std::memory_order_acquire))
+                {
+                    if(!isDisabled())
+                    {
+                        lock.take(TIMEOUT_MAX);
+                        const Targets move = targets;
+                        const Axes moved = moving;
+                        lock.give();
+                        executeMove(move, moved, timeUtil.getRate());
+                    }
+                    isRunning.store(false, std::memory_order_release);
+                }
+
+                rate->delayUntil(10_ms);
+            }
+        }
+
+        /**
+         * generates and follows the profiles from the motors' current
+         * positions, then holds the targets; stops the motors instead if the
+         * controller is disabled partway. Axes left out are not driven.
+         */
+        virtual void executeMove(const Targets &itargets, const Axes &imoving, std::unique_ptr<AbstractRate> rate)
+        {
+            Targets distances;
+            for(std::size_t axis = 0; axis < AXES; axis++)
+            {
+                distances[axis] = imoving[axis] ? itargets[axis] - motors[axis]->getPosition() : 0;
+            }
+
+            ProfileSet profiles = generateProfiles(distances, limits);
+            if(!profiles.isValid())
+            {
+                logger->error("SyncedProfileController: Could not allocate the profiles.");
+                return;
+            }
+
+            for(int i = 0; i < profiles.length && !isDisabled() && !dtorCalled.load(std::memory_order_acquire); i++)
+            {
+                for(std::size_t axis = 0; axis < AXES; axis++)
+                {
+                    if(!imoving[axis])
+                    {
+                        continue;
+                    }
+                    //degrees/s to RPM
+                    motors[axis]->moveVelocity(static_cast<std::int16_t>(std::lround(profiles.velocity[axis][i] / 6)));
+                }
+                rate->delayUntil(profiles.dt * second);
+            }
+            profiles.release();
+
+            for(std::size_t axis = 0; axis < AXES; axis++)
+            {
+                if(!imoving[axis])
+                {
+                    continue;
+                }
+                if(isDisabled())
+                {
+                    motors[axis]->moveVelocity(0);
+                }
+                else
+                {
+                    //Take out what rounding and motor lag left over
+                    motors[axis]->moveAbsolute(itargets[axis],
+                        static_cast<std::int32_t>(std::lround(limits[axis].maxVel / 6)));
+                }
+            }
+        }
+
+        /**
+         * @return shortest time a trapezoidal profile covers a distance in
+         *  - units s
+         */
+        static double minimumTime(double distance, const AxisLimits &limit)
+        {
+            //Triangular if the axis can't reach full speed in half the distance
+            if(distance * limit.maxAccel < limit.maxVel * limit.maxVel)
+            {
+                return 2 * std::sqrt(distance / limit.maxAccel);
+            }
+            return distance / limit.maxVel + limit.maxVel / limit.maxAccel;
+        }
+
+        /**
+         * @return distance covered by a symmetric trapezoid after some time
+         *  - units degrees
+         */
+        static double trapezoidPosition(double time, double duration, double cruise, double accel)
+        {
+            if(cruise <= 0)
+            {
+                return 0;
+            }
+
+            const double ramp = cruise / accel;
+            const double rampDistance = cruise * ramp / 2;
+            if(time < ramp)
+            {
+                return accel * time * time / 2;
+            }
+            if(time < duration - ramp)
+            {
+                return rampDistance + cruise * (time - ramp);
+            }
+            const double remaining = duration - time;
+            return cruise * (duration - ramp) - accel * remaining * remaining / 2;
+        }
+};
+
+class SyncedProfileControllerFactory
+{
+    public:
+        /**
+         * creates a synced profile controller and starts its thread
+         * @param imotors motor of each axis, reading degrees
+         * @param ilimits limits of each axis
+         * @return the running controller
+         */
+        template <std::size_t AXES>
+        static std::shared_ptr<SyncedProfileController<AXES>> create(
+            const std::array<std::shared_ptr<AbstractMotor>, AXES> &imotors,
+            const std::array<typename SyncedProfileController<AXES>::AxisLimits, AXES> &ilimits)
+        {
+            auto controller = std::make_shared<SyncedProfileController<AXES>>(TimeUtilFactory::create(), imotors,
+                ilimits);
+            controller->startThread();
+            return controller;
+        }
+};
@@ -0,0 +1,563 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include "compactTrajectory.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                             Trajectory Registry                            //
+//----------------------------------------------------------------------------//
+
+/**
+ * Refers to a trajectory saved in a TrajectoryRegistry without naming it, so
+ * following it needs no string copies or lookups. A handle to a removed
+ * trajectory stays invalid even once its slot is reused.
+ */
+struct PathHandle
+{
+    //Index of the registry slot
+    std::uint16_t slot;
+    //Which use of the slot the handle is for; zero for no trajectory
+    std::uint16_t generation;
+
+    /**
+     * @return whether the handle was ever given out; a valid handle can
+     *  still be for a removed trajectory
+     */
+    bool isValid() const
+    {
+        return generation != 0;
+    }
+
+    bool operator==(const PathHandle &other) const
+    {
+        return slot == other.slot && generation == other.generation;
+    }
+
+    bool operator!=(const PathHandle &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * Saves trajectories by name and hands out a PathHandle for each, which finds
+ * it again in constant time. The name stays the handle's for as long as it is
+ * saved: replacing a trajectory keeps its handle.
+ *
+ * Owned trajectories are copied into an arena of large blocks, one after
+ * another, instead of each keeping its own malloc block; a block is freed once
+ * every trajectory in it is removed and nothing has it pinned. Views of
+ * constant tables (e.g. compiled paths) are saved as they are.
+ *
+ * A trajectory read outside the owner's lock, e.g. while it is followed, is
+ * pinned with pin(): removing or replacing it then leaves its columns in place
+ * until unpin().
+ *
+ * Trajectories can be grouped into sets, e.g. the routes of one autonomous
+ * routine. Each set fills its own blocks, so removeSet() frees a whole set at
+ * once and leaves no gaps among the others.
+ *
+ * Not thread safe; the owner guards it.
+ * @tparam TRACKS number of velocity columns of each trajectory
+ */
+template <std::size_t TRACKS>
+class TrajectoryRegistry
+{
+    public:
+        using Trajectory = CompactTrajectory<TRACKS>;
+
+        //A trajectory whose columns stay valid until it is passed to unpin()
+        struct Pin
+        {
+            //Null columns if there was nothing to pin
+            Trajectory trajectory{};
+            bool inArena{false};
+            std::uint32_t block{0};
+        };
+
+        //Steps an arena block holds, unless one trajectory needs more
+        static constexpr int DEFAULT_BLOCK_STEPS = 2048;
+
+        /**
+         * @param iblockSteps steps of every track an arena block holds
+         */
+        explicit TrajectoryRegistry(int iblockSteps = DEFAULT_BLOCK_STEPS) : blockSteps(iblockSteps)
+        {
+        }
+
+        ~TrajectoryRegistry()
+        {
+            for(Block &block : blocks)
+            {
+                std::free(block.data);
+            }
+        }
+
+        //Handles index this registry's slots, so it stays put
+        TrajectoryRegistry(const TrajectoryRegistry &) = delete;
+        TrajectoryRegistry &operator=(const TrajectoryRegistry &) = delete;
+
+        /**
+         * saves a trajectory, replacing any saved under the same name. Takes
+         * the trajectory: an owned one is copied into the arena and released.
+         * @param iname name to save the trajectory under
+         * @param itrajectory the trajectory
+         * @param iset set to save the trajectory in
+         * @return handle to the trajectory; invalid if the arena couldn't
+         *  grow, in which case nothing is saved under the name
+         */
+        PathHandle insert(const std::string &iname, const Trajectory &itrajectory, std::uint16_t iset = 0)
+        {
+            if(itrajectory.owned)
+            {
+                const PathHandle handle = insertCopy(iname, itrajectory, iset);
+                itrajectory.release();
+                return handle;
+            }
+
+            const PathHandle handle = reserve(iname, iset);
+            if(handle.isValid())
+            {
+                Slot &slot = slots[handle.slot];
+                clear(slot);
+                slot.set = iset;
+                slot.trajectory = itrajectory;
+            }
+            return handle;
+        }
+
+        /**
+         * saves a copy of a trajectory in the arena, e.g. of one built in
+         * memory that is about to be reused; see insert()
+         * @param iname name to save the trajectory under
+         * @param itrajectory the trajectory, left as it is
+         * @param iset set to save the trajectory in
+         * @return handle to the trajectory; invalid if the arena couldn't
+         *  grow, in which case whatever was saved under the name stays
+         */
+        PathHandle insertCopy(const std::string &iname, const Trajectory &itrajectory, std::uint16_t iset = 0)
+        {
+            const bool named = names.find(iname) != names.end();
+            const PathHandle handle = reserve(iname, iset);
+            if(!handle.isValid())
+            {
+                return handle;
+            }
+
+            const int length = itrajectory.length;
+            std::uint32_t block;
+            float * columns = allocate(static_cast<int>(TRACKS) * length, iset, block);
+            if(columns == nullptr)
+            {
+                //Only give back a handle made for this copy
+                if(!named)
+                {
+                    remove(handle);
+                }
+                return PathHandle{};
+            }
+
+            //The old trajectory stays until the new one is in place
+            Slot &slot = slots[handle.slot];
+            clear(slot);
+            slot.set = iset;
+            slot.block = block;
+            for(std::size_t track = 0; track < TRACKS; track++)
+            {
+                std::memcpy(columns + track * length, itrajectory.velocity[track], length * sizeof(float));
+                slot.trajectory.velocity[track] = columns + track * length;
+            }
+            slot.trajectory.length = length;
+            slot.trajectory.dt = itrajectory.dt;
+            //The arena owns the columns, not the trajectory
+            slot.trajectory.owned = false;
+            slot.inArena = true;
+            return handle;
+        }
+
+        /**
+         * gives a name a handle before its trajectory exists, e.g. while it
+         * generates; any trajectory saved under the name stays until the new
+         * one is inserted
+         * @param iname name to save the trajectory under
+         * @param iset set the trajectory will be in, if the name is new
+         * @return handle the trajectory will have; invalid if every slot is
+         *  taken
+         */
+        PathHandle reserve(const std::string &iname, std::uint16_t iset = 0)
+        {
+            auto found = names.find(iname);
+            if(found != names.end())
+            {
+                return found->second;
+            }
+
+            std::uint16_t index;
+            if(!freeSlots.empty())
+            {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else if(slots.size() < MAX_SLOTS)
+            {
+                index = static_cast<std::uint16_t>(slots.size());
+                slots.emplace_back();
+            }
+            else
+            {
+                return PathHandle{};
+            }
+
+            Slot &slot = slots[index];
+            slot.name = iname;
+            slot.set = iset;
+            const PathHandle handle{index, slot.generation};
+            names.emplace(iname, handle);
+            return handle;
+        }
+
+        /**
+         * @param iname name a trajectory was saved or reserved under
+         * @return its handle; invalid if there is none
+         */
+        PathHandle find(const std::string &iname) const
+        {
+            auto found = names.find(iname);
+            return (found != names.end()) ? found->second : PathHandle{};
+        }
+
+        /**
+         * @param ihandle handle from insert(), reserve() or find()
+         * @return the trajectory, valid until it is replaced or removed; null
+         *  if the handle's trajectory was removed or doesn't exist yet
+         */
+        const Trajectory * get(PathHandle ihandle) const
+        {
+            if(!isCurrent(ihandle) || !slots[ihandle.slot].trajectory.isValid())
+            {
+                return nullptr;
+            }
+            return &slots[ihandle.slot].trajectory;
+        }
+
+        /**
+         * keeps a trajectory's columns valid, even if it is removed or
+         * replaced, until unpin()
+         * @param ihandle handle from insert(), reserve() or find()
+         * @return the pin; its trajectory has null columns if get() would
+         *  return null, and then it needn't be unpinned
+         */
+        Pin pin(PathHandle ihandle)
+        {
+            Pin out{};
+            const Trajectory * trajectory = get(ihandle);
+            if(trajectory == nullptr)
+            {
+                return out;
+            }
+
+            const Slot &slot = slots[ihandle.slot];
+            out.trajectory = *trajectory;
+            out.inArena = slot.inArena;
+            out.block = slot.block;
+            if(out.inArena)
+            {
+                findBlock(out.block)->pins++;
+            }
+            return out;
+        }
+
+        /**
+         * lets go of a trajectory from pin(), freeing its columns if it was
+         * removed in the meantime
+         * @param ipin the pin
+         */
+        void unpin(const Pin &ipin)
+        {
+            if(!ipin.inArena)
+            {
+                return;
+            }
+
+            auto block = findBlock(ipin.block);
+            if(block != blocks.end())
+            {
+                block->pins--;
+                recycle(block);
+            }
+        }
+
+        /**
+         * @param ihandle handle from insert(), reserve() or find()
+         * @return name the handle's trajectory is saved under; empty if it was
+         *  removed
+         */
+        std::string getName(PathHandle ihandle) const
+        {
+            return isCurrent(ihandle) ? slots[ihandle.slot].name : "";
+        }
+
+        /**
+         * @return names of every saved trajectory, in order
+         */
+        std::vector<std::string> getNames() const
+        {
+            std::vector<std::string> out;
+            for(const auto &name : names)
+            {
+                if(slots[name.second.slot].trajectory.isValid())
+                {
+                    out.push_back(name.first);
+                }
+            }
+            return out;
+        }
+
+        /**
+         * frees a trajectory and its name; its handle becomes invalid
+         * @param ihandle handle from insert(), reserve() or find()
+         * @return whether there was anything to remove
+         */
+        bool remove(PathHandle ihandle)
+        {
+            if(!isCurrent(ihandle))
+            {
+                return false;
+            }
+
+            Slot &slot = slots[ihandle.slot];
+            clear(slot);
+            names.erase(slot.name);
+            slot.name.clear();
+            //Skip zero, which no handle is given out with
+            slot.generation = (slot.generation == UINT16_MAX) ? 1 : slot.generation + 1;
+            freeSlots.push_back(ihandle.slot);
+            return true;
+        }
+
+        /**
+         * frees a trajectory and its name
+         * @param iname name the trajectory was saved or reserved under
+         * @return whether there was anything to remove
+         */
+        bool remove(const std::string &iname)
+        {
+            return remove(find(iname));
+        }
+
+        /**
+         * frees every trajectory in a set, and every block the set filled, at
+         * once; their handles become invalid. Pinned blocks are freed when
+         * they are unpinned instead.
+         * @param iset the set
+         * @return number of trajectories removed
+         */
+        std::size_t removeSet(std::uint16_t iset)
+        {
+            std::size_t removed = 0;
+            for(std::size_t i = 0; i < slots.size(); i++)
+            {
+                const Slot &slot = slots[i];
+                if(slot.set == iset && !slot.name.empty() &&
+                    remove(PathHandle{static_cast<std::uint16_t>(i), slot.generation}))
+                {
+                    removed++;
+                }
+            }
+
+            //Nothing is left in the set's blocks, including the one clear()
+            //kept to fill again, so none of them is filled again
+            for(Block &block : blocks)
+            {
+                if(block.set == iset)
+                {
+                    block.retired = true;
+                }
+            }
+            for(std::size_t i = blocks.size(); i-- > 0;)
+            {
+                if(blocks[i].set == iset)
+                {
+                    recycle(blocks.begin() + i);
+                }
+            }
+            return removed;
+        }
+
+        /**
+         * @return memory the arena holds, used or not
+         *  - units bytes
+         */
+        std::size_t getArenaBytes() const
+        {
+            return arenaBytes;
+        }
+
+        /**
+         * @return most memory the arena has held at once
+         *  - units bytes
+         */
+        std::size_t getPeakArenaBytes() const
+        {
+            return peakArenaBytes;
+        }
+
+    protected:
+        //Handles index slots with 16 bits
+        static constexpr std::size_t MAX_SLOTS = UINT16_MAX + 1;
+
+        struct Slot
+        {
+            std::string name{};
+            std::uint16_t generation{1};
+            Trajectory trajectory{};
+            std::uint16_t set{0};
+            //Arena block the columns are in, if they are
+            bool inArena{false};
+            std::uint32_t block{0};
+        };
+
+        struct Block
+        {
+            float * data;
+            std::uint32_t id;
+            std::uint16_t set;
+            //Floats the block holds and has handed out
+            int capacity;
+            int used;
+            //Trajectories still in the block, and pins on it
+            int live;
+            int pins;
+            //Freed rather than filled again once it is empty
+            bool retired;
+        };
+
+        int blockSteps;
+        std::vector<Slot> slots{};
+        std::vector<std::uint16_t> freeSlots{};
+        std::map<std::string, PathHandle> names{};
+        //The last block of each set is the one being filled
+        std::vector<Block> blocks{};
+        std::uint32_t nextBlockId{0};
+        std::size_t arenaBytes{0};
+        std::size_t peakArenaBytes{0};
+
+        bool isCurrent(PathHandle ihandle) const
+        {
+            return ihandle.slot < slots.size() && slots[ihandle.slot].generation == ihandle.generation;
+        }
+
+        /**
+         * @return the block a set is filling; blocks.end() if it has none
+         */
+        typename std::vector<Block>::iterator currentBlock(std::uint16_t iset)
+        {
+            auto found = std::find_if(blocks.rbegin(), blocks.rend(),
+                [iset](const Block &block) { return block.set == iset && !block.retired; });
+            return (found == blocks.rend()) ? blocks.end() : std::prev(found.base());
+        }
+
+        /**
+         * @return the block with an id; blocks.end() if it was freed
+         */
+        typename std::vector<Block>::iterator findBlock(std::uint32_t iid)
+        {
+            return std::find_if(blocks.begin(), blocks.end(),
+                [iid](const Block &block) { return block.id == iid; });
+        }
+
+        /**
+         * frees a block that nothing is in or pins any more; the block a set
+         * is filling is started over instead
+         */
+        void recycle(typename std::vector<Block>::iterator block)
+        {
+            if(block->live > 0 || block->pins > 0)
+            {
+                return;
+            }
+
+            if(block == currentBlock(block->set))
+            {
+                block->used = 0;
+            }
+            else
+            {
+                arenaBytes -= block->capacity * sizeof(float);
+                std::free(block->data);
+                blocks.erase(block);
+            }
+        }
+
+        /**
+         * hands out space in a set's blocks
+         * @param ifloats floats needed
+         * @param iset set the space is for
+         * @param outBlock id of the block the space is in
+         * @return the space; null if a block couldn't be allocated
+         */
+        float * allocate(int ifloats, std::uint16_t iset, std::uint32_t &outBlock)
+        {
+            auto current = currentBlock(iset);
+            if(current != blocks.end() && current->capacity - current->used >= ifloats)
+            {
+                float * out = current->data + current->used;
+                current->used += ifloats;
+                current->live++;
+                outBlock = current->id;
+                return out;
+            }
+
+            const int standard = blockSteps * static_cast<int>(TRACKS);
+            const int capacity = std::max(ifloats, standard);
+            auto * data = static_cast<float *>(std::malloc(std::max(capacity, 1) * sizeof(float)));
+            if(data == nullptr)
+            {
+                return nullptr;
+            }
+            arenaBytes += capacity * sizeof(float);
+            peakArenaBytes = std::max(peakArenaBytes, arenaBytes);
+
+            const Block block{data, nextBlockId++, iset, capacity, ifloats, 1, 0, false};
+            if(ifloats > standard && current != blocks.end())
+            {
+                //An oversized trajectory gets a block to itself, and the one
+                //being filled carries on
+                blocks.insert(current, block);
+            }
+            else
+            {
+                blocks.push_back(block);
+            }
+            outBlock = block.id;
+            return data;
+        }
+
+        /**
+         * frees a slot's trajectory, and its block if nothing else is in it
+         * or pins it
+         */
+        void clear(Slot &slot)
+        {
+            if(slot.inArena)
+            {
+                auto block = findBlock(slot.block);
+                if(block != blocks.end())
+                {
+                    block->live--;
+                    recycle(block);
+                }
+            }
+            slot.trajectory = Trajectory{};
+            slot.inArena = false;
+        }
+};
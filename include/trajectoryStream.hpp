@@ -0,0 +1,203 @@
+//Header guard
+#pragma once
+
+#include "main.h"
+#include "generationPool.hpp"
+#include <functional>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                                Spline Cursor                               //
+//----------------------------------------------------------------------------//
+
+/**
+ * Places segments along a path of splines by their distance from its start,
+ * as pathfinder_generate() does. Segments must come in order of position;
+ * each search continues from the last one, so placing a whole path measures
+ * each spline about once.
+ */
+class SplineCursor
+{
+    public:
+        /**
+         * @param isplines the path, measured with splineDistance(); must
+         *  outlive the cursor
+         * @param iarcLengthTolerance bound on the distance error of each
+         *  placement
+         *  - units m
+         */
+        SplineCursor(const PoolVector<Spline> &isplines, double iarcLengthTolerance);
+
+        /**
+         * sets a segment's x, y and heading from its position
+         * @param segment segment to place
+         */
+        void place(Segment &segment);
+
+    protected:
+        const PoolVector<Spline> &splines;
+        double arcLengthTolerance;
+        //Spline the last segment was on, and where along it
+        std::size_t index{0};
+        double splineStart{0};
+        double lastProgress{0};
+        double lastDistance{0};
+};
+
+//----------------------------------------------------------------------------//
+//                                Speed Profile                               //
+//----------------------------------------------------------------------------//
+
+/**
+ * The fastest way along a path under a speed and acceleration limit that
+ * change along it, starting and ending at rest. Built on samples close enough
+ * that the limits barely change between neighbours; acceleration is constant
+ * between samples.
+ */
+class SpeedProfile
+{
+    public:
+        struct Sample
+        {
+            //Distance from the start of the path (m)
+            double distance;
+            //Limits at the sample (m/s, m/s/s)
+            double maxVel;
+            double maxAccel;
+            //Filled in by the profile: speed at the sample (m/s) and time
+            //it is reached (s)
+            double velocity;
+            double time;
+        };
+
+        /**
+         * @param isamples samples with their distance and limits filled in,
+         *  at least two, in order of distance
+         */
+        explicit SpeedProfile(PoolVector<Sample> isamples);
+
+        /**
+         * @return time the profile takes
+         *  - units s
+         */
+        double getDuration() const;
+
+        /**
+         * finds where along the path the profile is at a time; times must not
+         * go backwards between calls
+         * @param time time since the start
+         *  - units s
+         * @param outDistance distance along the path
+         *  - units m
+         * @param outVelocity speed
+         *  - units m/s
+         */
+        void at(double time, double &outDistance, double &outVelocity);
+
+    protected:
+        PoolVector<Sample> samples;
+        //Sample the last time was after
+        std::size_t sample{0};
+};
+
+//----------------------------------------------------------------------------//
+//                              Trajectory Stream                             //
+//----------------------------------------------------------------------------//
+
+/**
+ * Generates a PathProfile::wheel path one step at a time, so a follower can
+ * start on a path before the rest of it exists.
+ *
+ * The speed limit along the path is worked out up front, since where the
+ * robot has to start slowing down depends on everything after it; that takes
+ * one sample per 5 mm of path and no placement. Placing each step on the
+ * splines and splitting it into wheel velocities, most of the work and all of
+ * the per-step memory, waits for next().
+ *
+ * The samples are taken from the same pool as the splines.
+ */
+class TrajectoryStream
+{
+    public:
+        /**
+         * profiles a path so that neither wheel exceeds the limits; throws
+         * std::bad_alloc if the samples don't fit
+         * @param isplines the path, measured with splineDistance(); its total
+         *  length must be positive. The stream's buffers come from its pool.
+         * @param imaxVel maximum wheel velocity
+         *  - units m/s
+         * @param imaxAccel maximum wheel acceleration
+         *  - units m/s/s
+         * @param iwheelbaseWidth distance between the left and right wheels
+         *  - units m
+         * @param iarcLengthTolerance bound on the arc length error of each
+         *  spline
+         *  - units m
+         * @param idt timestep
+         *  - units s
+         */
+        TrajectoryStream(PoolVector<Spline> isplines, double imaxVel, double imaxAccel, double iwheelbaseWidth,
+            double iarcLengthTolerance, double idt);
+
+        //The cursor refers to the splines, so the stream stays put
+        TrajectoryStream(const TrajectoryStream &) = delete;
+        TrajectoryStream &operator=(const TrajectoryStream &) = delete;
+
+        /**
+         * @return number of steps in the whole path
+         */
+        int getLength() const;
+
+        /**
+         * @return time each step lasts
+         *  - units s
+         */
+        double getDt() const;
+
+        /**
+         * @return number of steps generated so far
+         */
+        int getGenerated() const;
+
+        /**
+         * generates the next step's wheel segments, as
+         * pathfinder_modify_tank() would
+         * @param outLeft left wheel segment
+         * @param outRight right wheel segment
+         * @return whether there was a step left to generate
+         */
+        bool next(Segment &outLeft, Segment &outRight);
+
+    protected:
+        PoolVector<Spline> splines;
+        SplineCursor cursor;
+        double dt;
+        double halfWidth;
+        //Speed of the center along the path
+        SpeedProfile profile;
+        int length{0};
+        int step{0};
+        Segment lastCenter{};
+        Segment lastLeft{};
+        Segment lastRight{};
+
+        /**
+         * moves a wheel segment on from the previous step's, as
+         * pathfinder_modify_tank() does
+         */
+        void advanceWheel(Segment &wheel, const Segment &last) const;
+};
+
+/**
+ * samples a path of splines every 5 mm or closer for a SpeedProfile; a knot
+ * is one sample, held to the lower limits of the splines on either side
+ * @param splines the path, measured; the samples come from its pool
+ * @param iarcLengthTolerance bound on the arc length error of each spline
+ *  - units m
+ * @param limit sets a sample's maxVel and maxAccel, given the index of its
+ *  spline, its progress along that spline and the sample with its distance
+ *  filled in
+ * @return the samples, ready for SpeedProfile
+ */
+PoolVector<SpeedProfile::Sample> sampleSplines(const PoolVector<Spline> &splines, double iarcLengthTolerance,
+    const std::function<void(std::size_t, double, SpeedProfile::Sample &)> &limit);
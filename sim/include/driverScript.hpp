@@ -0,0 +1,26 @@
+//Header guard
+#pragma once
+
+#include "api.h"
+
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                Driver Script                               //
+//----------------------------------------------------------------------------//
+
+/**
+ * holds a button for one controller poll window
+ * @param button the button to tap
+ */
+void tap(pros::controller_digital_e_t button);
+
+/**
+ * repeats a fixed practice drive that exercises every opcontrol subsystem;
+ * run it as a task alongside opcontrol()
+ * @param param unused null parameter
+ */
+void driverScript(void * param);
+
+} // namespace sim
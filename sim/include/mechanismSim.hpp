@@ -0,0 +1,151 @@
+//Header guard
+#pragma once
+
+#include "okapi/api/control/util/flywheelSimulator.hpp"
+#include "sim.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/**
+ * Simulated mechanisms driven by single V5 motors: a geared arm under
+ * gravity with hard stops, and a slip-gear puncher that winds a spring and
+ * releases it once per revolution. Each is an okapi::FlywheelSimulator, so
+ * the same models also work with okapi's own simulation utilities.
+ */
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                 Mechanisms                                 //
+//----------------------------------------------------------------------------//
+
+/**
+ * A link on a geared motor shaft. Angles, velocities and torques are at the
+ * mechanism; the motor turns gearRatio times as far. Gravity acts through
+ * the external torque function, which by default treats the link as a point
+ * mass at its tip, horizontal at angle 0.
+ */
+class MechanismSimulator : public okapi::FlywheelSimulator
+{
+    public:
+        /**
+         * @param imass mass at the tip of the link
+         *  - units kg
+         * @param ilinkLen link length
+         *  - units m
+         * @param imuStatic friction torque holding the mechanism at rest
+         *  - units N*m
+         * @param imuDynamic friction torque while moving
+         *  - units N*m
+         * @param itimestep timestep
+         *  - units seconds
+         */
+        MechanismSimulator(double imass, double ilinkLen, double imuStatic, double imuDynamic,
+            double itimestep = 0.001);
+
+        /**
+         * sets the gear ratio between the motor and the mechanism
+         * @param iratio motor revolutions per mechanism revolution
+         */
+        void setGearRatio(double iratio);
+
+        /**
+         * sets the hard stops the mechanism cannot move past
+         * @param iminAngle lower stop
+         *  - units rad
+         * @param imaxAngle upper stop
+         *  - units rad
+         */
+        void setHardStops(double iminAngle, double imaxAngle);
+
+        /**
+         * sets the inertia of the motor's rotor, referred to the motor shaft
+         * @param iinertia rotor inertia
+         *  - units kg*m^2
+         */
+        void setRotorInertia(double iinertia);
+
+        /**
+         * @return motor revolutions per mechanism revolution
+         */
+        double getGearRatio() const;
+
+    protected:
+        double gearRatio = 1;
+        double minAngle;
+        double maxAngle;
+        double rotorInertia = 0;
+
+        double stepImpl() override;
+};
+
+/**
+ * A slip-gear puncher. Over each motor revolution the gear winds the punch
+ * back against its spring until its teeth run out at the release angle, the
+ * spring fires the punch, and the rest of the revolution turns freely.
+ */
+class PuncherSimulator : public MechanismSimulator
+{
+    public:
+        /**
+         * @param ipeakTorque spring torque on the gear just before release
+         *  - units N*m
+         * @param ireleaseAngle gear angle at which the teeth run out
+         *  - range (0, 2*pi)
+         *  - units rad
+         */
+        explicit PuncherSimulator(double ipeakTorque = 1.2, double ireleaseAngle = 5.0);
+
+        /**
+         * sets a check for something in the punch's path; a shot released
+         * while it returns true is counted as obstructed
+         * @param iobstructed returns whether the punch is obstructed
+         */
+        void setObstruction(std::function<bool()> iobstructed);
+
+        /**
+         * @return number of times the spring has been released
+         */
+        int getShotCount() const;
+
+        /**
+         * @return number of releases that hit an obstruction
+         */
+        int getObstructedShotCount() const;
+
+    protected:
+        double releaseAngle;
+        int shotCount = 0;
+        int obstructedShotCount = 0;
+        std::function<bool()> obstructed;
+
+        double stepImpl() override;
+};
+
+//----------------------------------------------------------------------------//
+//                                 Motor Plant                                //
+//----------------------------------------------------------------------------//
+
+/**
+ * Connects a mechanism to one simulated motor. The port is given as okapi
+ * takes it: negative if the motor is reversed, so positive mechanism motion
+ * matches positive motor commands in the robot program.
+ */
+class MechanismPlant : public MotorPlant
+{
+    public:
+        /**
+         * @param mechanism mechanism the motor drives
+         * @param port smart port, negative if reversed
+         */
+        MechanismPlant(const std::shared_ptr<MechanismSimulator> &mechanism, std::int8_t port);
+
+        void step(double dt) override;
+
+    protected:
+        std::shared_ptr<MechanismSimulator> mechanism;
+        std::int8_t port;
+};
+
+} // namespace sim
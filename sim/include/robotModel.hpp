@@ -0,0 +1,35 @@
+//Header guard
+#pragma once
+
+#include "mechanismSim.hpp"
+#include "skidSteerSim.hpp"
+#include <memory>
+
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                Robot Model                                 //
+//----------------------------------------------------------------------------//
+
+/**
+ * Physics for every motor built in src/subsystems.cpp
+ */
+struct RobotModel
+{
+    //Robot 0 is the drivetrain
+    std::shared_ptr<SkidSteerBatch> drivetrain;
+    std::shared_ptr<PuncherSimulator> puncher;
+    std::shared_ptr<MechanismSimulator> angleAdjuster;
+    //Angles are the lift's, 3/5 of the motor's
+    std::shared_ptr<MechanismSimulator> capLift;
+};
+
+/**
+ * builds the robot's physics and attaches it to the simulated motor ports;
+ * the intake keeps the default plant
+ * @return the attached model
+ */
+RobotModel attachRobotModel();
+
+} // namespace sim
@@ -0,0 +1,263 @@
+//Header guard
+#pragma once
+
+#include "api.h"
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+/**
+ * Host-side replacement for the PROS device layer.
+ *
+ * Every pros::c function the robot program (and OkapiLib) calls is implemented
+ * in sim/src against simulated devices. Tasks run one at a time on a virtual
+ * clock, so a program that spends its life in pros::delay() runs as fast as
+ * the host can execute the code between delays.
+ */
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                 Scheduler                                  //
+//----------------------------------------------------------------------------//
+
+/**
+ * Function called once per simulated millisecond
+ * @param dt timestep
+ *  - units seconds
+ */
+using TickHook = std::function<void(double dt)>;
+
+/**
+ * Thrown out of a blocking call when the task making it has been deleted or
+ * the simulation has ended; caught by the task's entry point
+ */
+struct TaskKilled
+{
+};
+
+/**
+ * gets virtual time since the start of the simulation
+ * @return virtual time
+ *  - units microseconds
+ */
+std::uint64_t micros();
+
+/**
+ * puts the calling task to sleep until the virtual clock reaches a time;
+ * wake times need not fall on a millisecond
+ * @param wakeTime virtual time to wake at
+ *  - units microseconds
+ */
+void sleepUntil(std::uint64_t wakeTime);
+
+/**
+ * registers a function to be called every simulated millisecond, before any
+ * task waiting on that millisecond is woken
+ * @param hook function to call
+ */
+void addTickHook(TickHook hook);
+
+/**
+ * creates a simulated task
+ *
+ * Tasks are cooperative: the running task keeps the (single) simulated CPU
+ * until it delays, blocks or returns. Among ready tasks, the highest priority
+ * runs first and ties run in the order they became ready, so a run is
+ * reproducible as long as every task eventually blocks.
+ * @param function task entry point
+ * @param parameters argument passed to function
+ * @param name task name
+ * @param prio task priority
+ *  - range [TASK_PRIORITY_MIN, TASK_PRIORITY_MAX]
+ * @return handle usable with every pros::c task function
+ */
+pros::task_t createTask(pros::task_fn_t function, void * parameters, const char * name,
+    std::uint32_t prio = TASK_PRIORITY_DEFAULT);
+
+/**
+ * runs the scheduler until the virtual clock reaches the end time or every
+ * task has exited, then returns; blocking calls made after this point throw
+ * TaskKilled (or return immediately on threads the scheduler did not create)
+ * @param durationMs virtual time to run for
+ *  - units milliseconds
+ */
+void run(std::uint32_t durationMs);
+
+/**
+ * joins every task thread created with createTask()/task_create(); call after
+ * run() and before returning from main()
+ */
+void shutdown();
+
+//----------------------------------------------------------------------------//
+//                                   Motors                                   //
+//----------------------------------------------------------------------------//
+
+/**
+ * DC motor constants of a V5 smart motor, referred to the cartridge output
+ * shaft at 12 V
+ */
+struct MotorConstants
+{
+    //Free speed (rad/s)
+    double freeSpeed;
+    //Stall torque (N*m)
+    double stallTorque;
+    //Stall current (A)
+    double stallCurrent;
+    //Winding resistance (ohm)
+    double resistance;
+    //Torque constant (N*m/A)
+    double kT;
+    //Back-EMF constant (V*s/rad)
+    double kE;
+};
+
+/**
+ * gets DC motor constants for a V5 cartridge
+ * @param gearset the cartridge
+ * @return motor constants referred to the output shaft
+ */
+MotorConstants getMotorConstants(pros::motor_gearset_e_t gearset);
+
+/**
+ * computes winding current of a DC motor, respecting a current limit
+ * @param motor motor constants
+ * @param voltage applied voltage
+ *  - units volts
+ * @param omega output shaft speed
+ *  - units rad/s
+ * @param currentLimit current limit
+ *  - units amps
+ * @return winding current
+ *  - units amps
+ */
+double getMotorCurrent(const MotorConstants &motor, double voltage, double omega, double currentLimit);
+
+/**
+ * A physical system driven by one or more simulated motors. Each simulated
+ * millisecond the motor firmware emulation computes every motor's applied
+ * voltage, then every attached plant is stepped once and must report the
+ * shaft state of its motors through setMotorState().
+ */
+class MotorPlant
+{
+    public:
+        virtual ~MotorPlant() = default;
+
+        /**
+         * advances the plant by one timestep
+         * @param dt timestep
+         *  - units seconds
+         */
+        virtual void step(double dt) = 0;
+};
+
+/**
+ * gets the voltage currently applied by a motor, in the motor's physical
+ * (unreversed) direction
+ * @param port smart port
+ * @return applied voltage
+ *  - units volts
+ */
+double getMotorVoltage(std::uint8_t port);
+
+/**
+ * gets whether a motor's windings are open (coasting), in which case it
+ * produces no torque regardless of its applied voltage
+ * @param port smart port
+ * @return whether the motor is coasting
+ */
+bool isMotorCoasting(std::uint8_t port);
+
+/**
+ * gets a motor's current limit
+ * @param port smart port
+ * @return current limit
+ *  - units amps
+ */
+double getMotorCurrentLimit(std::uint8_t port);
+
+/**
+ * gets a motor's cartridge
+ * @param port smart port
+ * @return gearset
+ */
+pros::motor_gearset_e_t getMotorGearset(std::uint8_t port);
+
+/**
+ * reports a motor's shaft state, in the motor's physical (unreversed)
+ * direction; called by plants from step()
+ * @param port smart port
+ * @param position output shaft angle
+ *  - units degrees
+ * @param velocity output shaft speed
+ *  - units RPM
+ * @param current winding current
+ *  - units amps
+ * @param torque output shaft torque
+ *  - units N*m
+ */
+void setMotorState(std::uint8_t port, double position, double velocity, double current, double torque);
+
+/**
+ * attaches a plant to a set of ports, replacing their default plant (an
+ * unloaded motor with a small inertia)
+ * @param plant plant to step
+ * @param ports smart ports the plant drives
+ */
+void attachPlant(const std::shared_ptr<MotorPlant> &plant, std::initializer_list<std::uint8_t> ports);
+
+//----------------------------------------------------------------------------//
+//                                 Controller                                 //
+//----------------------------------------------------------------------------//
+
+/**
+ * sets a simulated joystick axis
+ * @param channel the axis
+ * @param value axis value
+ *  - range [-127, 127]
+ * @param id the controller
+ *  - default master
+ */
+void setAnalog(pros::controller_analog_e_t channel, std::int32_t value,
+    pros::controller_id_e_t id = pros::E_CONTROLLER_MASTER);
+
+/**
+ * sets a simulated controller button
+ * @param button the button
+ * @param pressed whether the button is held
+ * @param id the controller
+ *  - default master
+ */
+void setDigital(pros::controller_digital_e_t button, bool pressed,
+    pros::controller_id_e_t id = pros::E_CONTROLLER_MASTER);
+
+/**
+ * sets the simulated field control state
+ * @param status COMPETITION_* flags
+ */
+void setCompetitionStatus(std::uint8_t status);
+
+//----------------------------------------------------------------------------//
+//                                    LCD                                     //
+//----------------------------------------------------------------------------//
+
+/**
+ * gets the text on a line of the simulated LLEMU
+ * @param line line number
+ *  - range [0, 7]
+ * @return line text
+ */
+std::string getLcdLine(std::int16_t line);
+
+/**
+ * gets how many times lcd_print/lcd_set_text have been called
+ * @return number of LCD writes
+ */
+std::uint32_t getLcdWriteCount();
+
+} // namespace sim
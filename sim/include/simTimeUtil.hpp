@@ -0,0 +1,112 @@
+//Header guard
+#pragma once
+
+#include "okapi/api/util/abstractRate.hpp"
+#include "okapi/api/util/abstractTimer.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <cstdint>
+
+/**
+ * okapi time utilities driven by the simulation's virtual clock.
+ *
+ * okapi::Timer and okapi::Rate already run on virtual time under the sim
+ * because they call pros::millis() and task_delay_until(), but only to the
+ * millisecond. These keep microsecond resolution end to end, so a loop at a
+ * frequency that does not divide 1 kHz keeps its period instead of rounding
+ * it every cycle, and two runs of the same program take identical timesteps.
+ * Pass SimTimeUtilFactory::create() wherever okapi takes a TimeUtil
+ * (ChassisControllerPID, AsyncWrapper, PIDTuner, ...).
+ */
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                   Timer                                    //
+//----------------------------------------------------------------------------//
+
+class SimTimer : public okapi::AbstractTimer
+{
+    public:
+        SimTimer();
+
+        /**
+         * gets virtual time since the start of the simulation
+         * @return virtual time, to the microsecond
+         */
+        okapi::QTime millis() const override;
+};
+
+//----------------------------------------------------------------------------//
+//                                    Rate                                    //
+//----------------------------------------------------------------------------//
+
+class SimRate : public okapi::AbstractRate
+{
+    public:
+        SimRate();
+
+        /**
+         * delays the calling task so that it runs at a frequency; the period
+         * is measured from the previous wake time, not from the call
+         * @param ihz loop frequency
+         */
+        void delay(okapi::QFrequency ihz) override;
+
+        /**
+         * delays the calling task so that it runs at a frequency
+         * @param ihz loop frequency
+         *  - units Hz
+         */
+        void delay(int ihz) override;
+
+        /**
+         * delays the calling task until a period has passed since the
+         * previous wake time
+         * @param itime loop period
+         */
+        void delayUntil(okapi::QTime itime) override;
+
+        /**
+         * delays the calling task until a period has passed since the
+         * previous wake time
+         * @param ims loop period
+         *  - units milliseconds
+         */
+        void delayUntil(std::uint32_t ims) override;
+
+    protected:
+        //Previous wake time (us); 0 until the first delay
+        std::uint64_t lastTime{0};
+
+        /**
+         * sleeps until a period after the previous wake time
+         * @param periodUs loop period
+         *  - units microseconds
+         */
+        void delayPeriod(std::uint64_t periodUs);
+};
+
+//----------------------------------------------------------------------------//
+//                                  Factory                                   //
+//----------------------------------------------------------------------------//
+
+class SimTimeUtilFactory
+{
+    public:
+        /**
+         * creates a TimeUtil of SimTimers and SimRates with okapi's default
+         * SettledUtil parameters
+         */
+        static okapi::TimeUtil create();
+
+        /**
+         * creates a TimeUtil of SimTimers and SimRates
+         * @param iatTargetError SettledUtil target error
+         * @param iatTargetDerivative SettledUtil target error derivative
+         * @param iatTargetTime time the error must stay within bounds
+         */
+        static okapi::TimeUtil withSettledUtilParams(double iatTargetError = 50, double iatTargetDerivative = 5,
+            okapi::QTime iatTargetTime = 250 * okapi::millisecond);
+};
+
+} // namespace sim
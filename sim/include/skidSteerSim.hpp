@@ -0,0 +1,328 @@
+//Header guard
+#pragma once
+
+#include "okapi/api/chassis/model/chassisModel.hpp"
+#include "poseSource.hpp"
+#include "sim.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+/**
+ * Skid-steer drivetrain physics.
+ *
+ * Each side of the robot is a set of V5 motors driving their wheels directly.
+ * Motor current follows from the applied voltage and the wheels' back-EMF,
+ * and the wheels push on the field through a traction-limited contact patch,
+ * so hard acceleration or turning spins the wheels. State is kept as one
+ * array per quantity across many robots, so a parameter sweep steps hundreds
+ * of robots with one tight loop.
+ */
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                  Physics                                   //
+//----------------------------------------------------------------------------//
+
+/**
+ * Physical parameters shared by every robot in a batch; defaults match the
+ * drivetrain built in src/subsystems.cpp
+ */
+struct SkidSteerParams
+{
+    //Cartridge of every drive motor
+    pros::motor_gearset_e_t gearset = pros::E_MOTOR_GEARSET_18;
+    //Drive motors per side
+    int motorsPerSide = 2;
+    //Per-motor current limit (A)
+    double currentLimit = 2.5;
+    //Wheel diameter (m), 4.1 in
+    double wheelDiameter = 0.10414;
+    //Distance between left and right wheels (m), 12.5 in
+    double trackWidth = 0.3175;
+    //Robot mass (kg)
+    double mass = 6.0;
+    //Yaw moment of inertia (kg*m^2)
+    double momentOfInertia = 0.15;
+    //Friction coefficient between the wheels and the field tiles
+    double traction = 1.0;
+    //Wheel-to-ground speed difference at which the full traction force is
+    //reached (m/s); above it the wheel is slipping
+    double slipVelocity = 0.05;
+    //Yaw torque resisting turning as the wheels scrub sideways, as a fraction
+    //of traction * weight * track width / 2
+    double scrub = 0.1;
+    //Motor gearbox friction, as a fraction of stall torque
+    double friction = 0.02;
+};
+
+/**
+ * A batch of independent skid-steer robots stepped together. Each robot has
+ * a left and a right command that is either a voltage or, emulating the
+ * motors' firmware velocity loop, a target velocity.
+ */
+class SkidSteerBatch
+{
+    public:
+        /**
+         * creates a batch of robots at rest at the origin, facing +x
+         * @param size number of robots
+         * @param params physical parameters shared by every robot
+         */
+        explicit SkidSteerBatch(std::size_t size, const SkidSteerParams &params = SkidSteerParams());
+
+        /**
+         * @return number of robots in the batch
+         */
+        std::size_t size() const;
+
+        /**
+         * @return physical parameters
+         */
+        const SkidSteerParams &getParams() const;
+
+        /**
+         * commands a robot's motors with voltages
+         * @param index robot
+         * @param left left side voltage
+         *  - range [-12, 12]
+         *  - units volts
+         * @param right right side voltage
+         *  - range [-12, 12]
+         *  - units volts
+         */
+        void setVoltage(std::size_t index, double left, double right);
+
+        /**
+         * commands a robot's motors with target velocities, held by the
+         * emulated motor firmware
+         * @param index robot
+         * @param left left side velocity
+         *  - units RPM
+         * @param right right side velocity
+         *  - units RPM
+         */
+        void setVelocity(std::size_t index, double left, double right);
+
+        /**
+         * commands one side of a robot with a target velocity, leaving the
+         * other side's command alone
+         * @param index robot
+         * @param left (or right) side velocity
+         *  - units RPM
+         */
+        void setLeftVelocity(std::size_t index, double left);
+        void setRightVelocity(std::size_t index, double right);
+
+        /**
+         * lets a robot's motors coast, as they do when commanded to zero in
+         * the default brake mode; setVelocity() coasts a side commanded to 0
+         * RPM by itself
+         * @param index robot
+         * @param left whether to coast the left side
+         * @param right whether to coast the right side
+         */
+        void coast(std::size_t index, bool left = true, bool right = true);
+
+        /**
+         * puts a robot back at rest at the origin with its encoders zeroed
+         * @param index robot
+         */
+        void reset(std::size_t index);
+
+        /**
+         * advances every robot by one timestep
+         * @param dt timestep
+         *  - units seconds
+         */
+        void step(double dt);
+
+        //Per-robot state, indexed by robot. Wheel quantities are at the
+        //motor output shaft, positive driving the robot forward.
+
+        //Wheel angle (rad)
+        std::vector<double> leftAngle;
+        std::vector<double> rightAngle;
+        //Wheel speed (rad/s)
+        std::vector<double> leftOmega;
+        std::vector<double> rightOmega;
+        //Per-motor winding current (A)
+        std::vector<double> leftCurrent;
+        std::vector<double> rightCurrent;
+        //Wheel surface speed minus ground speed under the wheel (m/s)
+        std::vector<double> leftSlip;
+        std::vector<double> rightSlip;
+        //Forward speed (m/s) and yaw rate (rad/s), counterclockwise positive
+        std::vector<double> velocity;
+        std::vector<double> yawRate;
+        //Field pose (m, m, rad)
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> theta;
+        //Fraction of the traction each side's wheels get, 1 by default;
+        //lower one to inject slip, as from a worn tread or a dusty tile.
+        //reset() leaves it alone.
+        std::vector<double> leftGrip;
+        std::vector<double> rightGrip;
+
+    protected:
+        SkidSteerParams params;
+        MotorConstants motor;
+
+        enum Mode : std::uint8_t
+        {
+            VOLTAGE,
+            VELOCITY,
+            COAST
+        };
+
+        //Commands: voltage (V) or velocity (RPM), according to the mode
+        std::vector<double> leftCommand;
+        std::vector<double> rightCommand;
+        std::vector<std::uint8_t> leftMode;
+        std::vector<std::uint8_t> rightMode;
+        //Firmware velocity loop integrators (V)
+        std::vector<double> leftIntegral;
+        std::vector<double> rightIntegral;
+};
+
+//----------------------------------------------------------------------------//
+//                                Chassis Model                               //
+//----------------------------------------------------------------------------//
+
+/**
+ * A ChassisModel that drives one robot of a SkidSteerBatch, mirroring
+ * okapi::SkidSteerModel: forward/driveVector/rotate/left/right command
+ * velocity, tank/arcade command voltage, and the sensors read wheel degrees.
+ * Nothing steps the batch on its own; call SkidSteerBatch::step() or step it
+ * from a tick hook.
+ */
+class SimSkidSteerModel : public okapi::ChassisModel
+{
+    public:
+        /**
+         * @param batch batch containing the robot
+         * @param index robot to drive
+         * @param maxVelocity velocity at full speed
+         *  - units RPM
+         *  - default 200, the green cartridge's free speed
+         * @param maxVoltage voltage at full speed
+         *  - units millivolts
+         */
+        SimSkidSteerModel(const std::shared_ptr<SkidSteerBatch> &batch, std::size_t index, double maxVelocity = 200,
+            double maxVoltage = 12000);
+
+        void forward(double ispeed) const override;
+        void driveVector(double iforwardSpeed, double iyaw) const override;
+        void rotate(double ispeed) const override;
+        void stop() override;
+        void tank(double ileftSpeed, double irightSpeed, double ithreshold = 0) const override;
+        void arcade(double iforwardSpeed, double iyaw, double ithreshold = 0) const override;
+        void left(double ispeed) const override;
+        void right(double ispeed) const override;
+
+        /**
+         * @return left and right wheel angles since the last reset
+         *  - units degrees
+         */
+        std::valarray<std::int32_t> getSensorVals() const override;
+        void resetSensors() const override;
+
+        //Brake mode, units, gearing and PID settings belong to the firmware
+        //emulation, which uses fixed values
+        void setBrakeMode(okapi::AbstractMotor::brakeMode mode) const override;
+        void setEncoderUnits(okapi::AbstractMotor::encoderUnits units) const override;
+        void setGearing(okapi::AbstractMotor::gearset gearset) const override;
+        void setPosPID(double ikF, double ikP, double ikI, double ikD) const override;
+        void setPosPIDFull(double ikF, double ikP, double ikI, double ikD, double ifilter, double ilimit,
+            double ithreshold, double iloopSpeed) const override;
+        void setVelPID(double ikF, double ikP, double ikI, double ikD) const override;
+        void setVelPIDFull(double ikF, double ikP, double ikI, double ikD, double ifilter, double ilimit,
+            double ithreshold, double iloopSpeed) const override;
+
+    protected:
+        std::shared_ptr<SkidSteerBatch> batch;
+        std::size_t index;
+        //Wheel angles reported as zero (rad)
+        mutable double leftZero = 0;
+        mutable double rightZero = 0;
+
+        /**
+         * commands both sides with fractions of max velocity
+         */
+        void velocity(double leftSpeed, double rightSpeed) const;
+
+        /**
+         * commands both sides with fractions of max voltage
+         */
+        void voltage(double leftSpeed, double rightSpeed) const;
+};
+
+//----------------------------------------------------------------------------//
+//                                 Pose Source                                //
+//----------------------------------------------------------------------------//
+
+/**
+ * The true pose of one robot of a SkidSteerBatch, standing in for a sensor
+ * that sees the robot's motion rather than its wheels' (tracking wheels, a
+ * gyro, vision), so slip shows up in it
+ */
+class SkidSteerPoseSource : public PoseSource
+{
+    public:
+        /**
+         * @param batch batch containing the robot
+         * @param index robot to track
+         */
+        SkidSteerPoseSource(const std::shared_ptr<SkidSteerBatch> &batch, std::size_t index);
+
+        Pose getPose() override;
+
+    protected:
+        std::shared_ptr<SkidSteerBatch> batch;
+        std::size_t index;
+};
+
+//----------------------------------------------------------------------------//
+//                                 Motor Plant                                //
+//----------------------------------------------------------------------------//
+
+/**
+ * Connects robot 0 of a SkidSteerBatch to the simulated motors, so programs
+ * driving the real motor ports drive the physics. Ports are given as okapi
+ * takes them: negative for motors mounted reversed.
+ */
+class SkidSteerPlant : public MotorPlant
+{
+    public:
+        /**
+         * @param batch batch containing the robot
+         * @param leftPorts left side motors
+         * @param rightPorts right side motors
+         */
+        SkidSteerPlant(const std::shared_ptr<SkidSteerBatch> &batch, std::initializer_list<std::int8_t> leftPorts,
+            std::initializer_list<std::int8_t> rightPorts);
+
+        void step(double dt) override;
+
+    protected:
+        std::shared_ptr<SkidSteerBatch> batch;
+        std::vector<std::int8_t> leftPorts;
+        std::vector<std::int8_t> rightPorts;
+
+        /**
+         * gets the mean voltage driving one side forward; a coasting motor
+         * contributes its own back-EMF, so it adds no current
+         */
+        double sideVoltage(const std::vector<std::int8_t> &ports, double omega) const;
+
+        /**
+         * reports one side's state to each of its motors
+         */
+        void reportSide(const std::vector<std::int8_t> &ports, double angle, double omega, double current) const;
+};
+
+} // namespace sim
@@ -0,0 +1,66 @@
+#include "main.h"
+#include "driverScript.hpp"
+#include "sim.hpp"
+
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                Driver Script                               //
+//----------------------------------------------------------------------------//
+
+void tap(pros::controller_digital_e_t button)
+{
+    sim::setDigital(button, true);
+    pros::delay(50);
+    sim::setDigital(button, false);
+}
+
+void driverScript(void * param)
+{
+    while(true)
+    {
+        //Full speed forward, then an arc on the sensitive stick
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y, 127);
+        pros::delay(1500);
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_RIGHT_X, 64);
+        pros::delay(750);
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_RIGHT_X, 0);
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y, 0);
+        pros::delay(250);
+
+        //Intake a ball while turning in place
+        sim::setDigital(pros::E_CONTROLLER_DIGITAL_R1, true);
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_LEFT_X, -100);
+        pros::delay(1000);
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_LEFT_X, 0);
+        sim::setDigital(pros::E_CONTROLLER_DIGITAL_R1, false);
+
+        //Toggle the puncher angle and fire
+        tap(pros::E_CONTROLLER_DIGITAL_X);
+        pros::delay(500);
+        tap(pros::E_CONTROLLER_DIGITAL_Y);
+        pros::delay(1500);
+
+        //Raise and lower the cap lift
+        sim::setDigital(pros::E_CONTROLLER_DIGITAL_R2, true);
+        pros::delay(1200);
+        sim::setDigital(pros::E_CONTROLLER_DIGITAL_R2, false);
+        pros::delay(300);
+        sim::setDigital(pros::E_CONTROLLER_DIGITAL_L2, true);
+        pros::delay(1200);
+        sim::setDigital(pros::E_CONTROLLER_DIGITAL_L2, false);
+
+        //Double shot
+        tap(pros::E_CONTROLLER_DIGITAL_B);
+        pros::delay(3000);
+
+        //Back up
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y, -127);
+        pros::delay(1500);
+        sim::setAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y, 0);
+        pros::delay(500);
+    }
+}
+
+} // namespace sim
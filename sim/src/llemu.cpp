@@ -0,0 +1,211 @@
+#include "sim.hpp"
+#include <array>
+#include <cerrno>
+#include <cstdarg>
+#include <mutex>
+
+//----------------------------------------------------------------------------//
+//                                    LCD                                     //
+//----------------------------------------------------------------------------//
+
+namespace sim
+{
+namespace
+{
+    const int NUM_LINES = 8;
+
+    struct Lcd
+    {
+        std::mutex lock;
+        bool initialized = false;
+        std::array<std::string, NUM_LINES> lines;
+        std::array<pros::lcd_btn_cb_fn_t, 3> callbacks{};
+        std::uint32_t writeCount = 0;
+    };
+
+    Lcd &lcd()
+    {
+        static Lcd * instance = new Lcd();
+        return *instance;
+    }
+} // namespace
+
+std::string getLcdLine(std::int16_t line)
+{
+    std::lock_guard<std::mutex> lk(lcd().lock);
+    return (line >= 0 && line < NUM_LINES) ? lcd().lines[line] : "";
+}
+
+std::uint32_t getLcdWriteCount()
+{
+    std::lock_guard<std::mutex> lk(lcd().lock);
+    return lcd().writeCount;
+}
+
+} // namespace sim
+
+//----------------------------------------------------------------------------//
+//                                 PROS C API                                 //
+//----------------------------------------------------------------------------//
+
+namespace pros
+{
+namespace c
+{
+
+#define LCD_OR_RETURN(line)                                        \
+    std::lock_guard<std::mutex> lk(sim::lcd().lock);               \
+    if(!sim::lcd().initialized)                                    \
+    {                                                              \
+        errno = ENXIO;                                             \
+        return false;                                              \
+    }                                                              \
+    if(line < 0 || line >= sim::NUM_LINES)                         \
+    {                                                              \
+        errno = EINVAL;                                            \
+        return false;                                              \
+    }
+
+bool lcd_is_initialized(void)
+{
+    std::lock_guard<std::mutex> lk(sim::lcd().lock);
+    return sim::lcd().initialized;
+}
+
+bool lcd_initialize(void)
+{
+    std::lock_guard<std::mutex> lk(sim::lcd().lock);
+    sim::lcd().initialized = true;
+    return true;
+}
+
+bool lcd_shutdown(void)
+{
+    std::lock_guard<std::mutex> lk(sim::lcd().lock);
+    sim::lcd().initialized = false;
+    return true;
+}
+
+bool lcd_set_text(std::int16_t line, const char * text)
+{
+    LCD_OR_RETURN(line);
+    sim::lcd().lines[line] = text;
+    sim::lcd().writeCount++;
+    return true;
+}
+
+bool lcd_print(std::int16_t line, const char * fmt, ...)
+{
+    char buffer[128];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return lcd_set_text(line, buffer);
+}
+
+bool lcd_clear(void)
+{
+    LCD_OR_RETURN(0);
+    for(std::string &line : sim::lcd().lines)
+    {
+        line.clear();
+    }
+    return true;
+}
+
+bool lcd_clear_line(std::int16_t line)
+{
+    LCD_OR_RETURN(line);
+    sim::lcd().lines[line].clear();
+    return true;
+}
+
+bool lcd_register_btn0_cb(lcd_btn_cb_fn_t cb)
+{
+    LCD_OR_RETURN(0);
+    sim::lcd().callbacks[0] = cb;
+    return true;
+}
+
+bool lcd_register_btn1_cb(lcd_btn_cb_fn_t cb)
+{
+    LCD_OR_RETURN(0);
+    sim::lcd().callbacks[1] = cb;
+    return true;
+}
+
+bool lcd_register_btn2_cb(lcd_btn_cb_fn_t cb)
+{
+    LCD_OR_RETURN(0);
+    sim::lcd().callbacks[2] = cb;
+    return true;
+}
+
+std::uint8_t lcd_read_buttons(void)
+{
+    return 0;
+}
+
+#undef LCD_OR_RETURN
+
+} // namespace c
+
+//----------------------------------------------------------------------------//
+//                                PROS C++ API                                //
+//----------------------------------------------------------------------------//
+
+namespace lcd
+{
+bool is_initialized(void)
+{
+    return c::lcd_is_initialized();
+}
+
+bool initialize(void)
+{
+    return c::lcd_initialize();
+}
+
+bool shutdown(void)
+{
+    return c::lcd_shutdown();
+}
+
+bool set_text(std::int16_t line, std::string text)
+{
+    return c::lcd_set_text(line, text.c_str());
+}
+
+bool clear(void)
+{
+    return c::lcd_clear();
+}
+
+bool clear_line(std::int16_t line)
+{
+    return c::lcd_clear_line(line);
+}
+
+void register_btn0_cb(lcd_btn_cb_fn_t cb)
+{
+    c::lcd_register_btn0_cb(cb);
+}
+
+void register_btn1_cb(lcd_btn_cb_fn_t cb)
+{
+    c::lcd_register_btn1_cb(cb);
+}
+
+void register_btn2_cb(lcd_btn_cb_fn_t cb)
+{
+    c::lcd_register_btn2_cb(cb);
+}
+
+std::uint8_t read_buttons(void)
+{
+    return c::lcd_read_buttons();
+}
+} // namespace lcd
+
+} // namespace pros
@@ -0,0 +1,94 @@
+#include "main.h"
+#include "sim.hpp"
+#include "driverScript.hpp"
+#include "robotModel.hpp"
+#include "subsystems.hpp"
+#include <chrono>
+#include <cstring>
+#include <string>
+
+//----------------------------------------------------------------------------//
+//                              Competition Flow                              //
+//----------------------------------------------------------------------------//
+
+bool runAutonomous = false;
+
+/**
+ * mirrors the PROS system daemon: initialize(), then the competition task
+ * @param param unused null parameter
+ */
+void competitionTask(void * param)
+{
+    initialize();
+    if(runAutonomous)
+    {
+        pros::Task autonomousTask([](void *) { autonomous(); }, nullptr, TASK_PRIORITY_DEFAULT,
+            TASK_STACK_DEPTH_DEFAULT, "User Autonomous (PROS)");
+    }
+    else
+    {
+        pros::Task opcontrolTask([](void *) { opcontrol(); }, nullptr, TASK_PRIORITY_DEFAULT,
+            TASK_STACK_DEPTH_DEFAULT, "User Operator Control (PROS)");
+        pros::Task driverTask(sim::driverScript, nullptr, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT,
+            "Sim Driver");
+    }
+}
+
+/**
+ * Runs the robot program on the simulated device layer.
+ *
+ * Usage: robot-sim [--duration=<seconds>] [--autonomous] [--telemetry=<file>]
+ *  --duration   virtual time to simulate, default 105 (a full driver period)
+ *  --autonomous run autonomous() instead of opcontrol() with the driver script
+ *  --telemetry  file to write telemetry records to, default none
+ */
+int main(int argc, char ** argv)
+{
+    double durationSeconds = 105;
+    //There is no SD card, and records on stdout would garble the report
+    telemetryFile = "/dev/null";
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strncmp(argv[i], "--duration=", 11) == 0)
+        {
+            durationSeconds = std::atof(argv[i] + 11);
+        }
+        else if(std::strcmp(argv[i], "--autonomous") == 0)
+        {
+            runAutonomous = true;
+            sim::setCompetitionStatus(COMPETITION_CONNECTED | COMPETITION_AUTONOMOUS);
+        }
+        else if(std::strncmp(argv[i], "--telemetry=", 12) == 0)
+        {
+            telemetryFile = argv[i] + 12;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--duration=<seconds>] [--autonomous] [--telemetry=<file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim::RobotModel robot = sim::attachRobotModel();
+
+    sim::createTask(competitionTask, nullptr, "User Initialization (PROS)");
+
+    auto wallStart = std::chrono::steady_clock::now();
+    sim::run(static_cast<std::uint32_t>(durationSeconds * 1000));
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    sim::shutdown();
+
+    double virtualSeconds = sim::micros() / 1e6;
+    std::printf("Simulated %.3f s in %.3f s of wall time (%.0fx real time)\n", virtualSeconds, wallSeconds,
+        virtualSeconds / wallSeconds);
+    std::printf("Final pose: x %.3f m, y %.3f m, heading %.1f deg\n", robot.drivetrain->x[0], robot.drivetrain->y[0],
+        robot.drivetrain->theta[0] * 180.0 / M_PI);
+    std::printf("Shots fired: %d (%d into the cap lift)\n", robot.puncher->getShotCount(),
+        robot.puncher->getObstructedShotCount());
+    std::printf("LCD writes: %u\n", sim::getLcdWriteCount());
+    for(std::int16_t line = 0; line < 8; line++)
+    {
+        std::printf("LCD %d: %s\n", line, sim::getLcdLine(line).c_str());
+    }
+    return 0;
+}
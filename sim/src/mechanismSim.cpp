@@ -0,0 +1,153 @@
+#include "mechanismSim.hpp"
+#include <cmath>
+#include <limits>
+
+namespace sim
+{
+
+//----------------------------------------------------------------------------//
+//                                 Mechanisms                                 //
+//----------------------------------------------------------------------------//
+
+MechanismSimulator::MechanismSimulator(double imass, double ilinkLen, double imuStatic, double imuDynamic,
+    double itimestep)
+    : okapi::FlywheelSimulator(imass, ilinkLen, imuStatic, imuDynamic, itimestep),
+      minAngle(-std::numeric_limits<double>::infinity()), maxAngle(std::numeric_limits<double>::infinity())
+{
+    //The motor plant limits torque through the motor's current limit
+    setMaxTorque(std::numeric_limits<double>::infinity());
+}
+
+void MechanismSimulator::setGearRatio(double iratio)
+{
+    gearRatio = iratio;
+}
+
+void MechanismSimulator::setHardStops(double iminAngle, double imaxAngle)
+{
+    minAngle = iminAngle;
+    maxAngle = imaxAngle;
+}
+
+void MechanismSimulator::setRotorInertia(double iinertia)
+{
+    rotorInertia = iinertia;
+}
+
+double MechanismSimulator::getGearRatio() const
+{
+    return gearRatio;
+}
+
+double MechanismSimulator::stepImpl()
+{
+    double torque = inputTorque + torqueFunc(angle, mass, linkLen);
+    I = mass * linkLen * linkLen + rotorInertia * gearRatio * gearRatio;
+
+    //Static friction holds the mechanism until the torque overcomes it, and
+    //dynamic friction never reverses it
+    if(omega == 0 && std::abs(torque) <= muStatic)
+    {
+        accel = 0;
+    }
+    else
+    {
+        double direction = (omega != 0) ? std::copysign(1.0, omega) : std::copysign(1.0, torque);
+        accel = (torque - muDynamic * direction) / I;
+        double lastOmega = omega;
+        omega += accel * timestep;
+        if(lastOmega != 0 && std::signbit(omega) != std::signbit(lastOmega) && std::abs(torque) <= muStatic)
+        {
+            omega = 0;
+        }
+    }
+    angle += omega * timestep;
+
+    //Hard stops absorb all motion into them
+    if(angle <= minAngle)
+    {
+        angle = minAngle;
+        omega = std::max(0.0, omega);
+    }
+    else if(angle >= maxAngle)
+    {
+        angle = maxAngle;
+        omega = std::min(0.0, omega);
+    }
+    return angle;
+}
+
+PuncherSimulator::PuncherSimulator(double ipeakTorque, double ireleaseAngle)
+    : MechanismSimulator(0.2, 0.05, 0.05, 0.03), releaseAngle(ireleaseAngle)
+{
+    //The spring winds up while the slip gear's teeth are engaged
+    setExternalTorqueFunction([ipeakTorque, ireleaseAngle](double angle, double, double) {
+        double phase = angle - 2.0 * M_PI * std::floor(angle / (2.0 * M_PI));
+        return (phase < ireleaseAngle) ? -ipeakTorque * phase / ireleaseAngle : 0.0;
+    });
+}
+
+void PuncherSimulator::setObstruction(std::function<bool()> iobstructed)
+{
+    obstructed = std::move(iobstructed);
+}
+
+int PuncherSimulator::getShotCount() const
+{
+    return shotCount;
+}
+
+int PuncherSimulator::getObstructedShotCount() const
+{
+    return obstructedShotCount;
+}
+
+double PuncherSimulator::stepImpl()
+{
+    double lastAngle = angle;
+    MechanismSimulator::stepImpl();
+
+    //Fire on every forward pass through the release angle
+    if(std::floor((angle - releaseAngle) / (2.0 * M_PI)) > std::floor((lastAngle - releaseAngle) / (2.0 * M_PI)))
+    {
+        shotCount++;
+        if(obstructed && obstructed())
+        {
+            obstructedShotCount++;
+        }
+    }
+    return angle;
+}
+
+//----------------------------------------------------------------------------//
+//                                 Motor Plant                                //
+//----------------------------------------------------------------------------//
+
+MechanismPlant::MechanismPlant(const std::shared_ptr<MechanismSimulator> &mechanism, std::int8_t port)
+    : mechanism(mechanism), port(port)
+{
+}
+
+void MechanismPlant::step(double dt)
+{
+    std::uint8_t physicalPort = static_cast<std::uint8_t>(std::abs(port));
+    double sign = (port < 0) ? -1.0 : 1.0;
+    double ratio = mechanism->getGearRatio();
+
+    //Same rotor as the single-motor plant
+    MotorConstants motor = getMotorConstants(getMotorGearset(physicalPort));
+    mechanism->setRotorInertia(0.05 * motor.kT * motor.kE / motor.resistance);
+
+    double motorOmega = mechanism->getOmega() * ratio;
+    double current = isMotorCoasting(physicalPort) ? 0 :
+        getMotorCurrent(motor, sign * getMotorVoltage(physicalPort), motorOmega, getMotorCurrentLimit(physicalPort));
+    double torque = motor.kT * current;
+
+    mechanism->setTimestep(dt);
+    mechanism->step(torque * ratio);
+
+    setMotorState(physicalPort, sign * mechanism->getAngle() * ratio * 180.0 / M_PI,
+        sign * mechanism->getOmega() * ratio * 60.0 / (2.0 * M_PI), sign * current, sign * torque);
+}
+
+} // namespace sim
@@ -0,0 +1,353 @@
+#include "sim.hpp"
+#include <array>
+#include <cerrno>
+#include <cstdarg>
+#include <mutex>
+
+//----------------------------------------------------------------------------//
+//                                 Controller                                 //
+//----------------------------------------------------------------------------//
+
+namespace sim
+{
+namespace
+{
+    const int NUM_BUTTONS = 12;
+
+    struct ControllerState
+    {
+        std::array<std::int32_t, 4> analog{};
+        std::array<bool, NUM_BUTTONS> digital{};
+        //Whether the current press has already been reported as new
+        std::array<bool, NUM_BUTTONS> pressReported{};
+        std::array<std::string, 3> text;
+    };
+
+    struct Devices
+    {
+        std::mutex lock;
+        std::array<ControllerState, 2> controllers;
+        std::uint8_t competitionStatus = 0;
+    };
+
+    Devices &devices()
+    {
+        static Devices * instance = new Devices();
+        return *instance;
+    }
+
+    /**
+     * gets a controller's state, or nullptr and sets errno if the id is
+     * invalid; must be called with the lock held
+     */
+    ControllerState * getController(pros::controller_id_e_t id)
+    {
+        if(id != pros::E_CONTROLLER_MASTER && id != pros::E_CONTROLLER_PARTNER)
+        {
+            errno = EINVAL;
+            return nullptr;
+        }
+        return &devices().controllers[id];
+    }
+
+    int buttonIndex(pros::controller_digital_e_t button)
+    {
+        return static_cast<int>(button) - static_cast<int>(pros::E_CONTROLLER_DIGITAL_L1);
+    }
+} // namespace
+
+void setAnalog(pros::controller_analog_e_t channel, std::int32_t value, pros::controller_id_e_t id)
+{
+    std::lock_guard<std::mutex> lk(devices().lock);
+    if(ControllerState * controller = getController(id))
+    {
+        controller->analog.at(channel) = std::max(-127, std::min(127, value));
+    }
+}
+
+void setDigital(pros::controller_digital_e_t button, bool pressed, pros::controller_id_e_t id)
+{
+    std::lock_guard<std::mutex> lk(devices().lock);
+    if(ControllerState * controller = getController(id))
+    {
+        controller->digital.at(buttonIndex(button)) = pressed;
+    }
+}
+
+void setCompetitionStatus(std::uint8_t status)
+{
+    std::lock_guard<std::mutex> lk(devices().lock);
+    devices().competitionStatus = status;
+}
+
+} // namespace sim
+
+//----------------------------------------------------------------------------//
+//                                 PROS C API                                 //
+//----------------------------------------------------------------------------//
+
+namespace pros
+{
+namespace c
+{
+
+#define CONTROLLER_OR_RETURN(id)                                   \
+    std::lock_guard<std::mutex> lk(sim::devices().lock);           \
+    sim::ControllerState * controller = sim::getController(id);    \
+    if(controller == nullptr)                                      \
+    {                                                              \
+        return PROS_ERR;                                           \
+    }
+
+std::uint8_t competition_get_status(void)
+{
+    std::lock_guard<std::mutex> lk(sim::devices().lock);
+    return sim::devices().competitionStatus;
+}
+
+std::int32_t controller_is_connected(controller_id_e_t id)
+{
+    //Only the master controller is simulated as connected
+    return id == E_CONTROLLER_MASTER;
+}
+
+std::int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel)
+{
+    CONTROLLER_OR_RETURN(id);
+    if(channel < E_CONTROLLER_ANALOG_LEFT_X || channel > E_CONTROLLER_ANALOG_RIGHT_Y)
+    {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return controller->analog[channel];
+}
+
+std::int32_t controller_get_battery_capacity(controller_id_e_t id)
+{
+    CONTROLLER_OR_RETURN(id);
+    return 100;
+}
+
+std::int32_t controller_get_battery_level(controller_id_e_t id)
+{
+    CONTROLLER_OR_RETURN(id);
+    return 100;
+}
+
+std::int32_t controller_get_digital(controller_id_e_t id, controller_digital_e_t button)
+{
+    CONTROLLER_OR_RETURN(id);
+    int index = sim::buttonIndex(button);
+    if(index < 0 || index >= sim::NUM_BUTTONS)
+    {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return controller->digital[index];
+}
+
+std::int32_t controller_get_digital_new_press(controller_id_e_t id, controller_digital_e_t button)
+{
+    CONTROLLER_OR_RETURN(id);
+    int index = sim::buttonIndex(button);
+    if(index < 0 || index >= sim::NUM_BUTTONS)
+    {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    if(!controller->digital[index])
+    {
+        controller->pressReported[index] = false;
+        return 0;
+    }
+    bool isNew = !controller->pressReported[index];
+    controller->pressReported[index] = true;
+    return isNew;
+}
+
+std::int32_t controller_set_text(controller_id_e_t id, std::uint8_t line, std::uint8_t col, const char * str)
+{
+    CONTROLLER_OR_RETURN(id);
+    if(line > 2)
+    {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    std::string &text = controller->text[line];
+    if(text.size() < col)
+    {
+        text.resize(col, ' ');
+    }
+    text.replace(col, std::string::npos, str);
+    return 1;
+}
+
+std::int32_t controller_print(controller_id_e_t id, std::uint8_t line, std::uint8_t col, const char * fmt, ...)
+{
+    char buffer[64];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return controller_set_text(id, line, col, buffer);
+}
+
+std::int32_t controller_clear_line(controller_id_e_t id, std::uint8_t line)
+{
+    CONTROLLER_OR_RETURN(id);
+    if(line > 2)
+    {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    controller->text[line].clear();
+    return 1;
+}
+
+std::int32_t controller_clear(controller_id_e_t id)
+{
+    CONTROLLER_OR_RETURN(id);
+    for(std::string &text : controller->text)
+    {
+        text.clear();
+    }
+    return 1;
+}
+
+std::int32_t controller_rumble(controller_id_e_t id, const char * rumble_pattern)
+{
+    (void)rumble_pattern;
+    CONTROLLER_OR_RETURN(id);
+    return 1;
+}
+
+#undef CONTROLLER_OR_RETURN
+
+//Fully charged battery
+std::int32_t battery_get_voltage(void)
+{
+    return 12800;
+}
+
+std::int32_t battery_get_current(void)
+{
+    return 0;
+}
+
+double battery_get_temperature(void)
+{
+    return 25;
+}
+
+double battery_get_capacity(void)
+{
+    return 100;
+}
+
+} // namespace c
+
+//----------------------------------------------------------------------------//
+//                                PROS C++ API                                //
+//----------------------------------------------------------------------------//
+
+Controller::Controller(controller_id_e_t id) : _id(id)
+{
+}
+
+std::int32_t Controller::is_connected(void)
+{
+    return c::controller_is_connected(_id);
+}
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel)
+{
+    return c::controller_get_analog(_id, channel);
+}
+
+std::int32_t Controller::get_battery_capacity(void)
+{
+    return c::controller_get_battery_capacity(_id);
+}
+
+std::int32_t Controller::get_battery_level(void)
+{
+    return c::controller_get_battery_level(_id);
+}
+
+std::int32_t Controller::get_digital(controller_digital_e_t button)
+{
+    return c::controller_get_digital(_id, button);
+}
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button)
+{
+    return c::controller_get_digital_new_press(_id, button);
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const char * str)
+{
+    return c::controller_set_text(_id, line, col, str);
+}
+
+std::int32_t Controller::clear_line(std::uint8_t line)
+{
+    return c::controller_clear_line(_id, line);
+}
+
+std::int32_t Controller::rumble(const char * rumble_pattern)
+{
+    return c::controller_rumble(_id, rumble_pattern);
+}
+
+std::int32_t Controller::clear(void)
+{
+    return c::controller_clear(_id);
+}
+
+namespace battery
+{
+double get_capacity(void)
+{
+    return c::battery_get_capacity();
+}
+
+std::int32_t get_current(void)
+{
+    return c::battery_get_current();
+}
+
+double get_temperature(void)
+{
+    return c::battery_get_temperature();
+}
+
+std::int32_t get_voltage(void)
+{
+    return c::battery_get_voltage();
+}
+} // namespace battery
+
+namespace competition
+{
+std::uint8_t get_status(void)
+{
+    return c::competition_get_status();
+}
+
+std::uint8_t is_autonomous(void)
+{
+    return (c::competition_get_status() & COMPETITION_AUTONOMOUS) != 0;
+}
+
+std::uint8_t is_connected(void)
+{
+    return (c::competition_get_status() & COMPETITION_CONNECTED) != 0;
+}
+
+std::uint8_t is_disabled(void)
+{
+    return (c::competition_get_status() & COMPETITION_DISABLED) != 0;
+}
+} // namespace competition
+
+} // namespace pros
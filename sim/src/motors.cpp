@@ -0,0 +1,1091 @@
+#include "sim.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                               Motor Physics                                //
+//----------------------------------------------------------------------------//
+
+namespace sim
+{
+
+MotorConstants getMotorConstants(pros::motor_gearset_e_t gearset)
+{
+    //V5 smart motor: 2.5 A stall current at 12 V, cartridge sets free speed
+    //and stall torque at the output shaft
+    double freeSpeedRPM;
+    double stallTorque;
+    switch(gearset)
+    {
+        case pros::E_MOTOR_GEARSET_36:
+            freeSpeedRPM = 100;
+            stallTorque = 2.1;
+            break;
+        case pros::E_MOTOR_GEARSET_06:
+            freeSpeedRPM = 600;
+            stallTorque = 0.35;
+            break;
+        default:
+            freeSpeedRPM = 200;
+            stallTorque = 1.05;
+            break;
+    }
+
+    MotorConstants motor;
+    motor.freeSpeed = freeSpeedRPM * 2.0 * M_PI / 60.0;
+    motor.stallTorque = stallTorque;
+    motor.stallCurrent = 2.5;
+    motor.resistance = 12.0 / motor.stallCurrent;
+    motor.kT = motor.stallTorque / motor.stallCurrent;
+    motor.kE = 12.0 / motor.freeSpeed;
+    return motor;
+}
+
+double getMotorCurrent(const MotorConstants &motor, double voltage, double omega, double currentLimit)
+{
+    double current = (voltage - motor.kE * omega) / motor.resistance;
+    return std::max(-currentLimit, std::min(currentLimit, current));
+}
+
+namespace
+{
+    /**
+     * Default plant: a single motor turning a small inertia, sized so the
+     * motor reaches 63% of free speed in 50 ms
+     */
+    class DcMotorPlant : public MotorPlant
+    {
+        protected:
+            std::uint8_t port;
+            double angle = 0;
+            double omega = 0;
+        public:
+            explicit DcMotorPlant(std::uint8_t port) : port(port)
+            {
+            }
+
+            void step(double dt) override
+            {
+                MotorConstants motor = getMotorConstants(getMotorGearset(port));
+                double inertia = 0.05 * motor.kT * motor.kE / motor.resistance;
+                double friction = 0.02 * motor.stallTorque;
+
+                double current = isMotorCoasting(port) ? 0 :
+                    getMotorCurrent(motor, getMotorVoltage(port), omega, getMotorCurrentLimit(port));
+                double torque = motor.kT * current;
+
+                //Coulomb friction never reverses the shaft
+                double lastOmega = omega;
+                if(omega == 0 && std::abs(torque) <= friction)
+                {
+                    omega = 0;
+                }
+                else
+                {
+                    double direction = (omega != 0) ? std::copysign(1.0, omega) : std::copysign(1.0, torque);
+                    omega += (torque - friction * direction) / inertia * dt;
+                    if(lastOmega != 0 && std::signbit(omega) != std::signbit(lastOmega) && std::abs(torque) <= friction)
+                    {
+                        omega = 0;
+                    }
+                }
+                angle += omega * dt;
+
+                setMotorState(port, angle * 180.0 / M_PI, omega * 60.0 / (2.0 * M_PI), current, torque);
+            }
+    };
+
+//----------------------------------------------------------------------------//
+//                          Motor Firmware Emulation                          //
+//----------------------------------------------------------------------------//
+
+    enum class MotorMode
+    {
+        VOLTAGE,
+        VELOCITY,
+        POSITION
+    };
+
+    struct MotorState
+    {
+        bool present = false;
+        pros::motor_gearset_e_t gearset = pros::E_MOTOR_GEARSET_18;
+        pros::motor_encoder_units_e_t units = pros::E_MOTOR_ENCODER_DEGREES;
+        pros::motor_brake_mode_e_t brakeMode = pros::E_MOTOR_BRAKE_COAST;
+        bool reversed = false;
+        std::int32_t currentLimit = 2500;
+        std::int32_t voltageLimit = 12000;
+        pros::motor_pid_full_s_t posPID{};
+        pros::motor_pid_full_s_t velPID{};
+
+        //Command, in the user (possibly reversed) frame
+        MotorMode mode = MotorMode::VOLTAGE;
+        std::int32_t targetVoltage = 0;
+        std::int32_t targetVelocity = 0;
+        //Raw (untared) target, degrees
+        double targetPosition = 0;
+        std::int32_t profileVelocity = 0;
+        //Raw position to hold while stopped in hold mode, degrees
+        double holdPosition = 0;
+        bool holding = false;
+        double integral = 0;
+
+        //Output, in the physical frame
+        double appliedVoltage = 0;
+        bool coasting = true;
+
+        //Shaft state, in the physical frame
+        double position = 0;
+        double velocity = 0;
+        double current = 0;
+        double torque = 0;
+        double temperature = 25;
+
+        //Raw position reported as zero, degrees
+        double zeroPosition = 0;
+
+        std::shared_ptr<MotorPlant> plant;
+    };
+
+    struct Motors
+    {
+        std::mutex lock;
+        std::array<MotorState, NUM_V5_PORTS + 1> ports;
+    };
+
+    Motors &motors()
+    {
+        static Motors * instance = new Motors();
+        return *instance;
+    }
+
+    double ticksPerRev(pros::motor_gearset_e_t gearset)
+    {
+        switch(gearset)
+        {
+            case pros::E_MOTOR_GEARSET_36:
+                return 1800;
+            case pros::E_MOTOR_GEARSET_06:
+                return 300;
+            default:
+                return 900;
+        }
+    }
+
+    double freeSpeedRPM(pros::motor_gearset_e_t gearset)
+    {
+        return getMotorConstants(gearset).freeSpeed * 60.0 / (2.0 * M_PI);
+    }
+
+    /**
+     * converts encoder units to degrees
+     */
+    double toDegrees(const MotorState &motor, double value)
+    {
+        switch(motor.units)
+        {
+            case pros::E_MOTOR_ENCODER_ROTATIONS:
+                return value * 360.0;
+            case pros::E_MOTOR_ENCODER_COUNTS:
+                return value * 360.0 / ticksPerRev(motor.gearset);
+            default:
+                return value;
+        }
+    }
+
+    /**
+     * converts degrees to encoder units
+     */
+    double fromDegrees(const MotorState &motor, double value)
+    {
+        switch(motor.units)
+        {
+            case pros::E_MOTOR_ENCODER_ROTATIONS:
+                return value / 360.0;
+            case pros::E_MOTOR_ENCODER_COUNTS:
+                return value * ticksPerRev(motor.gearset) / 360.0;
+            default:
+                return value;
+        }
+    }
+
+    double userSign(const MotorState &motor)
+    {
+        return motor.reversed ? -1.0 : 1.0;
+    }
+
+    //Raw position and velocity in the user frame
+    double rawPosition(const MotorState &motor)
+    {
+        return userSign(motor) * motor.position;
+    }
+
+    double userVelocity(const MotorState &motor)
+    {
+        return userSign(motor) * motor.velocity;
+    }
+
+    /**
+     * gets a port's state, or nullptr and sets errno if the port is invalid;
+     * must be called with the lock held
+     */
+    MotorState * getMotor(std::uint32_t port)
+    {
+        if(port < 1 || port > NUM_V5_PORTS)
+        {
+            errno = EINVAL;
+            return nullptr;
+        }
+        MotorState &motor = motors().ports[port];
+        if(!motor.present)
+        {
+            motor.present = true;
+            motor.plant = std::make_shared<DcMotorPlant>(static_cast<std::uint8_t>(port));
+        }
+        return &motor;
+    }
+
+    /**
+     * switches control mode; a motor repeatedly commanded to stop keeps
+     * holding the position it first stopped at
+     */
+    void setMode(MotorState &motor, MotorMode mode, bool stopping)
+    {
+        if(motor.mode != mode)
+        {
+            motor.integral = 0;
+            motor.holding = false;
+        }
+        if(!stopping)
+        {
+            motor.holding = false;
+        }
+        motor.mode = mode;
+    }
+
+    /**
+     * velocity loop, in the user frame
+     */
+    double velocityControl(MotorState &motor, double targetRPM, double dt)
+    {
+        double freeRPM = freeSpeedRPM(motor.gearset);
+        double error = targetRPM - userVelocity(motor);
+        motor.integral = std::max(-6.0, std::min(6.0, motor.integral + 12.0 / freeRPM * 10.0 * error * dt));
+        return targetRPM / freeRPM * 12.0 + 12.0 / freeRPM * 1.5 * error + motor.integral;
+    }
+
+    /**
+     * position loop feeding the velocity loop, in the user frame
+     */
+    double positionControl(MotorState &motor, double targetRaw, double maxRPM, double dt)
+    {
+        double freeRPM = freeSpeedRPM(motor.gearset);
+        double targetRPM = (targetRaw - rawPosition(motor)) * freeRPM / 100.0 * 1.5;
+        return velocityControl(motor, std::max(-maxRPM, std::min(maxRPM, targetRPM)), dt);
+    }
+
+    /**
+     * behaviour when commanded to zero, according to the brake mode
+     */
+    double stoppedControl(MotorState &motor, double dt)
+    {
+        switch(motor.brakeMode)
+        {
+            case pros::E_MOTOR_BRAKE_HOLD:
+                if(!motor.holding)
+                {
+                    motor.holding = true;
+                    motor.holdPosition = rawPosition(motor);
+                    motor.integral = 0;
+                }
+                motor.coasting = false;
+                return positionControl(motor, motor.holdPosition, freeSpeedRPM(motor.gearset), dt);
+            case pros::E_MOTOR_BRAKE_BRAKE:
+                //Windings shorted
+                motor.coasting = false;
+                return 0;
+            default:
+                motor.coasting = true;
+                return 0;
+        }
+    }
+
+    void updateMotor(MotorState &motor, double dt)
+    {
+        double voltage = 0;
+        motor.coasting = false;
+        switch(motor.mode)
+        {
+            case MotorMode::VOLTAGE:
+                voltage = (motor.targetVoltage == 0) ? stoppedControl(motor, dt) : motor.targetVoltage / 1000.0;
+                break;
+            case MotorMode::VELOCITY:
+                voltage = (motor.targetVelocity == 0) ? stoppedControl(motor, dt) :
+                    velocityControl(motor, motor.targetVelocity, dt);
+                break;
+            case MotorMode::POSITION:
+                voltage = positionControl(motor, motor.targetPosition, motor.profileVelocity, dt);
+                break;
+        }
+
+        double limit = std::min(12000, motor.voltageLimit) / 1000.0;
+        motor.appliedVoltage = userSign(motor) * std::max(-limit, std::min(limit, voltage));
+    }
+
+    void tick(double dt)
+    {
+        Motors &m = motors();
+        std::vector<std::shared_ptr<MotorPlant>> plants;
+        {
+            std::lock_guard<std::mutex> lk(m.lock);
+            for(MotorState &motor : m.ports)
+            {
+                if(!motor.present)
+                {
+                    continue;
+                }
+                updateMotor(motor, dt);
+                if(std::find(plants.begin(), plants.end(), motor.plant) == plants.end())
+                {
+                    plants.push_back(motor.plant);
+                }
+            }
+        }
+
+        for(std::shared_ptr<MotorPlant> &plant : plants)
+        {
+            plant->step(dt);
+        }
+
+        std::lock_guard<std::mutex> lk(m.lock);
+        for(MotorState &motor : m.ports)
+        {
+            if(motor.present)
+            {
+                //Winding losses heat the motor, the case cools toward ambient
+                double resistance = getMotorConstants(motor.gearset).resistance;
+                motor.temperature += (motor.current * motor.current * resistance / 40.0 - (motor.temperature - 25.0) / 300.0) * dt;
+            }
+        }
+    }
+
+    struct TickRegistration
+    {
+        TickRegistration()
+        {
+            addTickHook(tick);
+        }
+    } tickRegistration;
+} // namespace
+
+double getMotorVoltage(std::uint8_t port)
+{
+    std::lock_guard<std::mutex> lk(motors().lock);
+    MotorState * motor = getMotor(port);
+    return (motor != nullptr) ? motor->appliedVoltage : 0;
+}
+
+bool isMotorCoasting(std::uint8_t port)
+{
+    std::lock_guard<std::mutex> lk(motors().lock);
+    MotorState * motor = getMotor(port);
+    return (motor != nullptr) ? motor->coasting : true;
+}
+
+double getMotorCurrentLimit(std::uint8_t port)
+{
+    std::lock_guard<std::mutex> lk(motors().lock);
+    MotorState * motor = getMotor(port);
+    return (motor != nullptr) ? motor->currentLimit / 1000.0 : 0;
+}
+
+pros::motor_gearset_e_t getMotorGearset(std::uint8_t port)
+{
+    std::lock_guard<std::mutex> lk(motors().lock);
+    MotorState * motor = getMotor(port);
+    return (motor != nullptr) ? motor->gearset : pros::E_MOTOR_GEARSET_INVALID;
+}
+
+void setMotorState(std::uint8_t port, double position, double velocity, double current, double torque)
+{
+    std::lock_guard<std::mutex> lk(motors().lock);
+    if(MotorState * motor = getMotor(port))
+    {
+        motor->position = position;
+        motor->velocity = velocity;
+        motor->current = current;
+        motor->torque = torque;
+    }
+}
+
+void attachPlant(const std::shared_ptr<MotorPlant> &plant, std::initializer_list<std::uint8_t> ports)
+{
+    std::lock_guard<std::mutex> lk(motors().lock);
+    for(std::uint8_t port : ports)
+    {
+        if(MotorState * motor = getMotor(port))
+        {
+            motor->plant = plant;
+        }
+    }
+}
+
+} // namespace sim
+
+//----------------------------------------------------------------------------//
+//                                 PROS C API                                 //
+//----------------------------------------------------------------------------//
+
+namespace pros
+{
+namespace c
+{
+
+using sim::MotorMode;
+using sim::MotorState;
+
+#define MOTOR_OR_RETURN(port, err)                                 \
+    std::lock_guard<std::mutex> lk(sim::motors().lock);            \
+    MotorState * motor = sim::getMotor(port);                      \
+    if(motor == nullptr)                                           \
+    {                                                              \
+        return err;                                                \
+    }
+
+std::int32_t motor_move(std::uint8_t port, std::int32_t voltage)
+{
+    voltage = std::max(-127, std::min(127, voltage));
+    return motor_move_voltage(port, voltage * 12000 / 127);
+}
+
+std::int32_t motor_move_absolute(std::uint8_t port, const double position, const std::int32_t velocity)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    sim::setMode(*motor, MotorMode::POSITION, false);
+    motor->targetPosition = sim::toDegrees(*motor, position) + motor->zeroPosition;
+    motor->profileVelocity = std::abs(velocity);
+    return 1;
+}
+
+std::int32_t motor_move_relative(std::uint8_t port, const double position, const std::int32_t velocity)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    sim::setMode(*motor, MotorMode::POSITION, false);
+    motor->targetPosition = sim::rawPosition(*motor) + sim::toDegrees(*motor, position);
+    motor->profileVelocity = std::abs(velocity);
+    return 1;
+}
+
+std::int32_t motor_move_velocity(std::uint8_t port, const std::int32_t velocity)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    sim::setMode(*motor, MotorMode::VELOCITY, velocity == 0);
+    double maxRPM = sim::freeSpeedRPM(motor->gearset);
+    motor->targetVelocity = static_cast<std::int32_t>(std::max(-maxRPM, std::min(maxRPM, static_cast<double>(velocity))));
+    return 1;
+}
+
+std::int32_t motor_move_voltage(std::uint8_t port, const std::int32_t voltage)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    sim::setMode(*motor, MotorMode::VOLTAGE, voltage == 0);
+    motor->targetVoltage = std::max(-12000, std::min(12000, voltage));
+    return 1;
+}
+
+std::int32_t motor_modify_profiled_velocity(std::uint8_t port, const std::int32_t velocity)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->profileVelocity = std::abs(velocity);
+    return 1;
+}
+
+double motor_get_target_position(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    return sim::fromDegrees(*motor, motor->targetPosition - motor->zeroPosition);
+}
+
+std::int32_t motor_get_target_velocity(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return motor->targetVelocity;
+}
+
+double motor_get_actual_velocity(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    return sim::userVelocity(*motor);
+}
+
+std::int32_t motor_get_current_draw(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return static_cast<std::int32_t>(std::abs(motor->current) * 1000.0);
+}
+
+std::int32_t motor_get_direction(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return (sim::userVelocity(*motor) < 0) ? -1 : 1;
+}
+
+double motor_get_efficiency(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    double input = std::abs(motor->appliedVoltage * motor->current);
+    double output = std::abs(motor->torque * motor->velocity * 2.0 * M_PI / 60.0);
+    return (input > 0) ? std::min(100.0, output / input * 100.0) : 0;
+}
+
+std::int32_t motor_is_over_current(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return std::abs(motor->current) * 1000.0 >= motor->currentLimit;
+}
+
+std::int32_t motor_is_over_temp(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return motor->temperature >= 55;
+}
+
+std::int32_t motor_is_stopped(std::uint32_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return std::abs(motor->velocity) < 1;
+}
+
+std::int32_t motor_get_zero_position_flag(std::uint32_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return std::abs(sim::rawPosition(*motor) - motor->zeroPosition) < 0.5;
+}
+
+std::uint32_t motor_get_faults(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    std::uint32_t faults = E_MOTOR_FAULT_NO_FAULTS;
+    if(motor->temperature >= 55)
+    {
+        faults |= E_MOTOR_FAULT_MOTOR_OVER_TEMP;
+    }
+    if(std::abs(motor->current) * 1000.0 >= motor->currentLimit)
+    {
+        faults |= E_MOTOR_FAULT_OVER_CURRENT;
+    }
+    return faults;
+}
+
+std::uint32_t motor_get_flags(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    std::uint32_t flags = E_MOTOR_FLAGS_NONE;
+    if(std::abs(motor->velocity) < 1)
+    {
+        flags |= E_MOTOR_FLAGS_ZERO_VELOCITY;
+    }
+    if(std::abs(sim::rawPosition(*motor) - motor->zeroPosition) < 0.5)
+    {
+        flags |= E_MOTOR_FLAGS_ZERO_POSITION;
+    }
+    return flags;
+}
+
+std::int32_t motor_get_raw_position(std::uint8_t port, std::uint32_t * const timestamp)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    if(timestamp != nullptr)
+    {
+        *timestamp = millis();
+    }
+    return static_cast<std::int32_t>(sim::rawPosition(*motor) * sim::ticksPerRev(motor->gearset) / 360.0);
+}
+
+double motor_get_position(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    return sim::fromDegrees(*motor, sim::rawPosition(*motor) - motor->zeroPosition);
+}
+
+double motor_get_power(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    return std::abs(motor->appliedVoltage * motor->current);
+}
+
+double motor_get_temperature(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    return motor->temperature;
+}
+
+double motor_get_torque(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR_F);
+    return std::abs(motor->torque);
+}
+
+std::int32_t motor_get_voltage(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return static_cast<std::int32_t>(sim::userSign(*motor) * motor->appliedVoltage * 1000.0);
+}
+
+std::int32_t motor_set_zero_position(std::uint8_t port, const double position)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->zeroPosition = sim::toDegrees(*motor, position);
+    return 1;
+}
+
+std::int32_t motor_tare_position(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->zeroPosition = sim::rawPosition(*motor);
+    return 1;
+}
+
+std::int32_t motor_set_brake_mode(std::uint8_t port, const motor_brake_mode_e_t mode)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->brakeMode = mode;
+    motor->holding = false;
+    return 1;
+}
+
+std::int32_t motor_set_current_limit(std::uint8_t port, const std::int32_t limit)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->currentLimit = std::max(0, std::min(2500, limit));
+    return 1;
+}
+
+std::int32_t motor_set_encoder_units(std::uint8_t port, const motor_encoder_units_e_t units)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->units = units;
+    return 1;
+}
+
+std::int32_t motor_set_gearing(std::uint8_t port, const motor_gearset_e_t gearset)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->gearset = gearset;
+    return 1;
+}
+
+motor_pid_s_t motor_convert_pid(double kf, double kp, double ki, double kd)
+{
+    motor_pid_s_t pid;
+    pid.kf = static_cast<std::uint8_t>(kf * 16.0);
+    pid.kp = static_cast<std::uint8_t>(kp * 16.0);
+    pid.ki = static_cast<std::uint8_t>(ki * 16.0);
+    pid.kd = static_cast<std::uint8_t>(kd * 16.0);
+    return pid;
+}
+
+motor_pid_full_s_t motor_convert_pid_full(double kf, double kp, double ki, double kd, double filter, double limit,
+    double threshold, double loopspeed)
+{
+    motor_pid_full_s_t pid;
+    pid.kf = static_cast<std::uint8_t>(kf * 16.0);
+    pid.kp = static_cast<std::uint8_t>(kp * 16.0);
+    pid.ki = static_cast<std::uint8_t>(ki * 16.0);
+    pid.kd = static_cast<std::uint8_t>(kd * 16.0);
+    pid.filter = static_cast<std::uint8_t>(filter * 16.0);
+    pid.limit = static_cast<std::uint16_t>(limit * 16.0);
+    pid.threshold = static_cast<std::uint8_t>(threshold * 16.0);
+    pid.loopspeed = static_cast<std::uint8_t>(loopspeed * 16.0);
+    return pid;
+}
+
+//Gains are stored so they can be read back; the emulated firmware keeps its
+//own fixed loops
+std::int32_t motor_set_pos_pid(std::uint8_t port, const motor_pid_s_t pid)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->posPID.kf = pid.kf;
+    motor->posPID.kp = pid.kp;
+    motor->posPID.ki = pid.ki;
+    motor->posPID.kd = pid.kd;
+    return 1;
+}
+
+std::int32_t motor_set_pos_pid_full(std::uint8_t port, const motor_pid_full_s_t pid)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->posPID = pid;
+    return 1;
+}
+
+std::int32_t motor_set_vel_pid(std::uint8_t port, const motor_pid_s_t pid)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->velPID.kf = pid.kf;
+    motor->velPID.kp = pid.kp;
+    motor->velPID.ki = pid.ki;
+    motor->velPID.kd = pid.kd;
+    return 1;
+}
+
+std::int32_t motor_set_vel_pid_full(std::uint8_t port, const motor_pid_full_s_t pid)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->velPID = pid;
+    return 1;
+}
+
+std::int32_t motor_set_reversed(std::uint8_t port, const bool reverse)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->reversed = reverse;
+    return 1;
+}
+
+std::int32_t motor_set_voltage_limit(std::uint8_t port, const std::int32_t limit)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    motor->voltageLimit = std::max(0, std::min(12000, limit));
+    return 1;
+}
+
+motor_brake_mode_e_t motor_get_brake_mode(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, E_MOTOR_BRAKE_INVALID);
+    return motor->brakeMode;
+}
+
+std::int32_t motor_get_current_limit(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return motor->currentLimit;
+}
+
+motor_encoder_units_e_t motor_get_encoder_units(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, E_MOTOR_ENCODER_INVALID);
+    return motor->units;
+}
+
+motor_gearset_e_t motor_get_gearing(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, E_MOTOR_GEARSET_INVALID);
+    return motor->gearset;
+}
+
+motor_pid_full_s_t motor_get_pos_pid(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, motor_pid_full_s_t{});
+    return motor->posPID;
+}
+
+motor_pid_full_s_t motor_get_vel_pid(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, motor_pid_full_s_t{});
+    return motor->velPID;
+}
+
+std::int32_t motor_is_reversed(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return motor->reversed;
+}
+
+std::int32_t motor_get_voltage_limit(std::uint8_t port)
+{
+    MOTOR_OR_RETURN(port, PROS_ERR);
+    return motor->voltageLimit;
+}
+
+#undef MOTOR_OR_RETURN
+
+} // namespace c
+
+//----------------------------------------------------------------------------//
+//                                PROS C++ API                                //
+//----------------------------------------------------------------------------//
+
+Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset, const bool reverse,
+    const motor_encoder_units_e_t encoder_units)
+    : _port(port)
+{
+    set_gearing(gearset);
+    set_reversed(reverse);
+    set_encoder_units(encoder_units);
+}
+
+Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset, const bool reverse) : _port(port)
+{
+    set_gearing(gearset);
+    set_reversed(reverse);
+}
+
+Motor::Motor(const std::uint8_t port, const motor_gearset_e_t gearset) : _port(port)
+{
+    set_gearing(gearset);
+}
+
+Motor::Motor(const std::uint8_t port, const bool reverse) : _port(port)
+{
+    set_reversed(reverse);
+}
+
+Motor::Motor(const std::uint8_t port) : _port(port)
+{
+}
+
+std::int32_t Motor::operator=(std::int32_t voltage) const
+{
+    return c::motor_move(_port, voltage);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const
+{
+    return c::motor_move(_port, voltage);
+}
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const
+{
+    return c::motor_move_absolute(_port, position, velocity);
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const
+{
+    return c::motor_move_relative(_port, position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const
+{
+    return c::motor_move_velocity(_port, velocity);
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const
+{
+    return c::motor_move_voltage(_port, voltage);
+}
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const
+{
+    return c::motor_modify_profiled_velocity(_port, velocity);
+}
+
+double Motor::get_target_position(void) const
+{
+    return c::motor_get_target_position(_port);
+}
+
+std::int32_t Motor::get_target_velocity(void) const
+{
+    return c::motor_get_target_velocity(_port);
+}
+
+double Motor::get_actual_velocity(void) const
+{
+    return c::motor_get_actual_velocity(_port);
+}
+
+std::int32_t Motor::get_current_draw(void) const
+{
+    return c::motor_get_current_draw(_port);
+}
+
+std::int32_t Motor::get_direction(void) const
+{
+    return c::motor_get_direction(_port);
+}
+
+double Motor::get_efficiency(void) const
+{
+    return c::motor_get_efficiency(_port);
+}
+
+std::int32_t Motor::is_over_current(void) const
+{
+    return c::motor_is_over_current(_port);
+}
+
+std::int32_t Motor::is_stopped(void) const
+{
+    return c::motor_is_stopped(_port);
+}
+
+std::int32_t Motor::get_zero_position_flag(void) const
+{
+    return c::motor_get_zero_position_flag(_port);
+}
+
+std::uint32_t Motor::get_faults(void) const
+{
+    return c::motor_get_faults(_port);
+}
+
+std::uint32_t Motor::get_flags(void) const
+{
+    return c::motor_get_flags(_port);
+}
+
+std::int32_t Motor::get_raw_position(std::uint32_t * const timestamp) const
+{
+    return c::motor_get_raw_position(_port, timestamp);
+}
+
+std::int32_t Motor::is_over_temp(void) const
+{
+    return c::motor_is_over_temp(_port);
+}
+
+double Motor::get_position(void) const
+{
+    return c::motor_get_position(_port);
+}
+
+double Motor::get_power(void) const
+{
+    return c::motor_get_power(_port);
+}
+
+double Motor::get_temperature(void) const
+{
+    return c::motor_get_temperature(_port);
+}
+
+double Motor::get_torque(void) const
+{
+    return c::motor_get_torque(_port);
+}
+
+std::int32_t Motor::get_voltage(void) const
+{
+    return c::motor_get_voltage(_port);
+}
+
+std::int32_t Motor::set_zero_position(const double position) const
+{
+    return c::motor_set_zero_position(_port, position);
+}
+
+std::int32_t Motor::tare_position(void) const
+{
+    return c::motor_tare_position(_port);
+}
+
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode) const
+{
+    return c::motor_set_brake_mode(_port, mode);
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit) const
+{
+    return c::motor_set_current_limit(_port, limit);
+}
+
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t units) const
+{
+    return c::motor_set_encoder_units(_port, units);
+}
+
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset) const
+{
+    return c::motor_set_gearing(_port, gearset);
+}
+
+motor_pid_s_t Motor::convert_pid(double kf, double kp, double ki, double kd)
+{
+    return c::motor_convert_pid(kf, kp, ki, kd);
+}
+
+motor_pid_full_s_t Motor::convert_pid_full(double kf, double kp, double ki, double kd, double filter, double limit,
+    double threshold, double loopspeed)
+{
+    return c::motor_convert_pid_full(kf, kp, ki, kd, filter, limit, threshold, loopspeed);
+}
+
+std::int32_t Motor::set_pos_pid(const motor_pid_s_t pid) const
+{
+    return c::motor_set_pos_pid(_port, pid);
+}
+
+std::int32_t Motor::set_pos_pid_full(const motor_pid_full_s_t pid) const
+{
+    return c::motor_set_pos_pid_full(_port, pid);
+}
+
+std::int32_t Motor::set_vel_pid(const motor_pid_s_t pid) const
+{
+    return c::motor_set_vel_pid(_port, pid);
+}
+
+std::int32_t Motor::set_vel_pid_full(const motor_pid_full_s_t pid) const
+{
+    return c::motor_set_vel_pid_full(_port, pid);
+}
+
+std::int32_t Motor::set_reversed(const bool reverse) const
+{
+    return c::motor_set_reversed(_port, reverse);
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit) const
+{
+    return c::motor_set_voltage_limit(_port, limit);
+}
+
+motor_brake_mode_e_t Motor::get_brake_mode(void) const
+{
+    return c::motor_get_brake_mode(_port);
+}
+
+std::int32_t Motor::get_current_limit(void) const
+{
+    return c::motor_get_current_limit(_port);
+}
+
+motor_encoder_units_e_t Motor::get_encoder_units(void) const
+{
+    return c::motor_get_encoder_units(_port);
+}
+
+motor_gearset_e_t Motor::get_gearing(void) const
+{
+    return c::motor_get_gearing(_port);
+}
+
+motor_pid_full_s_t Motor::get_pos_pid(void) const
+{
+    return c::motor_get_pos_pid(_port);
+}
+
+motor_pid_full_s_t Motor::get_vel_pid(void) const
+{
+    return c::motor_get_vel_pid(_port);
+}
+
+std::int32_t Motor::is_reversed(void) const
+{
+    return c::motor_is_reversed(_port);
+}
+
+std::int32_t Motor::get_voltage_limit(void) const
+{
+    return c::motor_get_voltage_limit(_port);
+}
+
+namespace literals
+{
+const pros::Motor operator"" _mtr(const unsigned long long int m)
+{
+    return pros::Motor(static_cast<std::uint8_t>(m), false);
+}
+
+const pros::Motor operator"" _rmtr(const unsigned long long int m)
+{
+    return pros::Motor(static_cast<std::uint8_t>(m), true);
+}
+} // namespace literals
+
+} // namespace pros
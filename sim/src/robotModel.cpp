@@ -0,0 +1,79 @@
+#include "main.h"
+#include "robotModel.hpp"
+#include "subsystems.hpp"
+#include <cmath>
+
+namespace sim
+{
+namespace
+{
+    double toRadians(double degrees)
+    {
+        return degrees * M_PI / 180.0;
+    }
+
+    /**
+     * gets the puncher angle whose setting is nearest the angle adjuster
+     */
+    PuncherAngle &nearestPuncherAngle(double adjusterDegrees)
+    {
+        PuncherAngle * angles[] = {&PuncherAngles::NEAR_HIGH_FLAG, &PuncherAngles::NEAR_LOW_FLAG,
+            &PuncherAngles::FAR_HIGH_FLAG, &PuncherAngles::FAR_LOW_FLAG};
+        PuncherAngle * nearest = angles[0];
+        for(PuncherAngle * angle : angles)
+        {
+            if(std::abs(angle->getAngleValue() - adjusterDegrees) < std::abs(nearest->getAngleValue() - adjusterDegrees))
+            {
+                nearest = angle;
+            }
+        }
+        return *nearest;
+    }
+} // namespace
+
+RobotModel attachRobotModel()
+{
+    RobotModel robot;
+
+    //Drivetrain: left {10, 3}, right {-1, -2}
+    robot.drivetrain = std::make_shared<SkidSteerBatch>(1);
+    attachPlant(std::shared_ptr<MotorPlant>(new SkidSteerPlant(robot.drivetrain, {10, 3}, {-1, -2})),
+        {10, 3, 1, 2});
+
+    //Cap lift: 5:3 reduction, resting 60 degrees below horizontal against
+    //its lower stop, with its upper stop just past vertical on the far side
+    robot.capLift = std::make_shared<MechanismSimulator>(0.4, 0.15, 0.2, 0.1);
+    robot.capLift->setGearRatio(5.0 / 3.0);
+    robot.capLift->setHardStops(0, toRadians(185));
+    robot.capLift->setExternalTorqueFunction([](double angle, double mass, double linkLength) {
+        return -mass * 9.81 * linkLength * std::cos(angle - toRadians(60));
+    });
+    attachPlant(std::make_shared<MechanismPlant>(robot.capLift, 20), {20});
+
+    //Angle adjuster: a light arm on the motor shaft
+    robot.angleAdjuster = std::make_shared<MechanismSimulator>(0.15, 0.08, 0.05, 0.03);
+    robot.angleAdjuster->setHardStops(0, toRadians(100));
+    attachPlant(std::make_shared<MechanismPlant>(robot.angleAdjuster, 7), {7});
+
+    //Puncher: reversed on port 9; the punch travels through the cap lift's
+    //interference range for the current angle
+    robot.puncher = std::make_shared<PuncherSimulator>();
+    std::weak_ptr<MechanismSimulator> capLift = robot.capLift;
+    std::weak_ptr<MechanismSimulator> angleAdjuster = robot.angleAdjuster;
+    robot.puncher->setObstruction([capLift, angleAdjuster]() {
+        auto lift = capLift.lock();
+        auto adjuster = angleAdjuster.lock();
+        if(!lift || !adjuster)
+        {
+            return false;
+        }
+        PuncherAngle &angle = nearestPuncherAngle(adjuster->getAngle() * 180.0 / M_PI);
+        double liftDegrees = lift->getAngle() * 180.0 / M_PI;
+        return liftDegrees > angle.getLowerInterferenceBound() && liftDegrees < angle.getUpperInterferenceBound();
+    });
+    attachPlant(std::make_shared<MechanismPlant>(robot.puncher, -9), {9});
+
+    return robot;
+}
+
+} // namespace sim
@@ -0,0 +1,766 @@
+#include "sim.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------//
+//                                 Scheduler                                  //
+//----------------------------------------------------------------------------//
+
+namespace sim
+{
+namespace
+{
+    const std::uint64_t NEVER = UINT64_MAX;
+    const std::uint64_t TICK_US = 1000;
+
+    enum class TaskState
+    {
+        READY,
+        DELAYED,
+        BLOCKED,
+        SUSPENDED,
+        DELETED
+    };
+
+    struct SimMutex;
+
+    struct SimTask
+    {
+        std::string name;
+        std::uint32_t priority = TASK_PRIORITY_DEFAULT;
+        pros::task_fn_t function = nullptr;
+        void * parameters = nullptr;
+        //Thread was not created by the scheduler (e.g. a THREADS_STD okapi
+        //thread) and joined it on its first blocking call
+        bool adopted = false;
+        TaskState state = TaskState::READY;
+        std::uint64_t wakeTime = NEVER;
+        std::uint64_t readyOrder = 0;
+        SimMutex * waitingOn = nullptr;
+        bool waitingForNotify = false;
+        std::uint32_t notifyValue = 0;
+        std::condition_variable resume;
+        std::thread thread;
+    };
+
+    struct SimMutex
+    {
+        SimTask * owner = nullptr;
+    };
+
+    struct Scheduler
+    {
+        std::mutex lock;
+        std::condition_variable stopped;
+        std::vector<SimTask *> tasks;
+        std::vector<TickHook> tickHooks;
+        SimTask * current = nullptr;
+        std::atomic<std::uint64_t> now{0};
+        std::uint64_t nextTick = TICK_US;
+        std::uint64_t endTime = NEVER;
+        std::uint64_t readyCount = 0;
+        bool finished = false;
+    };
+
+    //Never destroyed so that threads still running during static destruction
+    //(e.g. okapi loops being joined) can safely reach it
+    Scheduler &scheduler()
+    {
+        static Scheduler * instance = new Scheduler();
+        return *instance;
+    }
+
+    thread_local SimTask * self = nullptr;
+
+    void makeReady(Scheduler &s, SimTask * task)
+    {
+        task->state = TaskState::READY;
+        task->wakeTime = NEVER;
+        task->readyOrder = s.readyCount++;
+    }
+
+    /**
+     * gets the task making the current call, adopting foreign threads
+     */
+    SimTask * currentTask(Scheduler &s)
+    {
+        if(self == nullptr)
+        {
+            self = new SimTask();
+            self->name = "adopted";
+            self->adopted = true;
+            s.tasks.push_back(self);
+            makeReady(s, self);
+        }
+        return self;
+    }
+
+    SimTask * pickReady(Scheduler &s)
+    {
+        SimTask * best = nullptr;
+        for(SimTask * task : s.tasks)
+        {
+            if(task->state != TaskState::READY)
+            {
+                continue;
+            }
+            if(best == nullptr || task->priority > best->priority ||
+                (task->priority == best->priority && task->readyOrder < best->readyOrder))
+            {
+                best = task;
+            }
+        }
+        return best;
+    }
+
+    void advanceTo(Scheduler &s, std::uint64_t time)
+    {
+        while(s.nextTick <= time)
+        {
+            s.now = s.nextTick;
+            for(TickHook &hook : s.tickHooks)
+            {
+                hook(TICK_US / 1e6);
+            }
+            s.nextTick += TICK_US;
+        }
+        if(time > s.now)
+        {
+            s.now = time;
+        }
+    }
+
+    void finish(Scheduler &s)
+    {
+        s.finished = true;
+        s.current = nullptr;
+        for(SimTask * task : s.tasks)
+        {
+            task->resume.notify_all();
+        }
+        s.stopped.notify_all();
+    }
+
+    /**
+     * hands the simulated CPU to the next ready task, advancing the virtual
+     * clock while every task is asleep; must be called with the lock held
+     */
+    void dispatch(Scheduler &s)
+    {
+        while(!s.finished)
+        {
+            if(SimTask * next = pickReady(s))
+            {
+                s.current = next;
+                next->resume.notify_all();
+                return;
+            }
+
+            std::uint64_t wake = NEVER;
+            for(SimTask * task : s.tasks)
+            {
+                if((task->state == TaskState::DELAYED || task->state == TaskState::BLOCKED) && task->wakeTime < wake)
+                {
+                    wake = task->wakeTime;
+                }
+            }
+
+            //Nothing left to run before the end of the simulation
+            if(wake == NEVER || wake > s.endTime)
+            {
+                if(s.endTime != NEVER)
+                {
+                    advanceTo(s, s.endTime);
+                }
+                finish(s);
+                return;
+            }
+
+            advanceTo(s, wake);
+            for(SimTask * task : s.tasks)
+            {
+                if((task->state == TaskState::DELAYED || task->state == TaskState::BLOCKED) && task->wakeTime <= s.now)
+                {
+                    task->waitingOn = nullptr;
+                    task->waitingForNotify = false;
+                    makeReady(s, task);
+                }
+            }
+        }
+    }
+
+    /**
+     * waits until the calling task holds the simulated CPU again
+     */
+    void waitForTurn(Scheduler &s, std::unique_lock<std::mutex> &lk)
+    {
+        SimTask * task = self;
+        task->resume.wait(lk, [&] { return s.current == task || s.finished; });
+        if(s.finished || task->state == TaskState::DELETED)
+        {
+            if(!task->adopted)
+            {
+                throw TaskKilled();
+            }
+            //Let foreign threads wind down on their own; slow them to real
+            //time so their loops don't spin
+            lk.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            lk.lock();
+        }
+    }
+
+    /**
+     * gives up the simulated CPU after the caller has set its own state, and
+     * returns once it is scheduled again
+     */
+    void block(Scheduler &s, std::unique_lock<std::mutex> &lk)
+    {
+        if(s.current == self)
+        {
+            dispatch(s);
+        }
+        if(s.current != self)
+        {
+            waitForTurn(s, lk);
+        }
+    }
+
+    void taskEntry(SimTask * task)
+    {
+        Scheduler &s = scheduler();
+        self = task;
+        try
+        {
+            {
+                std::unique_lock<std::mutex> lk(s.lock);
+                waitForTurn(s, lk);
+            }
+            task->function(task->parameters);
+        }
+        catch(const TaskKilled &)
+        {
+        }
+
+        std::unique_lock<std::mutex> lk(s.lock);
+        if(!s.finished && task->state != TaskState::DELETED)
+        {
+            task->state = TaskState::DELETED;
+            if(s.current == task)
+            {
+                dispatch(s);
+            }
+        }
+    }
+
+    SimTask * toTask(pros::task_t task)
+    {
+        return static_cast<SimTask *>(task);
+    }
+} // namespace
+
+std::uint64_t micros()
+{
+    return scheduler().now.load();
+}
+
+void sleepUntil(std::uint64_t wakeTime)
+{
+    Scheduler &s = scheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    SimTask * task = currentTask(s);
+    task->state = TaskState::DELAYED;
+    task->wakeTime = wakeTime;
+    block(s, lk);
+}
+
+void addTickHook(TickHook hook)
+{
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    s.tickHooks.push_back(std::move(hook));
+}
+
+pros::task_t createTask(pros::task_fn_t function, void * parameters, const char * name, std::uint32_t prio)
+{
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    SimTask * task = new SimTask();
+    task->name = (name != nullptr) ? name : "";
+    task->priority = prio;
+    task->function = function;
+    task->parameters = parameters;
+    s.tasks.push_back(task);
+    makeReady(s, task);
+    task->thread = std::thread(taskEntry, task);
+    return task;
+}
+
+void run(std::uint32_t durationMs)
+{
+    Scheduler &s = scheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    s.endTime = s.now + static_cast<std::uint64_t>(durationMs) * TICK_US;
+    if(s.current == nullptr)
+    {
+        dispatch(s);
+    }
+    s.stopped.wait(lk, [&] { return s.finished; });
+}
+
+void shutdown()
+{
+    Scheduler &s = scheduler();
+    std::vector<SimTask *> tasks;
+    {
+        std::lock_guard<std::mutex> lk(s.lock);
+        if(!s.finished)
+        {
+            finish(s);
+        }
+        tasks = s.tasks;
+    }
+    for(SimTask * task : tasks)
+    {
+        if(!task->adopted && task->thread.joinable())
+        {
+            task->thread.join();
+        }
+    }
+}
+
+} // namespace sim
+
+//----------------------------------------------------------------------------//
+//                                 PROS C API                                 //
+//----------------------------------------------------------------------------//
+
+namespace pros
+{
+namespace c
+{
+
+std::uint32_t millis(void)
+{
+    return static_cast<std::uint32_t>(sim::micros() / 1000);
+}
+
+task_t task_create(task_fn_t function, void * const parameters, std::uint32_t prio, const std::uint16_t stack_depth,
+    const char * const name)
+{
+    (void)stack_depth;
+    return sim::createTask(function, parameters, name, prio);
+}
+
+void task_delete(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    SimTask * target = (task == nullptr) ? currentTask(s) : toTask(task);
+    target->state = TaskState::DELETED;
+    target->waitingOn = nullptr;
+    if(target == self)
+    {
+        if(s.current == self)
+        {
+            dispatch(s);
+        }
+        throw TaskKilled();
+    }
+}
+
+void task_delay(const std::uint32_t milliseconds)
+{
+    sim::sleepUntil(sim::micros() + static_cast<std::uint64_t>(milliseconds) * sim::TICK_US);
+}
+
+void delay(const std::uint32_t milliseconds)
+{
+    task_delay(milliseconds);
+}
+
+void task_delay_until(std::uint32_t * const prev_time, const std::uint32_t delta)
+{
+    std::uint64_t wakeTime = (static_cast<std::uint64_t>(*prev_time) + delta) * sim::TICK_US;
+    *prev_time += delta;
+    if(wakeTime > sim::micros())
+    {
+        sim::sleepUntil(wakeTime);
+    }
+}
+
+std::uint32_t task_get_priority(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    return (task == nullptr) ? currentTask(s)->priority : toTask(task)->priority;
+}
+
+void task_set_priority(task_t task, std::uint32_t prio)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    ((task == nullptr) ? currentTask(s) : toTask(task))->priority = prio;
+}
+
+task_state_e_t task_get_state(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    SimTask * target = (task == nullptr) ? currentTask(s) : toTask(task);
+    if(target == s.current)
+    {
+        return E_TASK_STATE_RUNNING;
+    }
+    switch(target->state)
+    {
+        case TaskState::READY:
+            return E_TASK_STATE_READY;
+        case TaskState::DELAYED:
+        case TaskState::BLOCKED:
+            return E_TASK_STATE_BLOCKED;
+        case TaskState::SUSPENDED:
+            return E_TASK_STATE_SUSPENDED;
+        case TaskState::DELETED:
+            return E_TASK_STATE_DELETED;
+    }
+    return E_TASK_STATE_INVALID;
+}
+
+void task_suspend(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    SimTask * target = (task == nullptr) ? currentTask(s) : toTask(task);
+    target->state = TaskState::SUSPENDED;
+    target->wakeTime = NEVER;
+    if(target == self)
+    {
+        block(s, lk);
+    }
+}
+
+void task_resume(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    SimTask * target = toTask(task);
+    if(target->state == TaskState::SUSPENDED)
+    {
+        makeReady(s, target);
+    }
+}
+
+std::uint32_t task_get_count(void)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    std::uint32_t count = 0;
+    for(SimTask * task : s.tasks)
+    {
+        if(task->state != TaskState::DELETED)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+char * task_get_name(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    return &((task == nullptr) ? currentTask(s) : toTask(task))->name[0];
+}
+
+task_t task_get_by_name(const char * name)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    for(SimTask * task : s.tasks)
+    {
+        if(task->state != TaskState::DELETED && task->name == name)
+        {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+task_t task_get_current()
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    return currentTask(s);
+}
+
+std::uint32_t task_notify_ext(task_t task, std::uint32_t value, notify_action_e_t action, std::uint32_t * prev_value)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    SimTask * target = toTask(task);
+    if(prev_value != nullptr)
+    {
+        *prev_value = target->notifyValue;
+    }
+    switch(action)
+    {
+        case E_NOTIFY_ACTION_NONE:
+            break;
+        case E_NOTIFY_ACTION_BITS:
+            target->notifyValue |= value;
+            break;
+        case E_NOTIFY_ACTION_INCR:
+            target->notifyValue++;
+            break;
+        case E_NOTIFY_ACTION_OWRITE:
+            target->notifyValue = value;
+            break;
+        case E_NOTIFY_ACTION_NO_OWRITE:
+            if(target->notifyValue != 0)
+            {
+                return 0;
+            }
+            target->notifyValue = value;
+            break;
+    }
+    if(target->state == TaskState::BLOCKED && target->waitingForNotify)
+    {
+        target->waitingForNotify = false;
+        makeReady(s, target);
+    }
+    return 1;
+}
+
+std::uint32_t task_notify(task_t task)
+{
+    return task_notify_ext(task, 0, E_NOTIFY_ACTION_INCR, nullptr);
+}
+
+std::uint32_t task_notify_take(bool clear_on_exit, std::uint32_t timeout)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    SimTask * task = currentTask(s);
+    if(task->notifyValue == 0 && timeout != 0)
+    {
+        task->state = TaskState::BLOCKED;
+        task->waitingForNotify = true;
+        task->wakeTime = (timeout == TIMEOUT_MAX) ? NEVER : s.now + static_cast<std::uint64_t>(timeout) * TICK_US;
+        block(s, lk);
+    }
+    std::uint32_t value = task->notifyValue;
+    if(clear_on_exit)
+    {
+        task->notifyValue = 0;
+    }
+    else if(task->notifyValue > 0)
+    {
+        task->notifyValue--;
+    }
+    return value;
+}
+
+bool task_notify_clear(task_t task)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    SimTask * target = (task == nullptr) ? currentTask(s) : toTask(task);
+    bool wasPending = target->notifyValue != 0;
+    target->notifyValue = 0;
+    return wasPending;
+}
+
+mutex_t mutex_create(void)
+{
+    return new sim::SimMutex();
+}
+
+bool mutex_take(mutex_t mutex, std::uint32_t timeout)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    SimTask * task = currentTask(s);
+    SimMutex * m = static_cast<SimMutex *>(mutex);
+    if(m->owner == nullptr)
+    {
+        m->owner = task;
+        return true;
+    }
+    if(timeout == 0)
+    {
+        errno = EBUSY;
+        return false;
+    }
+    task->state = TaskState::BLOCKED;
+    task->waitingOn = m;
+    task->wakeTime = (timeout == TIMEOUT_MAX) ? NEVER : s.now + static_cast<std::uint64_t>(timeout) * TICK_US;
+    block(s, lk);
+    if(m->owner != task)
+    {
+        errno = EBUSY;
+        return false;
+    }
+    return true;
+}
+
+bool mutex_give(mutex_t mutex)
+{
+    using namespace sim;
+    Scheduler &s = scheduler();
+    std::lock_guard<std::mutex> lk(s.lock);
+    SimMutex * m = static_cast<SimMutex *>(mutex);
+    if(m->owner != currentTask(s))
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    //Hand the mutex straight to the highest priority waiter
+    SimTask * next = nullptr;
+    for(SimTask * task : s.tasks)
+    {
+        if(task->state == TaskState::BLOCKED && task->waitingOn == m &&
+            (next == nullptr || task->priority > next->priority))
+        {
+            next = task;
+        }
+    }
+    m->owner = next;
+    if(next != nullptr)
+    {
+        next->waitingOn = nullptr;
+        makeReady(s, next);
+    }
+    return true;
+}
+
+} // namespace c
+
+//----------------------------------------------------------------------------//
+//                                PROS C++ API                                //
+//----------------------------------------------------------------------------//
+
+Task::Task(task_fn_t function, void * parameters, std::uint32_t prio, std::uint16_t stack_depth, const char * name)
+{
+    task = c::task_create(function, parameters, prio, stack_depth, name);
+}
+
+Task::Task(task_t task) : task(task)
+{
+}
+
+Task Task::current()
+{
+    return Task(c::task_get_current());
+}
+
+void Task::operator=(const task_t in)
+{
+    task = in;
+}
+
+void Task::remove()
+{
+    c::task_delete(task);
+}
+
+std::uint32_t Task::get_priority(void)
+{
+    return c::task_get_priority(task);
+}
+
+void Task::set_priority(std::uint32_t prio)
+{
+    c::task_set_priority(task, prio);
+}
+
+std::uint32_t Task::get_state(void)
+{
+    return c::task_get_state(task);
+}
+
+void Task::suspend(void)
+{
+    c::task_suspend(task);
+}
+
+void Task::resume(void)
+{
+    c::task_resume(task);
+}
+
+const char * Task::get_name(void)
+{
+    return c::task_get_name(task);
+}
+
+std::uint32_t Task::notify(void)
+{
+    return c::task_notify(task);
+}
+
+std::uint32_t Task::notify_ext(std::uint32_t value, notify_action_e_t action, std::uint32_t * prev_value)
+{
+    return c::task_notify_ext(task, value, action, prev_value);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout)
+{
+    return c::task_notify_take(clear_on_exit, timeout);
+}
+
+bool Task::notify_clear(void)
+{
+    return c::task_notify_clear(task);
+}
+
+void Task::delay(const std::uint32_t milliseconds)
+{
+    c::task_delay(milliseconds);
+}
+
+void Task::delay_until(std::uint32_t * const prev_time, const std::uint32_t delta)
+{
+    c::task_delay_until(prev_time, delta);
+}
+
+std::uint32_t Task::get_count(void)
+{
+    return c::task_get_count();
+}
+
+Mutex::Mutex(void) : mutex(c::mutex_create())
+{
+}
+
+bool Mutex::take(std::uint32_t timeout)
+{
+    return c::mutex_take(mutex, timeout);
+}
+
+bool Mutex::give(void)
+{
+    return c::mutex_give(mutex);
+}
+
+} // namespace pros
@@ -0,0 +1,86 @@
+#include "simTimeUtil.hpp"
+#include "sim.hpp"
+#include <cmath>
+
+namespace sim
+{
+namespace
+{
+    const okapi::QTime MICROSECOND = okapi::millisecond / 1000;
+} // namespace
+
+//----------------------------------------------------------------------------//
+//                                   Timer                                    //
+//----------------------------------------------------------------------------//
+
+SimTimer::SimTimer() : okapi::AbstractTimer(static_cast<double>(micros()) * MICROSECOND)
+{
+}
+
+okapi::QTime SimTimer::millis() const
+{
+    return static_cast<double>(micros()) * MICROSECOND;
+}
+
+//----------------------------------------------------------------------------//
+//                                    Rate                                    //
+//----------------------------------------------------------------------------//
+
+SimRate::SimRate() = default;
+
+void SimRate::delay(okapi::QFrequency ihz)
+{
+    delayPeriod(static_cast<std::uint64_t>(std::llround(1e6 / ihz.convert(okapi::Hz))));
+}
+
+void SimRate::delay(int ihz)
+{
+    delayPeriod(static_cast<std::uint64_t>(std::llround(1e6 / ihz)));
+}
+
+void SimRate::delayUntil(okapi::QTime itime)
+{
+    delayPeriod(static_cast<std::uint64_t>(std::llround(itime.convert(MICROSECOND))));
+}
+
+void SimRate::delayUntil(std::uint32_t ims)
+{
+    delayPeriod(static_cast<std::uint64_t>(ims) * 1000);
+}
+
+void SimRate::delayPeriod(std::uint64_t periodUs)
+{
+    if(lastTime == 0)
+    {
+        lastTime = micros();
+    }
+    lastTime += periodUs;
+    //Like task_delay_until, don't sleep if the loop overran its period
+    if(lastTime > micros())
+    {
+        sleepUntil(lastTime);
+    }
+}
+
+//----------------------------------------------------------------------------//
+//                                  Factory                                   //
+//----------------------------------------------------------------------------//
+
+okapi::TimeUtil SimTimeUtilFactory::create()
+{
+    return withSettledUtilParams();
+}
+
+okapi::TimeUtil SimTimeUtilFactory::withSettledUtilParams(double iatTargetError, double iatTargetDerivative,
+    okapi::QTime iatTargetTime)
+{
+    return okapi::TimeUtil(
+        okapi::Supplier<std::unique_ptr<okapi::AbstractTimer>>([]() { return std::make_unique<SimTimer>(); }),
+        okapi::Supplier<std::unique_ptr<okapi::AbstractRate>>([]() { return std::make_unique<SimRate>(); }),
+        okapi::Supplier<std::unique_ptr<okapi::SettledUtil>>([=]() {
+            return std::make_unique<okapi::SettledUtil>(std::make_unique<SimTimer>(), iatTargetError,
+                iatTargetDerivative, iatTargetTime);
+        }));
+}
+
+} // namespace sim
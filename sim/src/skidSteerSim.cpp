@@ -0,0 +1,400 @@
+#include "skidSteerSim.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim
+{
+namespace
+{
+    const double GRAVITY = 9.81;
+    const double RAD_PER_S_TO_RPM = 60.0 / (2.0 * M_PI);
+
+    double clamp(double value, double limit)
+    {
+        return std::max(-limit, std::min(limit, value));
+    }
+} // namespace
+
+//----------------------------------------------------------------------------//
+//                                  Physics                                   //
+//----------------------------------------------------------------------------//
+
+SkidSteerBatch::SkidSteerBatch(std::size_t size, const SkidSteerParams &params)
+    : leftAngle(size), rightAngle(size), leftOmega(size), rightOmega(size), leftCurrent(size),
+      rightCurrent(size), leftSlip(size), rightSlip(size), velocity(size), yawRate(size), x(size), y(size),
+      theta(size), leftGrip(size, 1.0), rightGrip(size, 1.0), params(params), motor(getMotorConstants(params.gearset)), leftCommand(size),
+      rightCommand(size), leftMode(size, COAST), rightMode(size, COAST), leftIntegral(size), rightIntegral(size)
+{
+}
+
+std::size_t SkidSteerBatch::size() const
+{
+    return x.size();
+}
+
+const SkidSteerParams &SkidSteerBatch::getParams() const
+{
+    return params;
+}
+
+void SkidSteerBatch::setVoltage(std::size_t index, double left, double right)
+{
+    leftMode[index] = VOLTAGE;
+    rightMode[index] = VOLTAGE;
+    leftCommand[index] = left;
+    rightCommand[index] = right;
+}
+
+void SkidSteerBatch::setVelocity(std::size_t index, double left, double right)
+{
+    setLeftVelocity(index, left);
+    setRightVelocity(index, right);
+}
+
+void SkidSteerBatch::setLeftVelocity(std::size_t index, double left)
+{
+    //The firmware resets its integrator when the control mode changes
+    if(leftMode[index] != VELOCITY)
+    {
+        leftIntegral[index] = 0;
+    }
+    leftMode[index] = (left == 0) ? COAST : VELOCITY;
+    leftCommand[index] = left;
+}
+
+void SkidSteerBatch::setRightVelocity(std::size_t index, double right)
+{
+    if(rightMode[index] != VELOCITY)
+    {
+        rightIntegral[index] = 0;
+    }
+    rightMode[index] = (right == 0) ? COAST : VELOCITY;
+    rightCommand[index] = right;
+}
+
+void SkidSteerBatch::coast(std::size_t index, bool left, bool right)
+{
+    if(left)
+    {
+        leftMode[index] = COAST;
+    }
+    if(right)
+    {
+        rightMode[index] = COAST;
+    }
+}
+
+void SkidSteerBatch::reset(std::size_t index)
+{
+    leftAngle[index] = rightAngle[index] = 0;
+    leftOmega[index] = rightOmega[index] = 0;
+    leftCurrent[index] = rightCurrent[index] = 0;
+    leftSlip[index] = rightSlip[index] = 0;
+    velocity[index] = yawRate[index] = 0;
+    x[index] = y[index] = theta[index] = 0;
+    leftIntegral[index] = rightIntegral[index] = 0;
+    coast(index);
+}
+
+void SkidSteerBatch::step(double dt)
+{
+    const int n = params.motorsPerSide;
+    const double radius = params.wheelDiameter / 2.0;
+    const double halfTrack = params.trackWidth / 2.0;
+    const double freeRPM = motor.freeSpeed * RAD_PER_S_TO_RPM;
+
+    //Same rotor inertia and gearbox friction as the single-motor plant
+    const double wheelInertia = n * 0.05 * motor.kT * motor.kE / motor.resistance;
+    const double frictionTorque = n * params.friction * motor.stallTorque;
+
+    const double maxForce = params.traction * params.mass * GRAVITY / 2.0;
+    const double forcePerSlip = maxForce / params.slipVelocity;
+    const double maxScrub = params.scrub * params.traction * params.mass * GRAVITY * halfTrack;
+
+    //Applied voltage for one side: the firmware velocity loop of motors.cpp,
+    //a raw voltage, or the back-EMF of a coasting motor (so it draws no
+    //current)
+    auto sideVoltage = [&](std::uint8_t mode, double command, double omega, double &integral) {
+        if(mode == VELOCITY)
+        {
+            double error = command - omega * RAD_PER_S_TO_RPM;
+            integral = clamp(integral + 12.0 / freeRPM * 10.0 * error * dt, 6.0);
+            return clamp(command / freeRPM * 12.0 + 12.0 / freeRPM * 1.5 * error + integral, 12.0);
+        }
+        return (mode == VOLTAGE) ? clamp(command, 12.0) : motor.kE * omega;
+    };
+
+    //Steps one side's wheels against the ground, returning the traction
+    //force they push the robot with
+    auto stepSide = [&](double voltage, double groundSpeed, double grip, double &omega, double &angle,
+                        double &current, double &slip) {
+        current = clamp((voltage - motor.kE * omega) / motor.resistance, params.currentLimit);
+        slip = omega * radius - groundSpeed;
+        double force = grip * clamp(forcePerSlip * slip, maxForce);
+        double friction = frictionTorque * clamp(omega, 1.0);
+        omega += (n * motor.kT * current - friction - force * radius) / wheelInertia * dt;
+        angle += omega * dt;
+        return force;
+    };
+
+    const std::size_t count = size();
+    for(std::size_t i = 0; i < count; i++)
+    {
+        double leftVoltage = sideVoltage(leftMode[i], leftCommand[i], leftOmega[i], leftIntegral[i]);
+        double rightVoltage = sideVoltage(rightMode[i], rightCommand[i], rightOmega[i], rightIntegral[i]);
+
+        double leftForce = stepSide(leftVoltage, velocity[i] - yawRate[i] * halfTrack, leftGrip[i], leftOmega[i],
+            leftAngle[i], leftCurrent[i], leftSlip[i]);
+        double rightForce = stepSide(rightVoltage, velocity[i] + yawRate[i] * halfTrack, rightGrip[i],
+            rightOmega[i], rightAngle[i], rightCurrent[i], rightSlip[i]);
+
+        double scrubTorque = maxScrub * clamp(yawRate[i] / 0.2, 1.0);
+        velocity[i] += (leftForce + rightForce) / params.mass * dt;
+        yawRate[i] += ((rightForce - leftForce) * halfTrack - scrubTorque) / params.momentOfInertia * dt;
+
+        x[i] += velocity[i] * std::cos(theta[i]) * dt;
+        y[i] += velocity[i] * std::sin(theta[i]) * dt;
+        theta[i] += yawRate[i] * dt;
+    }
+}
+
+//----------------------------------------------------------------------------//
+//                                Chassis Model                               //
+//----------------------------------------------------------------------------//
+
+SimSkidSteerModel::SimSkidSteerModel(const std::shared_ptr<SkidSteerBatch> &batch, std::size_t index,
+    double maxVelocity, double maxVoltage)
+    : okapi::ChassisModel(maxVelocity, maxVoltage), batch(batch), index(index)
+{
+}
+
+void SimSkidSteerModel::velocity(double leftSpeed, double rightSpeed) const
+{
+    //okapi truncates velocities to whole RPM
+    batch->setVelocity(index, static_cast<std::int16_t>(leftSpeed * maxVelocity),
+        static_cast<std::int16_t>(rightSpeed * maxVelocity));
+}
+
+void SimSkidSteerModel::voltage(double leftSpeed, double rightSpeed) const
+{
+    //okapi truncates voltages to whole millivolts, and 0 mV coasts
+    std::int16_t left = static_cast<std::int16_t>(leftSpeed * maxVoltage);
+    std::int16_t right = static_cast<std::int16_t>(rightSpeed * maxVoltage);
+    batch->setVoltage(index, left / 1000.0, right / 1000.0);
+    batch->coast(index, left == 0, right == 0);
+}
+
+void SimSkidSteerModel::forward(double ispeed) const
+{
+    double speed = std::clamp(ispeed, -1.0, 1.0);
+    velocity(speed, speed);
+}
+
+void SimSkidSteerModel::driveVector(double iforwardSpeed, double iyaw) const
+{
+    double forwardSpeed = std::clamp(iforwardSpeed, -1.0, 1.0);
+    double yaw = std::clamp(iyaw, -1.0, 1.0);
+
+    double leftOutput = forwardSpeed + yaw;
+    double rightOutput = forwardSpeed - yaw;
+    double maxInputMag = std::max(std::abs(leftOutput), std::abs(rightOutput));
+    if(maxInputMag > 1)
+    {
+        leftOutput /= maxInputMag;
+        rightOutput /= maxInputMag;
+    }
+
+    velocity(leftOutput, rightOutput);
+}
+
+void SimSkidSteerModel::rotate(double ispeed) const
+{
+    double speed = std::clamp(ispeed, -1.0, 1.0);
+    velocity(speed, -speed);
+}
+
+void SimSkidSteerModel::stop()
+{
+    velocity(0, 0);
+}
+
+void SimSkidSteerModel::tank(double ileftSpeed, double irightSpeed, double ithreshold) const
+{
+    double leftSpeed = std::clamp(ileftSpeed, -1.0, 1.0);
+    if(std::abs(leftSpeed) < ithreshold)
+    {
+        leftSpeed = 0;
+    }
+    double rightSpeed = std::clamp(irightSpeed, -1.0, 1.0);
+    if(std::abs(rightSpeed) < ithreshold)
+    {
+        rightSpeed = 0;
+    }
+
+    voltage(leftSpeed, rightSpeed);
+}
+
+void SimSkidSteerModel::arcade(double iforwardSpeed, double iyaw, double ithreshold) const
+{
+    double forwardSpeed = std::clamp(iforwardSpeed, -1.0, 1.0);
+    if(std::abs(forwardSpeed) <= ithreshold)
+    {
+        forwardSpeed = 0;
+    }
+    double yaw = std::clamp(iyaw, -1.0, 1.0);
+    if(std::abs(yaw) <= ithreshold)
+    {
+        yaw = 0;
+    }
+
+    //Same quadrant mixing as okapi::SkidSteerModel::arcade
+    double maxInput = std::copysign(std::max(std::abs(forwardSpeed), std::abs(yaw)), forwardSpeed);
+    double leftOutput;
+    double rightOutput;
+    if(forwardSpeed >= 0)
+    {
+        if(yaw >= 0)
+        {
+            leftOutput = maxInput;
+            rightOutput = forwardSpeed - yaw;
+        }
+        else
+        {
+            leftOutput = forwardSpeed + yaw;
+            rightOutput = maxInput;
+        }
+    }
+    else
+    {
+        if(yaw >= 0)
+        {
+            leftOutput = forwardSpeed + yaw;
+            rightOutput = maxInput;
+        }
+        else
+        {
+            leftOutput = maxInput;
+            rightOutput = forwardSpeed - yaw;
+        }
+    }
+
+    voltage(std::clamp(leftOutput, -1.0, 1.0), std::clamp(rightOutput, -1.0, 1.0));
+}
+
+void SimSkidSteerModel::left(double ispeed) const
+{
+    batch->setLeftVelocity(index, static_cast<std::int16_t>(std::clamp(ispeed, -1.0, 1.0) * maxVelocity));
+}
+
+void SimSkidSteerModel::right(double ispeed) const
+{
+    batch->setRightVelocity(index, static_cast<std::int16_t>(std::clamp(ispeed, -1.0, 1.0) * maxVelocity));
+}
+
+std::valarray<std::int32_t> SimSkidSteerModel::getSensorVals() const
+{
+    double toDegrees = 180.0 / M_PI;
+    return std::valarray<std::int32_t>{static_cast<std::int32_t>((batch->leftAngle[index] - leftZero) * toDegrees),
+        static_cast<std::int32_t>((batch->rightAngle[index] - rightZero) * toDegrees)};
+}
+
+void SimSkidSteerModel::resetSensors() const
+{
+    leftZero = batch->leftAngle[index];
+    rightZero = batch->rightAngle[index];
+}
+
+void SimSkidSteerModel::setBrakeMode(okapi::AbstractMotor::brakeMode mode) const
+{
+}
+
+void SimSkidSteerModel::setEncoderUnits(okapi::AbstractMotor::encoderUnits units) const
+{
+}
+
+void SimSkidSteerModel::setGearing(okapi::AbstractMotor::gearset gearset) const
+{
+}
+
+void SimSkidSteerModel::setPosPID(double ikF, double ikP, double ikI, double ikD) const
+{
+}
+
+void SimSkidSteerModel::setPosPIDFull(double ikF, double ikP, double ikI, double ikD, double ifilter,
+    double ilimit, double ithreshold, double iloopSpeed) const
+{
+}
+
+void SimSkidSteerModel::setVelPID(double ikF, double ikP, double ikI, double ikD) const
+{
+}
+
+void SimSkidSteerModel::setVelPIDFull(double ikF, double ikP, double ikI, double ikD, double ifilter,
+    double ilimit, double ithreshold, double iloopSpeed) const
+{
+}
+
+//----------------------------------------------------------------------------//
+//                                 Pose Source                                //
+//----------------------------------------------------------------------------//
+
+SkidSteerPoseSource::SkidSteerPoseSource(const std::shared_ptr<SkidSteerBatch> &batch, std::size_t index)
+    : batch(batch), index(index)
+{
+}
+
+Pose SkidSteerPoseSource::getPose()
+{
+    return Pose{batch->x[index], batch->y[index], batch->theta[index]};
+}
+
+//----------------------------------------------------------------------------//
+//                                 Motor Plant                                //
+//----------------------------------------------------------------------------//
+
+SkidSteerPlant::SkidSteerPlant(const std::shared_ptr<SkidSteerBatch> &batch,
+    std::initializer_list<std::int8_t> leftPorts, std::initializer_list<std::int8_t> rightPorts)
+    : batch(batch), leftPorts(leftPorts), rightPorts(rightPorts)
+{
+}
+
+double SkidSteerPlant::sideVoltage(const std::vector<std::int8_t> &ports, double omega) const
+{
+    MotorConstants motor = getMotorConstants(batch->getParams().gearset);
+    double total = 0;
+    for(std::int8_t port : ports)
+    {
+        std::uint8_t physicalPort = static_cast<std::uint8_t>(std::abs(port));
+        if(isMotorCoasting(physicalPort))
+        {
+            total += motor.kE * omega;
+        }
+        else
+        {
+            total += (port < 0) ? -getMotorVoltage(physicalPort) : getMotorVoltage(physicalPort);
+        }
+    }
+    return ports.empty() ? 0 : total / ports.size();
+}
+
+void SkidSteerPlant::reportSide(const std::vector<std::int8_t> &ports, double angle, double omega,
+    double current) const
+{
+    MotorConstants motor = getMotorConstants(batch->getParams().gearset);
+    for(std::int8_t port : ports)
+    {
+        double sign = (port < 0) ? -1.0 : 1.0;
+        setMotorState(static_cast<std::uint8_t>(std::abs(port)), sign * angle * 180.0 / M_PI,
+            sign * omega * RAD_PER_S_TO_RPM, sign * current, sign * motor.kT * current);
+    }
+}
+
+void SkidSteerPlant::step(double dt)
+{
+    batch->setVoltage(0, sideVoltage(leftPorts, batch->leftOmega[0]), sideVoltage(rightPorts, batch->rightOmega[0]));
+    batch->step(dt);
+    reportSide(leftPorts, batch->leftAngle[0], batch->leftOmega[0], batch->leftCurrent[0]);
+    reportSide(rightPorts, batch->rightAngle[0], batch->rightOmega[0], batch->rightCurrent[0]);
+}
+
+} // namespace sim
@@ -0,0 +1,185 @@
+#include "main.h"
+#include "pathController.hpp"
+#include "sim.hpp"
+#include "splineArcLength.hpp"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+/**
+ * Compares Pathfinder's fixed-sample spline arc length with the adaptive
+ * integrator in splineArcLength.hpp: the error and time per spline for
+ * splines from straight to sharply curved, then the time to generate whole
+ * paths each way and how far apart the paths land.
+ *
+ * Usage: arcLengthBenchmark
+ */
+
+namespace
+{
+    //Each timing repeats until it has run this long
+    const double MIN_SECONDS = 0.2;
+    const double WHEELBASE_WIDTH = 12.5 * 0.0254;
+
+    struct SplineCase
+    {
+        const char * name;
+        Waypoint from;
+        Waypoint to;
+    };
+
+    //Waypoints in m and radians; the difference in heading sets how sharply
+    //the spline bends
+    const SplineCase SPLINES[] = {
+        {"straight 1 m", {0, 0, 0}, {1, 0, 0}},
+        {"10 deg bend", {0, 0, 0}, {0.9, 0.1, 10 * M_PI / 180}},
+        {"30 deg S", {0, 0, 0}, {0.8, -0.5, 0}},
+        {"45 deg arc", {0, 0, 0}, {0.6, 0.6, 45 * M_PI / 180}},
+        {"80 deg turn", {0, 0, 0}, {0.3, 0.6, 80 * M_PI / 180}},
+    };
+
+    struct PathCase
+    {
+        const char * name;
+        std::vector<Waypoint> waypoints;
+    };
+
+    double nowSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * times a function, repeating it until the timing is meaningful
+     * @return seconds per call
+     */
+    template <typename Function>
+    double timePerCall(Function function)
+    {
+        int calls = 0;
+        double start = nowSeconds();
+        double elapsed = 0;
+        do
+        {
+            function();
+            calls++;
+            elapsed = nowSeconds() - start;
+        } while(elapsed < MIN_SECONDS);
+        return elapsed / calls;
+    }
+
+    void benchmarkSpline(const SplineCase &spline)
+    {
+        Spline fitted;
+        pf_fit_hermite_cubic(spline.from, spline.to, &fitted);
+        const double reference = splineArcLength(fitted, 0, 1, 1e-13);
+        std::printf("%s: %.9f m\n", spline.name, reference);
+
+        const int SAMPLES[] = {PATHFINDER_SAMPLES_FAST, PATHFINDER_SAMPLES_LOW, PATHFINDER_SAMPLES_HIGH};
+        const char * SAMPLE_NAMES[] = {"FAST", "LOW", "HIGH"};
+        for(int i = 0; i < 3; i++)
+        {
+            Spline copy = fitted;
+            double length = pf_spline_distance(&copy, SAMPLES[i]);
+            double seconds = timePerCall([&] { pf_spline_distance(&copy, SAMPLES[i]); });
+            std::printf("  pf_spline_distance %-4s         error %9.2e m  %10.2f us\n", SAMPLE_NAMES[i],
+                std::abs(length - reference), seconds * 1e6);
+        }
+
+        for(double tolerance : {1e-3, 1e-6, 1e-9})
+        {
+            Spline copy = fitted;
+            double length = splineDistance(copy, tolerance);
+            double seconds = timePerCall([&] { splineDistance(copy, tolerance); });
+            std::printf("  splineDistance tolerance %5.0e  error %9.2e m  %10.2f us\n", tolerance,
+                std::abs(length - reference), seconds * 1e6);
+        }
+    }
+
+    /**
+     * generates a path the way PathController did before it measured splines
+     * itself
+     */
+    PathController::SegmentPair generateWithPathfinder(std::vector<Waypoint> waypoints, double dt)
+    {
+        TrajectoryCandidate candidate;
+        pathfinder_prepare(waypoints.data(), static_cast<int>(waypoints.size()), FIT_HERMITE_CUBIC,
+            PATHFINDER_SAMPLES_FAST, dt, 1.0, 2.0, 10.0, &candidate);
+        const int length = candidate.length;
+        std::vector<Segment> trajectory(length);
+        PathController::SegmentPair segments{std::vector<Segment>(length), std::vector<Segment>(length)};
+        pathfinder_generate(&candidate, trajectory.data());
+        pathfinder_modify_tank(trajectory.data(), length, segments.left.data(), segments.right.data(),
+            WHEELBASE_WIDTH);
+        return segments;
+    }
+
+    /**
+     * @return largest distance between matching left wheel segments
+     */
+    double maxDifference(const PathController::SegmentPair &a, const PathController::SegmentPair &b)
+    {
+        double difference = 0;
+        for(std::size_t i = 0; i < a.left.size() && i < b.left.size(); i++)
+        {
+            difference = std::max(difference, std::hypot(a.left[i].x - b.left[i].x, a.left[i].y - b.left[i].y));
+        }
+        return difference;
+    }
+
+    void benchmarkPath(const PathCase &path)
+    {
+        //Pathfinder's profile, so only the arc length differs
+        auto reference = PathController::generateSegments(path.waypoints, 1.0, 2.0, 10.0, WHEELBASE_WIDTH, 1e-10,
+            PathProfile::center);
+        std::printf("%s: %zu segments\n", path.name, reference.left.size());
+
+        auto pathfinder = generateWithPathfinder(path.waypoints, 0.010);
+        double seconds = timePerCall([&] { generateWithPathfinder(path.waypoints, 0.010); });
+        std::printf("  Pathfinder FAST                 max difference %9.2e m  %10.2f us\n",
+            maxDifference(pathfinder, reference), seconds * 1e6);
+
+        for(double tolerance : {1e-3, 1e-6, 1e-9})
+        {
+            auto adaptive = PathController::generateSegments(path.waypoints, 1.0, 2.0, 10.0, WHEELBASE_WIDTH,
+                tolerance, PathProfile::center);
+            seconds = timePerCall([&] {
+                PathController::generateSegments(path.waypoints, 1.0, 2.0, 10.0, WHEELBASE_WIDTH, tolerance,
+                    PathProfile::center);
+            });
+            std::printf("  adaptive tolerance %5.0e        max difference %9.2e m  %10.2f us\n", tolerance,
+                maxDifference(adaptive, reference), seconds * 1e6);
+        }
+    }
+} // namespace
+
+int main(int argc, char ** argv)
+{
+    std::printf("Arc length per spline, against a 1e-13 m reference\n");
+    for(const SplineCase &spline : SPLINES)
+    {
+        benchmarkSpline(spline);
+    }
+
+    //Shaped like the autonomous paths, plus one with several waypoints
+    const double IN = 0.0254;
+    const double DEG = M_PI / 180;
+    const PathCase PATHS[] = {
+        {"toNearFlags", {{0, 0, 0}, {36 * IN, 0, 0}}},
+        {"toCap", {{0, 0, 0}, {30 * IN, -20 * IN, -30 * DEG}}},
+        {"S curve, 4 waypoints", {{0, 0, 0}, {24 * IN, 12 * IN, 30 * DEG}, {48 * IN, 12 * IN, -30 * DEG},
+            {72 * IN, 0, 0}}},
+    };
+
+    std::printf("\nWhole path generation, against a 1e-10 m reference\n");
+    for(const PathCase &path : PATHS)
+    {
+        benchmarkPath(path);
+    }
+
+    //The robot program's okapi threads started at static initialization;
+    //ending the (empty) simulation lets them wind down so they can be joined
+    sim::run(0);
+    sim::shutdown();
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "main.h"
+#include "sim.hpp"
+#include "skidSteerSim.hpp"
+#include "subsystems.hpp"
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+/**
+ * Sweeps drivetrain tuning parameters over a batch of simulated robots.
+ *
+ * Every robot runs the same driver input or autonomous move with its own
+ * parameters, one robot per grid point, and the batch is stepped together.
+ *
+ * Usage: drivetrainSweep [slew|pid]
+ *  slew  slewRate_y x slewRate_r against a scripted opcontrol drive
+ *  pid   distance kP x kD against a 24 in ChassisControllerPID-style move
+ */
+
+namespace
+{
+    //Physics runs at 1 kHz, the robot's loops at 1 / REFRESH_MS
+    const double DT = 0.001;
+    const int STEPS_PER_LOOP = static_cast<int>(REFRESH_MS);
+
+    double nowSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * prints how fast the batch was stepped
+     */
+    void printThroughput(std::size_t robots, long steps, double wallSeconds)
+    {
+        std::printf("%zu robots x %ld steps in %.3f s: %.2f million robot-steps/s\n\n", robots, steps,
+            wallSeconds, robots * steps / wallSeconds / 1e6);
+    }
+} // namespace
+
+//----------------------------------------------------------------------------//
+//                                 Slew Sweep                                 //
+//----------------------------------------------------------------------------//
+
+/**
+ * runs opcontrol's stick shaping and slew control against a scripted drive:
+ * full forward, a hard arc, a spin and a full reverse
+ */
+void sweepSlew()
+{
+    const std::vector<double> rates = {1, 2, 3, 5, 7, 10, 15, 20, 30, 127};
+    const std::size_t count = rates.size() * rates.size();
+    auto batch = std::make_shared<sim::SkidSteerBatch>(count);
+    const double slipVelocity = batch->getParams().slipVelocity;
+
+    std::vector<std::unique_ptr<sim::SimSkidSteerModel>> models;
+    std::vector<double> yLast(count), rLast(count);
+    std::vector<double> timeTo90(count, -1), peakSlip(count), slipTime(count);
+    for(std::size_t i = 0; i < count; i++)
+    {
+        models.push_back(std::make_unique<sim::SimSkidSteerModel>(batch, i));
+    }
+
+    //Top speed: free speed at the wheel surface
+    double topSpeed = sim::getMotorConstants(batch->getParams().gearset).freeSpeed *
+        batch->getParams().wheelDiameter / 2.0;
+
+    double wallStart = nowSeconds();
+    long steps = 0;
+    for(int loop = 0; loop < 500; loop++)
+    {
+        double t = loop * REFRESH_MS / 1000.0;
+
+        //Stick positions, as the driver script in sim/src/main.cpp
+        int leftY = (t < 1.5) ? 127 : (t < 2.5) ? 0 : (t < 3.5) ? -127 : 0;
+        int rightX = (t >= 1.0 && t < 1.5) ? 127 : 0;
+        int leftX = (t >= 1.5 && t < 2.5) ? 127 : 0;
+
+        int y = LinearCurve::at(leftY);
+        int r = LinearCurve::at(leftX) + SensitiveCurve::at(rightX);
+
+        for(std::size_t i = 0; i < count; i++)
+        {
+            yLast[i] = slewLimit(y, yLast[i], rates[i / rates.size()]);
+            rLast[i] = slewLimit(r, rLast[i], rates[i % rates.size()]);
+            models[i]->arcade(yLast[i] / 127.0, rLast[i] / 127.0);
+        }
+
+        for(int s = 0; s < STEPS_PER_LOOP; s++)
+        {
+            batch->step(DT);
+            steps++;
+            for(std::size_t i = 0; i < count; i++)
+            {
+                double slip = std::max(std::abs(batch->leftSlip[i]), std::abs(batch->rightSlip[i]));
+                peakSlip[i] = std::max(peakSlip[i], slip);
+                slipTime[i] += (slip > slipVelocity) ? DT : 0;
+                if(timeTo90[i] < 0 && batch->velocity[i] > 0.9 * topSpeed)
+                {
+                    timeTo90[i] = t + s * DT;
+                }
+            }
+        }
+    }
+    double wallSeconds = nowSeconds() - wallStart;
+
+    std::printf("slew_y slew_r  to 90%% (s)  peak slip (m/s)  slipping (s)  final heading (deg)\n");
+    for(std::size_t i = 0; i < count; i++)
+    {
+        std::printf("%6.0f %6.0f  %10.3f  %15.3f  %12.3f  %18.1f\n", rates[i / rates.size()],
+            rates[i % rates.size()], timeTo90[i], peakSlip[i], slipTime[i], batch->theta[i] * 180.0 / M_PI);
+    }
+    printThroughput(count, steps, wallSeconds);
+}
+
+//----------------------------------------------------------------------------//
+//                                 PID Sweep                                  //
+//----------------------------------------------------------------------------//
+
+namespace
+{
+    /**
+     * IterativePosPIDController's discrete form at a 10 ms sample time, with
+     * its default output and integral limits of [-1, 1]
+     */
+    struct Pid
+    {
+        double kP;
+        double kI;
+        double kD;
+        double integral = 0;
+        double lastReading = 0;
+
+        Pid(double kP, double kI, double kD)
+            : kP(kP), kI(kI * REFRESH_MS / 1000.0), kD(kD / (REFRESH_MS / 1000.0))
+        {
+        }
+
+        double step(double error, double reading)
+        {
+            integral = std::max(-1.0, std::min(1.0, integral + kI * error));
+            double derivative = reading - lastReading;
+            lastReading = reading;
+            return std::max(-1.0, std::min(1.0, kP * error + integral - kD * derivative));
+        }
+    };
+} // namespace
+
+/**
+ * drives every robot 24 in with ChassisControllerPID's distance and angle
+ * loops, sweeping the distance gains; the angle gains are the drivetrain's
+ */
+void sweepPid()
+{
+    const std::vector<double> kPs = {0.0005, 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5};
+    const std::vector<double> kDs = {0, 0.00001, 0.00002, 0.00005, 0.0001, 0.0002};
+    const std::size_t count = kPs.size() * kDs.size();
+    auto batch = std::make_shared<sim::SkidSteerBatch>(count);
+
+    //Encoder degrees for 24 in of travel
+    double target = 0.6096 / (M_PI * batch->getParams().wheelDiameter) * 360.0;
+
+    std::vector<std::unique_ptr<sim::SimSkidSteerModel>> models;
+    std::vector<Pid> distancePid, anglePid;
+    std::vector<double> settledAt(count, -1), overshoot(count), settledFor(count);
+    for(std::size_t i = 0; i < count; i++)
+    {
+        models.push_back(std::make_unique<sim::SimSkidSteerModel>(batch, i));
+        distancePid.emplace_back(kPs[i / kDs.size()], 0, kDs[i % kDs.size()]);
+        anglePid.emplace_back(0.1, 0.05, 0);
+    }
+
+    double wallStart = nowSeconds();
+    long steps = 0;
+    for(int loop = 0; loop < 500; loop++)
+    {
+        double t = loop * REFRESH_MS / 1000.0;
+        for(std::size_t i = 0; i < count; i++)
+        {
+            std::valarray<std::int32_t> sensors = models[i]->getSensorVals();
+            double distance = (sensors[0] + sensors[1]) / 2.0;
+            double error = target - distance;
+            overshoot[i] = std::max(overshoot[i], -error);
+
+            //SettledUtil's defaults: within 50 deg, moving under 5 deg per
+            //loop, for 250 ms
+            bool inBounds = std::abs(error) < 50 && std::abs(distance - distancePid[i].lastReading) < 5;
+            settledFor[i] = inBounds ? settledFor[i] + REFRESH_MS / 1000.0 : 0;
+            if(settledAt[i] < 0 && settledFor[i] >= 0.25)
+            {
+                settledAt[i] = t;
+            }
+
+            double distanceOutput = distancePid[i].step(error, distance);
+            double angleOutput = anglePid[i].step(-(sensors[0] - sensors[1]), sensors[0] - sensors[1]);
+            models[i]->driveVector(distanceOutput, angleOutput);
+        }
+
+        for(int s = 0; s < STEPS_PER_LOOP; s++)
+        {
+            batch->step(DT);
+            steps++;
+        }
+    }
+    double wallSeconds = nowSeconds() - wallStart;
+
+    std::printf("     kP        kD  settled (s)  overshoot (deg)  final error (in)\n");
+    for(std::size_t i = 0; i < count; i++)
+    {
+        std::valarray<std::int32_t> sensors = models[i]->getSensorVals();
+        double error = target - (sensors[0] + sensors[1]) / 2.0;
+        std::printf("%7.4f  %8.5f  %11.2f  %15.1f  %16.2f\n", kPs[i / kDs.size()], kDs[i % kDs.size()],
+            settledAt[i], overshoot[i], error / 360.0 * M_PI * batch->getParams().wheelDiameter / 0.0254);
+    }
+    printThroughput(count, steps, wallSeconds);
+}
+
+int main(int argc, char ** argv)
+{
+    bool slew = argc < 2 || std::strcmp(argv[1], "slew") == 0;
+    bool pid = argc < 2 || std::strcmp(argv[1], "pid") == 0;
+    if(!slew && !pid)
+    {
+        std::fprintf(stderr, "usage: %s [slew|pid]\n", argv[0]);
+        return 1;
+    }
+
+    if(slew)
+    {
+        sweepSlew();
+    }
+    if(pid)
+    {
+        sweepPid();
+    }
+
+    //The robot program's okapi threads started at static initialization;
+    //ending the (empty) simulation lets them wind down so they can be joined
+    sim::run(0);
+    sim::shutdown();
+    return 0;
+}
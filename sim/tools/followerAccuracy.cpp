@@ -0,0 +1,151 @@
+#include "main.h"
+#include "pathController.hpp"
+#include "sim.hpp"
+#include "simTimeUtil.hpp"
+#include "skidSteerSim.hpp"
+#include <cmath>
+#include <vector>
+
+/**
+ * Follows a path on the drivetrain physics open loop and closed loop, with
+ * and without injected wheel slip, and reports how far from the end of the
+ * path the robot stops.
+ *
+ * Usage: followerAccuracy
+ */
+
+namespace
+{
+    const double IN = 0.0254;
+    const double DEG = M_PI / 180;
+    const double WHEELBASE_WIDTH = 12.5 * IN;
+
+    //Shaped like the toCap autonomous path
+    const std::vector<Waypoint> WAYPOINTS = {{0, 0, 0}, {30 * IN, -20 * IN, -30 * DEG}};
+
+    struct Scenario
+    {
+        const char * name;
+        double leftGrip;
+        double rightGrip;
+        //Heading knocked off partway through the path, as by a collision
+        double bump;
+    };
+
+    const Scenario SCENARIOS[] = {
+        {"no slip", 1, 1, 0},
+        {"left side slipping", 0.2, 1, 0},
+        {"bumped 10 deg", 1, 1, 10 * DEG},
+    };
+
+    enum class Follower
+    {
+        openLoop,
+        encoders,
+        truePose
+    };
+
+    const char * followerName(Follower follower)
+    {
+        switch(follower)
+        {
+            case Follower::openLoop:
+                return "open loop";
+            case Follower::encoders:
+                return "RAMSETE, encoder odometry";
+            default:
+                return "RAMSETE, true pose";
+        }
+    }
+
+    std::shared_ptr<sim::SkidSteerBatch> batch;
+    std::shared_ptr<sim::SimSkidSteerModel> model;
+    PathController * controller;
+    //Virtual time at which to knock the heading off, and by how much
+    std::uint64_t bumpTime = 0;
+    double bumpAngle = 0;
+} // namespace
+
+/**
+ * follows the path at each speed under each scenario with each follower
+ * @param param unused null parameter
+ */
+void accuracyTask(void * param)
+{
+    //Settings take the controller's locks, so they are set from a task
+    controller->setCacheDirectory("");
+
+    for(double maxVel : {0.6, 0.9})
+    {
+        auto trajectory = PathController::generateTrajectory(WAYPOINTS, maxVel, 2.0, 10.0, WHEELBASE_WIDTH);
+        controller->addPath(CompiledPath{"path", trajectory.velocity[0], trajectory.velocity[1],
+            trajectory.length, trajectory.dt, WHEELBASE_WIDTH});
+        std::printf("max velocity %.1f m/s, %.2f s\n", maxVel, trajectory.duration());
+
+        for(const Scenario &scenario : SCENARIOS)
+        {
+            std::printf("  %s\n", scenario.name);
+            for(Follower follower : {Follower::openLoop, Follower::encoders, Follower::truePose})
+            {
+                batch->reset(0);
+                batch->leftGrip[0] = scenario.leftGrip;
+                batch->rightGrip[0] = scenario.rightGrip;
+                model->resetSensors();
+                if(follower == Follower::encoders)
+                {
+                    controller->setPoseSource(std::make_shared<EncoderOdometry>(model,
+                        ChassisScales({4.1_in, 12.5_in})));
+                }
+                else if(follower == Follower::truePose)
+                {
+                    controller->setPoseSource(std::make_shared<sim::SkidSteerPoseSource>(batch, 0));
+                }
+                else
+                {
+                    controller->setPoseSource(nullptr);
+                }
+
+                bumpTime = sim::micros() + static_cast<std::uint64_t>(trajectory.duration() * 0.4e6);
+                bumpAngle = scenario.bump;
+                controller->setTarget("path");
+                controller->waitUntilSettled();
+                //Let the robot coast to a stop
+                pros::delay(500);
+
+                const Waypoint &end = WAYPOINTS.back();
+                std::printf("    %-26s position error %6.1f mm  heading error %6.2f deg\n", followerName(follower),
+                    std::hypot(batch->x[0] - end.x, batch->y[0] - end.y) * 1000,
+                    std::remainder(batch->theta[0] - end.angle, 2 * M_PI) / DEG);
+            }
+        }
+
+        controller->removePath("path");
+        trajectory.release();
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    batch = std::make_shared<sim::SkidSteerBatch>(1);
+    model = std::make_shared<sim::SimSkidSteerModel>(batch, 0);
+    sim::addTickHook([](double dt) {
+        if(bumpAngle != 0 && sim::micros() >= bumpTime)
+        {
+            batch->theta[0] += bumpAngle;
+            bumpAngle = 0;
+        }
+        batch->step(dt);
+    });
+
+    //Started before the simulation so its threads join the scheduler
+    controller = new PathController(sim::SimTimeUtilFactory::create(), 1.0, 2.0, 10.0, model,
+        ChassisScales({4.1_in, 12.5_in}), AbstractMotor::GearsetRatioPair(AbstractMotor::gearset::green));
+    controller->startThread();
+
+    sim::createTask(accuracyTask, nullptr, "Follower Accuracy");
+    //okapi's threads never exit, so run for longer than the paths take
+    sim::run(60000);
+    delete controller;
+    sim::shutdown();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "main.h"
+#include "sim.hpp"
+#include "subsystems.hpp"
+#include <chrono>
+#include <random>
+#include <vector>
+
+/**
+ * Compares opcontrol's compile-time joystick curves with scaleDeadband() and
+ * expCurve(): how far apart their outputs are, and how long each takes.
+ *
+ * Usage: joystickCurveBenchmark
+ */
+
+namespace
+{
+    //Each pass shapes the three sticks opcontrol reads, like one loop
+    const int PASSES = 2000000;
+
+    //Sticks are looked up at compile time
+    static_assert(LinearCurve::at(8) == 0, "Deadband is not applied");
+    static_assert(LinearCurve::at(127) == 127 && SensitiveCurve::at(-127) == -127, "Curves do not reach full scale");
+
+    double nowSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * prints the largest difference between a table and the functions it
+     * replaces
+     */
+    template <typename Curve>
+    void printError(const char * name, double power)
+    {
+        double maxError = 0;
+        for(int input = -127; input <= 127; input++)
+        {
+            maxError = std::max(maxError, std::abs(Curve::at(input) - expCurve(scaleDeadband(input, 8), power, 127)));
+        }
+        std::printf("%-14s max difference from expCurve(scaleDeadband()) %.3g\n", name, maxError);
+    }
+} // namespace
+
+int main(int argc, char ** argv)
+{
+    printError<LinearCurve>("LinearCurve", 1.0);
+    printError<SensitiveCurve>("SensitiveCurve", 1.3);
+
+    //Controller readings as okapi reports them, one per stick per pass
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> stick(-127, 127);
+    std::vector<float> readings(3 * 1024);
+    for(float & reading : readings)
+    {
+        reading = stick(generator) / 127.0f;
+    }
+    const std::size_t mask = readings.size() / 3 - 1;
+
+    double sum = 0;
+    double start = nowSeconds();
+    for(int pass = 0; pass < PASSES; pass++)
+    {
+        const float * sticks = &readings[3 * (pass & mask)];
+        int y = expCurve(scaleDeadband(127 * sticks[0], 8), 1.0, 127);
+        int r_linear = expCurve(scaleDeadband(127 * sticks[1], 8), 1.0, 127);
+        int r_sensitive = expCurve(scaleDeadband(127 * sticks[2], 8), 1.3, 127);
+        sum += y + r_linear + r_sensitive;
+    }
+    double functionSeconds = nowSeconds() - start;
+
+    double tableSum = 0;
+    start = nowSeconds();
+    for(int pass = 0; pass < PASSES; pass++)
+    {
+        const float * sticks = &readings[3 * (pass & mask)];
+        int y = LinearCurve::fromAnalog(sticks[0]);
+        int r_linear = LinearCurve::fromAnalog(sticks[1]);
+        int r_sensitive = SensitiveCurve::fromAnalog(sticks[2]);
+        tableSum += y + r_linear + r_sensitive;
+    }
+    double tableSeconds = nowSeconds() - start;
+
+    std::printf("functions: %7.2f ns per loop (checksum %.0f)\n", functionSeconds / PASSES * 1e9, sum);
+    std::printf("tables:    %7.2f ns per loop (checksum %.0f)\n", tableSeconds / PASSES * 1e9, tableSum);
+
+    //The robot program's okapi threads started at static initialization;
+    //ending the (empty) simulation lets them wind down so they can be joined
+    sim::run(0);
+    sim::shutdown();
+    return 0;
+}
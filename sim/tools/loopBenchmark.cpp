@@ -0,0 +1,171 @@
+#include "main.h"
+#include "driverScript.hpp"
+#include "robotModel.hpp"
+#include "sim.hpp"
+#include "subsystems.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/**
+ * Measures the opcontrol() and puncherHandler() loops while the driver script
+ * drives the simulated robot: how long each iteration's work takes, section by
+ * section, and how evenly the iterations are spaced.
+ *
+ * Costs are host CPU time, so compare them with each other rather than with
+ * the V5's. Periods are virtual time, so they show the scheduling the loops
+ * ask for: a loop that sleeps a fixed REFRESH_MS after its work drifts by the
+ * work's cost on the robot, and blocking calls in the loop show up as long
+ * periods here.
+ *
+ * Usage: loopBenchmark [--duration=<seconds>]
+ *  --duration virtual time to simulate, default 105 (a full driver period)
+ */
+
+namespace
+{
+    const char * SECTION_NAMES[NUM_LOOP_SECTIONS] = {"input", "drive", "cap lift", "LCD", "intake", "puncher"};
+
+    std::vector<LoopSample> opcontrolSamples;
+    std::vector<LoopSample> puncherSamples;
+
+    std::uint64_t hostNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::uint64_t virtualNanos()
+    {
+        return sim::micros() * 1000;
+    }
+
+    /**
+     * moves every waiting sample out of a profiler
+     */
+    void drain(LoopProfiler &profiler, std::vector<LoopSample> &out)
+    {
+        LoopSample batch[64];
+        std::size_t count;
+        while((count = profiler.drain(batch, 64)) > 0)
+        {
+            out.insert(out.end(), batch, batch + count);
+        }
+    }
+
+    /**
+     * prints min/median/p99/max of a set of times
+     * @param values times in nanoseconds; sorted in place
+     * @param scale nanoseconds per printed unit
+     */
+    void printStats(const char * name, std::vector<double> &values, double scale)
+    {
+        if(values.empty())
+        {
+            return;
+        }
+        std::sort(values.begin(), values.end());
+        auto percentile = [&values](double p) {
+            return values[static_cast<std::size_t>(p * (values.size() - 1) + 0.5)];
+        };
+        std::printf("  %-10s %10.3f %10.3f %10.3f %10.3f\n", name, values.front() / scale, percentile(0.5) / scale,
+            percentile(0.99) / scale, values.back() / scale);
+    }
+
+    /**
+     * prints a loop's iteration periods and its per-section costs
+     */
+    void report(const char * loop, const std::vector<LoopSample> &samples)
+    {
+        std::printf("%s: %zu iterations\n", loop, samples.size());
+        if(samples.size() < 2)
+        {
+            return;
+        }
+
+        std::printf("  %-10s %10s %10s %10s %10s\n", "period ms", "min", "median", "p99", "max");
+        std::vector<double> periods;
+        std::vector<double> jitter;
+        for(std::size_t i = 1; i < samples.size(); i++)
+        {
+            double period = samples[i].start - samples[i - 1].start;
+            periods.push_back(period);
+            jitter.push_back(std::abs(period - REFRESH_MS * 1e6));
+        }
+        printStats("period", periods, 1e6);
+        printStats("|jitter|", jitter, 1e6);
+
+        std::printf("  %-10s %10s %10s %10s %10s\n", "cost us", "min", "median", "p99", "max");
+        std::vector<double> totals(samples.size());
+        for(int section = 0; section < NUM_LOOP_SECTIONS; section++)
+        {
+            std::vector<double> costs;
+            for(std::size_t i = 0; i < samples.size(); i++)
+            {
+                costs.push_back(samples[i].sections[section]);
+                totals[i] += samples[i].sections[section];
+            }
+            //Sections the loop never marks stay at zero
+            if(*std::max_element(costs.begin(), costs.end()) > 0)
+            {
+                printStats(SECTION_NAMES[section], costs, 1e3);
+            }
+        }
+        printStats("total", totals, 1e3);
+        std::printf("\n");
+    }
+} // namespace
+
+/**
+ * mirrors the PROS system daemon: initialize(), then opcontrol() with the
+ * driver script
+ * @param param unused null parameter
+ */
+void competitionTask(void * param)
+{
+    initialize();
+    pros::Task opcontrolTask([](void *) { opcontrol(); }, nullptr, TASK_PRIORITY_DEFAULT,
+        TASK_STACK_DEPTH_DEFAULT, "User Operator Control (PROS)");
+    pros::Task driverTask(sim::driverScript, nullptr, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT,
+        "Sim Driver");
+}
+
+int main(int argc, char ** argv)
+{
+    double durationSeconds = 105;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strncmp(argv[i], "--duration=", 11) == 0)
+        {
+            durationSeconds = std::atof(argv[i] + 11);
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--duration=<seconds>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    //Only the report belongs on stdout
+    telemetryFile = "/dev/null";
+    sim::attachRobotModel();
+    opcontrolProfiler.enable(hostNanos, virtualNanos);
+    puncherProfiler.enable(hostNanos, virtualNanos);
+    //Drain every tick so the profilers' buffers never fill
+    sim::addTickHook([](double dt) {
+        drain(opcontrolProfiler, opcontrolSamples);
+        drain(puncherProfiler, puncherSamples);
+    });
+
+    sim::createTask(competitionTask, nullptr, "User Initialization (PROS)");
+    sim::run(static_cast<std::uint32_t>(durationSeconds * 1000));
+    sim::shutdown();
+    drain(opcontrolProfiler, opcontrolSamples);
+    drain(puncherProfiler, puncherSamples);
+
+    report("opcontrol()", opcontrolSamples);
+    report("puncherHandler()", puncherSamples);
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "main.h"
+#include "robotModel.hpp"
+#include "sim.hpp"
+#include "subsystems.hpp"
+#include <cmath>
+#include <vector>
+
+/**
+ * Times the puncher and cap lift macros against the mechanism physics.
+ *
+ * Usage: macroTiming
+ */
+
+namespace
+{
+    sim::RobotModel robot;
+    //Virtual time of every puncher release (us)
+    std::vector<std::uint64_t> shotTimes;
+
+    double elapsedMs(std::uint64_t start)
+    {
+        return (sim::micros() - start) / 1000.0;
+    }
+
+    /**
+     * prints the releases that happened since a macro started
+     */
+    void printShots(std::uint64_t start, std::size_t firstShot)
+    {
+        for(std::size_t i = firstShot; i < shotTimes.size(); i++)
+        {
+            std::printf("    release %zu at %8.1f ms\n", i - firstShot + 1, (shotTimes[i] - start) / 1000.0);
+        }
+    }
+} // namespace
+
+/**
+ * runs each macro from a known state and reports how long it blocked
+ * @param param unused null parameter
+ */
+void timingTask(void * param)
+{
+    initialize();
+
+    std::uint64_t start = sim::micros();
+    setPuncherAngle(PuncherAngles::NEAR_HIGH_FLAG, 50, true);
+    std::printf("setPuncherAngle(NEAR_HIGH_FLAG, blocking) %8.1f ms\n", elapsedMs(start));
+
+    std::size_t firstShot = shotTimes.size();
+    start = sim::micros();
+    launch(true);
+    std::printf("launch(true)                              %8.1f ms\n", elapsedMs(start));
+    printShots(start, firstShot);
+
+    //The double shot macro, stepped as puncherHandler() steps it
+    firstShot = shotTimes.size();
+    start = sim::micros();
+    puncherStateMachine.requestDoubleShot(PuncherAngles::NEAR_HIGH_FLAG, PuncherAngles::NEAR_LOW_FLAG);
+    while(puncherStateMachine.isBusy())
+    {
+        puncherStateMachine.update(getSensorSnapshot());
+        pros::delay(REFRESH_MS);
+    }
+    std::printf("requestDoubleShot(NEAR_HIGH_FLAG, NEAR_LOW_FLAG) %8.1f ms\n", elapsedMs(start));
+    printShots(start, firstShot);
+
+    //An angle queued during a double shot, then another requested as soon as
+    //the double shot is done; the machine should end at the last one and
+    //give the cap lift back
+    robot.capLift->setAngle(40 * M_PI / 180.0);
+    pros::delay(50);
+    firstShot = shotTimes.size();
+    start = sim::micros();
+    puncherStateMachine.requestDoubleShot(PuncherAngles::NEAR_HIGH_FLAG, PuncherAngles::NEAR_LOW_FLAG);
+    puncherStateMachine.requestAngle(PuncherAngles::NEAR_HIGH_FLAG);
+    bool requested = false;
+    bool wasFiring = false;
+    while(puncherStateMachine.isBusy() && elapsedMs(start) < 10000)
+    {
+        puncherStateMachine.update(getSensorSnapshot());
+        bool firing = puncherStateMachine.getState() == PuncherStateMachine::State::FIRING;
+        if(!requested && wasFiring && !firing && shotTimes.size() - firstShot >= 2)
+        {
+            puncherStateMachine.requestAngle(PuncherAngles::NEAR_LOW_FLAG);
+            requested = true;
+        }
+        wasFiring = firing;
+        pros::delay(REFRESH_MS);
+    }
+    std::printf("double shot, queued angle, then NEAR_LOW_FLAG %8.1f ms%s, ends at %5.1f deg of %5.1f%s\n",
+        elapsedMs(start), puncherStateMachine.isBusy() ? " (stuck)" : "",
+        getSensorSnapshot().motors[ANGLE_ADJUSTER].position, PuncherAngles::NEAR_LOW_FLAG.getAngleValue(),
+        puncherStateMachine.ownsCapLift() ? ", cap lift still owned" : "");
+    printShots(start, firstShot);
+
+    //Cap lift clearance from a range of starting heights
+    setPuncherAngle(PuncherAngles::NEAR_HIGH_FLAG, 50, true);
+    for(double liftDegrees : {0.0, 15.0, 25.0, 35.0, 45.0, 60.0, 90.0})
+    {
+        robot.capLift->setAngle(liftDegrees * M_PI / 180.0);
+        pros::delay(50);
+        start = sim::micros();
+        unobstructCapLift();
+        std::printf("unobstructCapLift() from %5.1f deg         %8.1f ms, ends at %5.1f deg\n", liftDegrees,
+            elapsedMs(start), getCapLiftPos());
+    }
+
+    //Aiming for the low flag with the cap lift in its way: one mechanism after
+    //the other, then both together
+    setPuncherAngle(PuncherAngles::NEAR_HIGH_FLAG, 50, true);
+    robot.capLift->setAngle(40 * M_PI / 180.0);
+    pros::delay(50);
+    start = sim::micros();
+    setPuncherAngle(PuncherAngles::NEAR_LOW_FLAG, 50, true);
+    unobstructCapLift();
+    std::printf("setPuncherAngle(NEAR_LOW_FLAG), unobstructCapLift() %8.1f ms, ends at %5.1f deg\n",
+        elapsedMs(start), getCapLiftPos());
+
+    setPuncherAngle(PuncherAngles::NEAR_HIGH_FLAG, 50, true);
+    robot.capLift->setAngle(40 * M_PI / 180.0);
+    pros::delay(50);
+    start = sim::micros();
+    aimAndClearCapLift(PuncherAngles::NEAR_LOW_FLAG, true);
+    std::printf("aimAndClearCapLift(NEAR_LOW_FLAG, blocking)           %8.1f ms, ends at %5.1f deg\n",
+        elapsedMs(start), getCapLiftPos());
+
+    std::printf("%d releases, %d into the cap lift\n", robot.puncher->getShotCount(),
+        robot.puncher->getObstructedShotCount());
+}
+
+int main(int argc, char ** argv)
+{
+    //Only the timings belong on stdout
+    telemetryFile = "/dev/null";
+    robot = sim::attachRobotModel();
+    sim::addTickHook([lastCount = 0](double dt) mutable {
+        if(robot.puncher->getShotCount() > lastCount)
+        {
+            lastCount = robot.puncher->getShotCount();
+            shotTimes.push_back(sim::micros());
+        }
+    });
+
+    sim::createTask(timingTask, nullptr, "Macro Timing");
+    //okapi's threads never exit, so run for longer than the macros take
+    sim::run(120000);
+    sim::shutdown();
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include "main.h"
+#include "pathController.hpp"
+#include "sim.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Compiles autonomous path definitions into a header of constant wheel
+ * velocity tables, generated by the same pipeline PathController runs on the
+ * robot.
+ * Register the tables with PathController::addPath() and the robot never
+ * generates them.
+ *
+ * Usage: pathCompiler <definitions> <header>
+ *
+ * Definitions, with # starting a comment:
+ *  wheelbase <wheelbase width in>
+ *  profile <center|wheel>        optional, how later paths are timed; default
+ *                                wheel (see PathProfile)
+ *  path <name> <max vel m/s> <max accel m/s/s> <max jerk m/s/s/s>
+ *  <x in> <y in> <theta deg>     one line per waypoint, at least two
+ *  end
+ */
+
+namespace
+{
+    struct PathDefinition
+    {
+        std::string name;
+        double maxVel;
+        double maxAccel;
+        double maxJerk;
+        PathProfile profile;
+        std::vector<Waypoint> waypoints;
+    };
+
+    struct Definitions
+    {
+        double wheelbaseWidth = 0;
+        PathProfile profile = PathProfile::wheel;
+        std::vector<PathDefinition> paths;
+    };
+
+    const double METERS_PER_INCH = 0.0254;
+
+    /**
+     * reads a definitions file; prints the problem and returns false if it is
+     * malformed
+     */
+    bool parseDefinitions(const char * fileName, Definitions &out)
+    {
+        std::ifstream file(fileName);
+        if(!file)
+        {
+            std::fprintf(stderr, "%s: could not open\n", fileName);
+            return false;
+        }
+
+        PathDefinition * path = nullptr;
+        std::string line;
+        for(int lineNumber = 1; std::getline(file, line); lineNumber++)
+        {
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::string first;
+            if(!(words >> first))
+            {
+                continue;
+            }
+
+            bool valid = true;
+            if(first == "wheelbase" && path == nullptr)
+            {
+                valid = static_cast<bool>(words >> out.wheelbaseWidth);
+                out.wheelbaseWidth *= METERS_PER_INCH;
+            }
+            else if(first == "profile" && path == nullptr)
+            {
+                std::string profile;
+                valid = static_cast<bool>(words >> profile) && (profile == "center" || profile == "wheel");
+                out.profile = (profile == "center") ? PathProfile::center : PathProfile::wheel;
+            }
+            else if(first == "path" && path == nullptr)
+            {
+                out.paths.emplace_back();
+                path = &out.paths.back();
+                path->profile = out.profile;
+                valid = static_cast<bool>(words >> path->name >> path->maxVel >> path->maxAccel >> path->maxJerk);
+            }
+            else if(first == "end" && path != nullptr)
+            {
+                valid = path->waypoints.size() >= 2;
+                path = nullptr;
+            }
+            else if(path != nullptr)
+            {
+                Waypoint point;
+                words.str(line);
+                words.clear();
+                valid = static_cast<bool>(words >> point.x >> point.y >> point.angle);
+                point.x *= METERS_PER_INCH;
+                point.y *= METERS_PER_INCH;
+                point.angle *= M_PI / 180.0;
+                path->waypoints.push_back(point);
+            }
+            else
+            {
+                valid = false;
+            }
+
+            if(!valid)
+            {
+                std::fprintf(stderr, "%s:%d: could not parse \"%s\"\n", fileName, lineNumber, line.c_str());
+                return false;
+            }
+        }
+
+        if(path != nullptr || out.wheelbaseWidth <= 0 || out.paths.empty())
+        {
+            std::fprintf(stderr, "%s: needs a wheelbase, a path and an end for every path\n", fileName);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * turns a camelCase path name into an UPPER_SNAKE_CASE identifier
+     */
+    std::string constantName(const std::string &name)
+    {
+        std::string constant;
+        for(std::size_t i = 0; i < name.size(); i++)
+        {
+            if(std::isupper(static_cast<unsigned char>(name[i])) && i > 0)
+            {
+                constant += '_';
+            }
+            constant += std::isalnum(static_cast<unsigned char>(name[i])) ?
+                static_cast<char>(std::toupper(static_cast<unsigned char>(name[i]))) : '_';
+        }
+        return constant;
+    }
+
+    //Values per line of a velocity table
+    const int VALUES_PER_LINE = 8;
+
+    void writeVelocities(std::FILE * header, const std::string &constant, const float * velocities, int length)
+    {
+        std::fprintf(header, "inline constexpr float %s[] = {", constant.c_str());
+        for(int i = 0; i < length; i++)
+        {
+            //9 significant digits read back as the same float
+            std::fprintf(header, "%s%.9g,", (i % VALUES_PER_LINE == 0) ? "\n    " : " ", velocities[i]);
+        }
+        std::fprintf(header, "\n};\n\n");
+    }
+} // namespace
+
+int main(int argc, char ** argv)
+{
+    if(argc != 3)
+    {
+        std::fprintf(stderr, "usage: %s <definitions> <header>\n", argv[0]);
+        return 1;
+    }
+
+    Definitions definitions;
+    if(!parseDefinitions(argv[1], definitions))
+    {
+        return 1;
+    }
+
+    std::FILE * header = std::fopen(argv[2], "w");
+    if(header == nullptr)
+    {
+        std::fprintf(stderr, "%s: could not open for writing\n", argv[2]);
+        return 1;
+    }
+
+    std::fprintf(header, "//Generated by sim/bin/pathCompiler from %s; do not edit.\n", argv[1]);
+    std::fprintf(header, "//Regenerate with: make -C sim paths\n\n");
+    std::fprintf(header, "//Header guard\n#pragma once\n\n#include \"pathController.hpp\"\n\n");
+    std::fprintf(header, "namespace CompiledPaths\n{\n\n");
+
+    //Generate every path at once, spread across the host's cores
+    std::vector<PathController::PathRequest> requests;
+    for(const PathDefinition &path : definitions.paths)
+    {
+        requests.push_back({path.waypoints, path.maxVel, path.maxAccel, path.maxJerk, path.profile});
+    }
+    std::vector<PathController::PathResult> results = PathController::generateTrajectories(requests,
+        definitions.wheelbaseWidth);
+
+    int status = 0;
+    std::vector<std::string> constants;
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        const PathDefinition &path = definitions.paths[i];
+        const PathController::TrajectoryPair &trajectory = results[i].trajectory;
+        if(!results[i].error.empty())
+        {
+            std::fprintf(stderr, "%s: path %s: %s\n", argv[1], path.name.c_str(), results[i].error.c_str());
+            status = 1;
+            break;
+        }
+
+        const std::string constant = constantName(path.name);
+        constants.push_back(constant);
+        writeVelocities(header, constant + "_LEFT", trajectory.velocity[0], trajectory.length);
+        writeVelocities(header, constant + "_RIGHT", trajectory.velocity[1], trajectory.length);
+        std::fprintf(header, "inline constexpr CompiledPath %s{\"%s\", %s_LEFT, %s_RIGHT, %d, %.9g, %.17g};\n\n",
+            constant.c_str(), path.name.c_str(), constant.c_str(), constant.c_str(), trajectory.length,
+            trajectory.dt, definitions.wheelbaseWidth);
+        std::printf("%-24s %5d segments, %6.2f s, %6zu bytes\n", path.name.c_str(), trajectory.length,
+            trajectory.duration(), trajectory.bytes());
+    }
+    for(PathController::PathResult &result : results)
+    {
+        result.trajectory.release();
+    }
+
+    std::fprintf(header, "//Every compiled path, for registering them all at once\n");
+    std::fprintf(header, "inline constexpr const CompiledPath * ALL[] = {\n");
+    for(const std::string &constant : constants)
+    {
+        std::fprintf(header, "    &%s,\n", constant.c_str());
+    }
+    std::fprintf(header, "};\n\n} // namespace CompiledPaths\n");
+    std::fclose(header);
+    if(status != 0)
+    {
+        //Leave no half-written header behind
+        std::remove(argv[2]);
+    }
+
+    //The robot program's okapi threads started at static initialization;
+    //ending the (empty) simulation lets them wind down so they can be joined
+    sim::run(0);
+    sim::shutdown();
+    return status;
+}
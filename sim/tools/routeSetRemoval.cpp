@@ -0,0 +1,122 @@
+#include "main.h"
+#include "pathController.hpp"
+#include "sim.hpp"
+#include "simTimeUtil.hpp"
+#include "skidSteerSim.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * Removes the route set being followed partway through its first leg, then
+ * generates new paths into the memory it freed, and checks that the leg
+ * being played still ends where it would have and the rest of the route is
+ * skipped.
+ *
+ * Usage: routeSetRemoval
+ */
+
+namespace
+{
+    const double IN = 0.0254;
+    const std::uint16_t ROUTINE = 1;
+
+    const std::vector<Waypoint> FIRST_LEG = {{0, 0, 0}, {40 * IN, 0, 0}};
+    const std::vector<Waypoint> SECOND_LEG = {{0, 0, 0}, {20 * IN, 20 * IN, M_PI / 2}};
+    //Generated over the freed set while the first leg is still playing
+    const std::vector<Waypoint> OVERWRITE = {{0, 0, 0}, {10 * IN, -30 * IN, -1.5}};
+
+    std::shared_ptr<sim::SkidSteerBatch> batch;
+    std::shared_ptr<sim::SimSkidSteerModel> model;
+    PathController * controller;
+    bool passed = false;
+} // namespace
+
+/**
+ * follows the two leg route
+ * @param iremove whether to remove its set partway through the first leg
+ * @return where the robot stopped
+ */
+Waypoint followRoute(bool iremove)
+{
+    controller->setRouteSet(ROUTINE);
+    controller->generatePath(FIRST_LEG, "first");
+    controller->generatePath(SECOND_LEG, "second");
+    controller->setRouteSet(0);
+
+    batch->reset(0);
+    model->resetSensors();
+    controller->queueTarget("first");
+    controller->queueTarget("second");
+    if(iremove)
+    {
+        pros::delay(400);
+        std::printf("  removed %zu paths mid-route\n", controller->removeRouteSet(ROUTINE));
+        controller->setRouteSet(ROUTINE);
+        controller->generatePath(OVERWRITE, "overwrite1");
+        controller->generatePath(OVERWRITE, "overwrite2");
+        controller->setRouteSet(0);
+    }
+    controller->waitUntilSettled();
+    //Let the robot coast to a stop
+    pros::delay(500);
+
+    const PathController::MemoryUsage usage = controller->getMemoryUsage();
+    std::printf("  saved paths %zu bytes (peak %zu)\n", usage.saved, usage.savedPeak);
+    controller->removeRouteSet(ROUTINE);
+    return Waypoint{batch->x[0], batch->y[0], batch->theta[0]};
+}
+
+/**
+ * runs the route both ways and compares where the robot stopped
+ * @param param unused null parameter
+ */
+void removalTask(void * param)
+{
+    //Settings take the controller's locks, so they are set from a task
+    controller->setCacheDirectory("");
+
+    //With the set removed, only the first leg should be followed
+    controller->setRouteSet(ROUTINE);
+    controller->generatePath(FIRST_LEG, "first");
+    controller->setRouteSet(0);
+    batch->reset(0);
+    model->resetSensors();
+    controller->setTarget("first");
+    controller->waitUntilSettled();
+    pros::delay(500);
+    const Waypoint expected{batch->x[0], batch->y[0], batch->theta[0]};
+    controller->removeRouteSet(ROUTINE);
+
+    std::printf("whole route\n");
+    const Waypoint whole = followRoute(false);
+    std::printf("  end %.1f %.1f in\n", whole.x / IN, whole.y / IN);
+
+    std::printf("set removed during the first leg\n");
+    const Waypoint removed = followRoute(true);
+    const double error = std::hypot(removed.x - expected.x, removed.y - expected.y);
+    std::printf("  end %.1f %.1f in, %.2f mm from the end of the first leg\n", removed.x / IN, removed.y / IN,
+        error * 1000);
+
+    passed = error < 1e-3 && std::abs(removed.angle - expected.angle) < 1e-3;
+    std::printf(passed ? "PASS\n" : "FAIL\n");
+}
+
+int main(int argc, char ** argv)
+{
+    batch = std::make_shared<sim::SkidSteerBatch>(1);
+    model = std::make_shared<sim::SimSkidSteerModel>(batch, 0);
+    sim::addTickHook([](double dt) { batch->step(dt); });
+
+    //Started before the simulation so its threads join the scheduler
+    controller = new PathController(sim::SimTimeUtilFactory::create(), 1.0, 2.0, 10.0, model,
+        ChassisScales({4.1_in, 12.5_in}), AbstractMotor::GearsetRatioPair(AbstractMotor::gearset::green));
+    controller->startThread();
+
+    sim::createTask(removalTask, nullptr, "Route Set Removal");
+    //okapi's threads never exit, so run for longer than the paths take
+    sim::run(20000);
+    delete controller;
+    sim::shutdown();
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+#include "main.h"
+#include "generationPool.hpp"
+#include <algorithm>
+
+//----------------------------------------------------------------------------//
+//                               Generation Pool                              //
+//----------------------------------------------------------------------------//
+
+GenerationPool::GenerationPool(std::size_t iblockBytes) : blockBytes(iblockBytes)
+{
+}
+
+GenerationPool::~GenerationPool()
+{
+    release();
+}
+
+void * GenerationPool::allocate(std::size_t ibytes, std::size_t ialignment)
+{
+    //Move on through the kept blocks until one has room; a buffer too big for
+    //any of them gets a new block of its own
+    while(current < blocks.size())
+    {
+        const std::size_t start = (offset + ialignment - 1) & ~(ialignment - 1);
+        if(start + ibytes <= blocks[current].size)
+        {
+            used += start + ibytes - offset;
+            peak = std::max(peak, used);
+            offset = start + ibytes;
+            return blocks[current].data + start;
+        }
+
+        //The rest of a block that is passed over counts as used until
+        //reset(), since nothing else can have it
+        used += blocks[current].size - offset;
+        current++;
+        offset = 0;
+    }
+
+    //malloc() aligns for any type, so the new block needs no padding
+    const std::size_t size = std::max(ibytes, blockBytes);
+    auto * data = static_cast<unsigned char *>(std::malloc(size));
+    if(data == nullptr)
+    {
+        return nullptr;
+    }
+
+    blocks.push_back(Block{data, size});
+    current = blocks.size() - 1;
+    offset = ibytes;
+    used += ibytes;
+    peak = std::max(peak, used);
+    return data;
+}
+
+void GenerationPool::reset()
+{
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+void GenerationPool::release()
+{
+    for(Block &block : blocks)
+    {
+        std::free(block.data);
+    }
+    blocks.clear();
+    reset();
+}
+
+GenerationPool::Usage GenerationPool::getUsage() const
+{
+    std::size_t reserved = 0;
+    for(const Block &block : blocks)
+    {
+        reserved += block.size;
+    }
+    return Usage{used, peak, reserved};
+}
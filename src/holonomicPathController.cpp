@@ -0,0 +1,429 @@
+#include "main.h"
+#include "holonomicPathController.hpp"
+#include "trajectoryStream.hpp"
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------//
+//                          Holonomic Path Controller                         //
+//----------------------------------------------------------------------------//
+
+HolonomicPathController::HolonomicPathController(const TimeUtil &itimeUtil, double imaxVel, double imaxAccel,
+    const std::shared_ptr<XDriveModel> &imodel, const ChassisScales &iscales, AbstractMotor::GearsetRatioPair ipair)
+    : logger(Logger::instance()), maxVel(imaxVel), maxAccel(imaxAccel), model(imodel), scales(iscales), pair(ipair),
+      timeUtil(itimeUtil)
+{
+    if(ipair.ratio == 0)
+    {
+        logger->error("HolonomicPathController: The gear ratio cannot be zero! Check if you are using integer "
+            "division.");
+        throw std::invalid_argument("HolonomicPathController: The gear ratio cannot be zero! Check if you are using "
+            "integer division.");
+    }
+
+    //Paths are generated to the wheel limit, so keep it where the motors can
+    //actually follow
+    const double gearsetVel = toUnderlyingType(pair.internalGearset) / pair.ratio *
+        (scales.wheelDiameter * 1_pi).convert(meter) / 60;
+    if(maxVel > gearsetVel)
+    {
+        logger->warn("HolonomicPathController: Lowering the maximum velocity to the gearset's " +
+            std::to_string(gearsetVel) + " m/s");
+        maxVel = gearsetVel;
+    }
+}
+
+HolonomicPathController::~HolonomicPathController()
+{
+    dtorCalled.store(true, std::memory_order_release);
+
+    //Wait for the follower to exit before freeing the paths it uses
+    delete task;
+
+    for(auto &path : paths)
+    {
+        path.second.release();
+    }
+}
+
+void HolonomicPathController::generatePath(std::initializer_list<HolonomicPoint> iwaypoints,
+    const std::string &ipathId)
+{
+    if(iwaypoints.size() == 0)
+    {
+        //No point in generating a path
+        logger->warn("HolonomicPathController: Not generating a path because no waypoints were given.");
+        return;
+    }
+
+    std::vector<HolonomicWaypoint> points;
+    points.reserve(iwaypoints.size());
+    for(auto &point : iwaypoints)
+    {
+        points.push_back(HolonomicWaypoint{point.x.convert(meter), point.y.convert(meter),
+            point.travel.convert(radian), point.heading.convert(radian)});
+    }
+
+    WheelTrajectory path = generateTrajectory(points, maxVel, maxAccel, scales.wheelbaseWidth.convert(meter));
+
+    //Free the old path before overwriting it
+    removePath(ipathId);
+    pathsLock.take(TIMEOUT_MAX);
+    paths.emplace(ipathId, path);
+    pathsLock.give();
+}
+
+void HolonomicPathController::removePath(const std::string &ipathId)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    auto oldPath = paths.find(ipathId);
+    if(oldPath != paths.end())
+    {
+        if(oldPath->second.velocity[0] != nullptr && oldPath->second.velocity[0] == playing.velocity[0])
+        {
+            //The follower reads the path without the lock, so stop it and
+            //leave it to free the path
+            playingRemoved.store(true, std::memory_order_release);
+        }
+        else
+        {
+            oldPath->second.release();
+        }
+        paths.erase(oldPath);
+    }
+    pathsLock.give();
+}
+
+std::vector<std::string> HolonomicPathController::getPaths()
+{
+    std::vector<std::string> keys;
+    pathsLock.take(TIMEOUT_MAX);
+    for(const auto &path : paths)
+    {
+        keys.push_back(path.first);
+    }
+    pathsLock.give();
+    return keys;
+}
+
+void HolonomicPathController::setTarget(std::string ipathId)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    const bool running = isRunning.load(std::memory_order_acquire);
+    if(!running)
+    {
+        currentPath = ipathId;
+        isRunning.store(true, std::memory_order_release);
+    }
+    pathsLock.give();
+
+    logger->info(running ? "HolonomicPathController: Ignoring target " + ipathId +
+        " because a path is being followed" : "HolonomicPathController: Set target to " + ipathId);
+}
+
+void HolonomicPathController::controllerSet(std::string ivalue)
+{
+    setTarget(ivalue);
+}
+
+std::string HolonomicPathController::getTarget()
+{
+    pathsLock.take(TIMEOUT_MAX);
+    const std::string target = currentPath;
+    pathsLock.give();
+    return target;
+}
+
+void HolonomicPathController::waitUntilSettled()
+{
+    logger->info("HolonomicPathController: Waiting to settle");
+
+    auto rate = timeUtil.getRate();
+    while(!isSettled())
+    {
+        rate->delayUntil(10_ms);
+    }
+
+    logger->info("HolonomicPathController: Done waiting to settle");
+}
+
+Point HolonomicPathController::getError() const
+{
+    return Point{0_m, 0_m, 0_deg};
+}
+
+bool HolonomicPathController::isSettled()
+{
+    return isDisabled() || !isRunning.load(std::memory_order_acquire);
+}
+
+void HolonomicPathController::reset()
+{
+    //Interrupt executeSinglePath() by disabling the controller
+    flipDisable(true);
+
+    auto rate = timeUtil.getRate();
+    while(isRunning.load(std::memory_order_acquire))
+    {
+        rate->delayUntil(1_ms);
+    }
+
+    flipDisable(false);
+}
+
+void HolonomicPathController::flipDisable()
+{
+    flipDisable(!disabled.load(std::memory_order_acquire));
+}
+
+void HolonomicPathController::flipDisable(bool iisDisabled)
+{
+    logger->info("HolonomicPathController: flipDisable " + std::to_string(iisDisabled));
+    disabled.store(iisDisabled, std::memory_order_release);
+}
+
+bool HolonomicPathController::isDisabled() const
+{
+    return disabled.load(std::memory_order_acquire);
+}
+
+void HolonomicPathController::startThread()
+{
+    if(!task)
+    {
+        task = new CrossplatformThread(trampoline, this);
+    }
+}
+
+void HolonomicPathController::setControlPeriod(double iperiod)
+{
+    controlPeriod.store(std::max(iperiod, 0.0), std::memory_order_relaxed);
+}
+
+void HolonomicPathController::trampoline(void * context)
+{
+    if(context)
+    {
+        static_cast<HolonomicPathController *>(context)->loop();
+    }
+}
+
+void HolonomicPathController::loop()
+{
+    auto rate = timeUtil.getRate();
+
+    while(!dtorCalled.load(std::memory_order_acquire))
+    {
+        //A target set while disabled is dropped, so reset() never waits on it
+        if(isRunning.load(std::memory_order_acquire))
+        {
+            pathsLock.take(TIMEOUT_MAX);
+            const std::string pathId = currentPath;
+            auto path = paths.find(pathId);
+            const bool found = path != paths.end();
+            playing = found ? path->second : WheelTrajectory{};
+            const WheelTrajectory trajectory = playing;
+            playingRemoved.store(false, std::memory_order_release);
+            pathsLock.give();
+
+            if(!found)
+            {
+                logger->warn("HolonomicPathController: Target was set to non-existent path with name: " + pathId);
+            }
+            else if(!isDisabled())
+            {
+                executeSinglePath(trajectory, timeUtil.getRate());
+            }
+
+            //The last step might not be at rest, and we might have exited
+            //early from being disabled or the path being removed
+            model->stop();
+
+            pathsLock.take(TIMEOUT_MAX);
+            if(playingRemoved.load(std::memory_order_acquire))
+            {
+                playing.release();
+            }
+            playing = WheelTrajectory{};
+            isRunning.store(false, std::memory_order_release);
+            pathsLock.give();
+        }
+
+        rate->delayUntil(10_ms);
+    }
+}
+
+void HolonomicPathController::executeSinglePath(const WheelTrajectory &path, std::unique_ptr<AbstractRate> rate)
+{
+    const std::shared_ptr<AbstractMotor> motors[4] = {model->getTopLeftMotor(), model->getTopRightMotor(),
+        model->getBottomRightMotor(), model->getBottomLeftMotor()};
+
+    const double period = controlPeriod.load(std::memory_order_relaxed);
+
+    //Play by the clock, so the period can be anything and a late loop
+    //doesn't put the rest of the path behind
+    auto timer = timeUtil.getTimer();
+    const double start = timer->millis().convert(second);
+    while(!isDisabled() && !playingRemoved.load(std::memory_order_acquire) &&
+        !dtorCalled.load(std::memory_order_acquire))
+    {
+        const double time = timer->millis().convert(second) - start;
+        if(time >= path.duration())
+        {
+            break;
+        }
+
+        for(std::size_t wheel = 0; wheel < 4; wheel++)
+        {
+            const double wheelRPM = convertLinearToRotational(path.sample(wheel, time) * mps).convert(rpm);
+            motors[wheel]->moveVelocity(static_cast<std::int16_t>(std::lround(wheelRPM)));
+        }
+
+        rate->delayUntil(((period > 0) ? period : path.dt) * second);
+    }
+}
+
+HolonomicPathController::WheelTrajectory HolonomicPathController::generateTrajectory(
+    const std::vector<HolonomicWaypoint> &ipoints, double imaxVel, double imaxAccel, double iwheelbaseWidth,
+    double iarcLengthTolerance)
+{
+    if(ipoints.size() < 2)
+    {
+        throw std::runtime_error("Too few waypoints. " + getPathErrorMessage(ipoints));
+    }
+
+    //Only the wheel velocities outlive the call, so everything else comes
+    //from one pool
+    GenerationPool pool;
+
+    //Fit the position splines and note where each one starts along the path
+    PoolVector<Spline> splines(ipoints.size() - 1, Spline{}, PoolAllocator<Spline>(&pool));
+    PoolVector<double> starts(splines.size() + 1, 0, PoolAllocator<double>(&pool));
+    for(std::size_t i = 0; i < splines.size(); i++)
+    {
+        pf_fit_hermite_cubic(Waypoint{ipoints[i].x, ipoints[i].y, ipoints[i].travel},
+            Waypoint{ipoints[i + 1].x, ipoints[i + 1].y, ipoints[i + 1].travel}, &splines[i]);
+        const double length = splineDistance(splines[i], iarcLengthTolerance);
+        if(!(length > 0))
+        {
+            throw std::runtime_error("Two waypoints are in the same place. " + getPathErrorMessage(ipoints));
+        }
+        starts[i + 1] = starts[i] + length;
+    }
+
+    //The heading eases from each waypoint's to the next's by the shorter way
+    //round, turning fastest halfway between them and not at all at them:
+    //theta = theta0 + turn * (3u^2 - 2u^3), where u is the fraction of the
+    //spline's length covered
+    auto turn = [&ipoints](std::size_t i) {
+        return std::remainder(ipoints[i + 1].heading - ipoints[i].heading, 2 * M_PI);
+    };
+    auto heading = [&](std::size_t i, double u) { return ipoints[i].heading + turn(i) * u * u * (3 - 2 * u); };
+    auto headingRate = [&](std::size_t i, double u) {
+        return turn(i) * 6 * u * (1 - u) / (starts[i + 1] - starts[i]);
+    };
+    auto headingAccel = [&](std::size_t i, double u) {
+        const double length = starts[i + 1] - starts[i];
+        return turn(i) * 6 * (1 - 2 * u) / (length * length);
+    };
+
+    //The wheels sit on a square, rolling at 45 degrees to its sides, so each
+    //one turns at (forward +- left) / sqrt(2) +- turn rate * half diagonal.
+    //The worst wheel sees (|cos a| + |sin a|) / sqrt(2) + |dtheta/ds| * r of
+    //the robot's speed, where a is the travel direction relative to the
+    //heading.
+    const double radius = iwheelbaseWidth / std::sqrt(2.0);
+    auto wheelScale = [radius](double relative, double rate) {
+        return (std::abs(std::cos(relative)) + std::abs(std::sin(relative))) / std::sqrt(2.0) + std::abs(rate) *
+            radius;
+    };
+
+    SpeedProfile profile(sampleSplines(splines, iarcLengthTolerance,
+        [&](std::size_t i, double progress, SpeedProfile::Sample &sample) {
+            const double u = (sample.distance - starts[i]) / (starts[i + 1] - starts[i]);
+            const double scale = wheelScale(pf_spline_angle(splines[i], progress) - heading(i, u),
+                headingRate(i, u));
+            sample.maxVel = imaxVel / scale;
+            sample.maxAccel = imaxAccel / scale;
+
+            //Even at a steady speed the wheels speed up and slow down as the
+            //travel direction swings relative to the heading and the turn
+            //rate changes, by v^2 * (|curvature - dtheta/ds| + |d2theta/ds2| * r)
+            const double swing = std::abs(splineCurvature(splines[i], progress) - headingRate(i, u)) +
+                std::abs(headingAccel(i, u)) * radius;
+            if(swing > 0)
+            {
+                sample.maxVel = std::min(sample.maxVel, std::sqrt(imaxAccel / swing));
+            }
+        }));
+
+    const double dt = 0.010;
+    const int length = static_cast<int>(std::ceil(profile.getDuration() / dt - 1e-9));
+    WheelTrajectory trajectory = WheelTrajectory::allocate(length, static_cast<float>(dt));
+    if(!trajectory.isValid())
+    {
+        throw std::runtime_error("Could not allocate trajectory. " + getPathErrorMessage(ipoints));
+    }
+
+    //Play the speed along the path out at the timestep. Each step uses the
+    //state at its end, as Pathfinder's segments do.
+    SplineCursor cursor(splines, iarcLengthTolerance);
+    std::size_t spline = 0;
+    for(int step = 0; step < length; step++)
+    {
+        Segment center{};
+        profile.at((step + 1) * dt, center.position, center.velocity);
+        cursor.place(center);
+        while(spline + 1 < splines.size() && center.position > starts[spline + 1])
+        {
+            spline++;
+        }
+
+        const double u = std::min(1.0, (center.position - starts[spline]) / (starts[spline + 1] - starts[spline]));
+        const double relative = center.heading - heading(spline, u);
+        const double forward = center.velocity * std::cos(relative);
+        const double left = center.velocity * std::sin(relative);
+        const double turnRate = center.velocity * headingRate(spline, u) * radius;
+
+        trajectory.column(0)[step] = static_cast<float>((forward - left) / std::sqrt(2.0) - turnRate);
+        trajectory.column(1)[step] = static_cast<float>((forward + left) / std::sqrt(2.0) + turnRate);
+        trajectory.column(2)[step] = static_cast<float>((forward - left) / std::sqrt(2.0) + turnRate);
+        trajectory.column(3)[step] = static_cast<float>((forward + left) / std::sqrt(2.0) - turnRate);
+    }
+    return trajectory;
+}
+
+QAngularSpeed HolonomicPathController::convertLinearToRotational(QSpeed linear) const
+{
+    return (linear * (360_deg / (scales.wheelDiameter * 1_pi))) * pair.ratio;
+}
+
+std::string HolonomicPathController::getPathErrorMessage(const std::vector<HolonomicWaypoint> &points)
+{
+    std::string message = "The path is impossible with waypoints: ";
+    for(const HolonomicWaypoint &point : points)
+    {
+        message += "HolonomicWaypoint{x=" + std::to_string(point.x) + ", y=" + std::to_string(point.y) +
+            ", travel=" + std::to_string(point.travel) + ", heading=" + std::to_string(point.heading) + "}, ";
+    }
+    return message;
+}
+
+//----------------------------------------------------------------------------//
+//                      Holonomic Path Controller Factory                     //
+//----------------------------------------------------------------------------//
+
+std::shared_ptr<HolonomicPathController> HolonomicPathControllerFactory::create(double imaxVel, double imaxAccel,
+    const ChassisController &ichassis)
+{
+    auto xModel = std::dynamic_pointer_cast<XDriveModel>(ichassis.getChassisModel());
+    if(!xModel)
+    {
+        throw std::invalid_argument("HolonomicPathControllerFactory: The chassis must be an X-drive.");
+    }
+
+    auto controller = std::make_shared<HolonomicPathController>(TimeUtilFactory::create(), imaxVel, imaxAccel,
+        xModel, ichassis.getChassisScales(), ichassis.getGearsetRatioPair());
+    controller->startThread();
+    return controller;
+}
@@ -1,4 +1,5 @@
 #include "main.h"
+#include "compiledPaths.hpp"
 #include "subsystems.hpp"
 
 /**
@@ -10,6 +11,18 @@
 void initialize()
 {
     pros::lcd::initialize();
+
+    //Start publishing sensor snapshots ahead of the tasks that read them
+    pros::Task sensorTask(sensorHandler, nullptr, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "Sensors");
+    pros::Task controllerTask(controllerHandler, nullptr, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT,
+        "Controller Input");
+    pros::Task telemetryTask(telemetryHandler, nullptr, TASK_PRIORITY_MIN, TASK_STACK_DEPTH_DEFAULT, "Telemetry");
+
+    //Autonomous paths are compiled into the program, so nothing is generated
+    for(const CompiledPath * path : CompiledPaths::ALL)
+    {
+        drivetrainPaths->addPath(*path);
+    }
 }
 
 /**
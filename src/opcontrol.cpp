@@ -19,6 +19,9 @@ void opcontrol()
 	//Set drivetrain brake mode
 	drivetrain.setBrakeMode(AbstractMotor::brakeMode::coast);
 
+	//Controller state, read once per loop
+	ControllerReader input;
+
 	//Spawn puncher handler task
 	pros::Task puncherHandlerTask(puncherHandler, nullptr);
 
@@ -27,72 +30,95 @@ void opcontrol()
 
 	while(true)
 	{
+		opcontrolProfiler.beginIteration();
+		input.update();
+		opcontrolProfiler.endSection(SECTION_INPUT);
+
 		//--------------------------------------------------------------------//
 		//                             Drivetrain                             //
 		//--------------------------------------------------------------------//
 
 		//Drive arcade control with y and r inputs
-		int y = expCurve(scaleDeadband(127 * masterController.getAnalog(ControllerAnalog::leftY), 8), 1.0, 127);
-		int r_linear = expCurve(scaleDeadband(127 * masterController.getAnalog(ControllerAnalog::leftX), 8), 1.0, 127);
-		int r_sensitive = expCurve(scaleDeadband(127 * masterController.getAnalog(ControllerAnalog::rightX), 8), 1.3, 127);
+		int y = LinearCurve::fromAnalog(input.getAnalog(ControllerAnalog::leftY));
+		int r_linear = LinearCurve::fromAnalog(input.getAnalog(ControllerAnalog::leftX));
+		int r_sensitive = SensitiveCurve::fromAnalog(input.getAnalog(ControllerAnalog::rightX));
 
 		driveVoltage(y, r_linear + r_sensitive, false);
+		opcontrolProfiler.endSection(SECTION_DRIVE);
 
 		//--------------------------------------------------------------------//
 		//                              Cap Lift                              //
 		//--------------------------------------------------------------------//
 
-		if(masterController.getDigital(ControllerDigital::R2))
-		{
-			//While cap lift angle < 170 deg, speed up as cap lift gets higher
-			capLiftMotor.moveVoltage(12000 - (std::max(0.0, 170.0 - getCapLiftPos())) * 30);
-		}
-		else if(masterController.getDigital(ControllerDigital::L2) && (getCapLiftPos() > 26.5))
-		{
-			//While cap lift angle < 170 deg, slow down as cap lift gets lower
-			capLiftMotor.moveVoltage(-(6000 - (std::max(0.0, 170.0 - getCapLiftPos())) * 30));
-		}
-		else
+		//Read once so every decision below sees the same instant
+		SensorSnapshot sensors = getSensorSnapshot();
+		double capLiftPos = getCapLiftPos(sensors);
+		controlTelemetry.log(TELEMETRY_CAP_LIFT, capLiftPos, sensors.motors[CAP_LIFT].velocity,
+			sensors.motors[CAP_LIFT].current);
+
+		//Leave the cap lift alone while a puncher macro moves it out of the way
+		if(!puncherStateMachine.ownsCapLift())
 		{
-			//If cap is in carry position range, set brake mode to hold
-			if(getCapLiftPos() < 30)
+			if(input.isPressed(ControllerDigital::R2))
 			{
-				//Go to neutral ground pos
-				capLiftMotor.moveVoltage(CAPLIFT_VOLTAGE_HOLD);
+				//While cap lift angle < 170 deg, speed up as cap lift gets higher
+				capLiftMotor.moveVoltage(12000 - (std::max(0.0, 170.0 - capLiftPos)) * 30);
 			}
-			else if(getCapLiftPos() < 170)
+			else if(input.isPressed(ControllerDigital::L2) && (capLiftPos > 26.5))
 			{
-				capLiftMotor.moveVoltage(CAPLIFT_VOLTAGE_HOLD);
+				//While cap lift angle < 170 deg, slow down as cap lift gets lower
+				capLiftMotor.moveVoltage(-(6000 - (std::max(0.0, 170.0 - capLiftPos)) * 30));
 			}
-			//Else, set brake mode to coast and use physical hardstops
 			else
 			{
-				capLiftMotor.setBrakeMode(AbstractMotor::brakeMode::coast);
-				capLiftMotor.moveVelocity(0);
+				//If cap is in carry position range, set brake mode to hold
+				if(capLiftPos < 30)
+				{
+					//Go to neutral ground pos
+					capLiftMotor.moveVoltage(CAPLIFT_VOLTAGE_HOLD);
+				}
+				else if(capLiftPos < 170)
+				{
+					capLiftMotor.moveVoltage(CAPLIFT_VOLTAGE_HOLD);
+				}
+				//Else, set brake mode to coast and use physical hardstops
+				else
+				{
+					capLiftMotor.setBrakeMode(AbstractMotor::brakeMode::coast);
+					capLiftMotor.moveVelocity(0);
+				}
 			}
 		}
+		opcontrolProfiler.endSection(SECTION_CAP_LIFT);
 
 		pros::lcd::clear_line(2);
-		pros::lcd::print(2, "CLPos#: %f", getCapLiftPos());
+		pros::lcd::print(2, "CLPos#: %f", capLiftPos);
+		opcontrolProfiler.endSection(SECTION_LCD);
 
 		//--------------------------------------------------------------------//
 		//                               Intake                               //
 		//--------------------------------------------------------------------//
 
-		if(masterController.getDigital(ControllerDigital::R1))
-		{
-			//Intake balls
-			setIntake(200);
-		}
-		else if(masterController.getDigital(ControllerDigital::L1))
+		//Leave the intake alone while a double shot loads its second ball
+		if(!puncherStateMachine.ownsIntake())
 		{
-			//Flip caps/out-take balls
-			setIntake(-200);
-		}
-		else
-		{
-			setIntake(0);
+			if(input.isPressed(ControllerDigital::R1))
+			{
+				//Intake balls
+				setIntake(200);
+			}
+			else if(input.isPressed(ControllerDigital::L1))
+			{
+				//Flip caps/out-take balls
+				setIntake(-200);
+			}
+			else
+			{
+				setIntake(0);
+			}
 		}
+		opcontrolProfiler.endSection(SECTION_INTAKE);
+		opcontrolProfiler.endIteration();
 
 		pros::delay(REFRESH_MS);
 	}
@@ -0,0 +1,1407 @@
+#include "main.h"
+#include "pathController.hpp"
+#include "ringBuffer.hpp"
+#include "splineArcLength.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifdef THREADS_STD
+#include <thread>
+#endif
+
+namespace
+{
+    //Name moveTo() saves its path under, and the target while it streams one
+    const char * const MOVE_TO_PATH = "PathController::moveTo";
+}
+
+//----------------------------------------------------------------------------//
+//                               Path Generation                              //
+//----------------------------------------------------------------------------//
+
+PathGeneration::PathGeneration(const std::string &ipathId, const std::vector<Waypoint> &ipoints)
+    : pathId(ipathId), points(ipoints)
+{
+}
+
+const std::string &PathGeneration::getPathId() const
+{
+    return pathId;
+}
+
+PathHandle PathGeneration::getHandle() const
+{
+    return handle;
+}
+
+PathGeneration::Status PathGeneration::getStatus() const
+{
+    return status.load(std::memory_order_acquire);
+}
+
+bool PathGeneration::isDone() const
+{
+    Status current = getStatus();
+    return current == Status::ready || current == Status::failed;
+}
+
+bool PathGeneration::wait() const
+{
+    while(!isDone())
+    {
+        pros::delay(1);
+    }
+    return getStatus() == Status::ready;
+}
+
+std::string PathGeneration::getError() const
+{
+    return (getStatus() == Status::failed) ? error : "";
+}
+
+void PathGeneration::fail(const std::string &ierror)
+{
+    error = ierror;
+    status.store(Status::failed, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------//
+//                               Path Controller                              //
+//----------------------------------------------------------------------------//
+
+PathController::PathController(const TimeUtil &itimeUtil, double imaxVel, double imaxAccel, double imaxJerk,
+    const std::shared_ptr<ChassisModel> &imodel, const ChassisScales &iscales,
+    AbstractMotor::GearsetRatioPair ipair)
+    : logger(Logger::instance()), maxVel(imaxVel), maxAccel(imaxAccel), maxJerk(imaxJerk), model(imodel),
+      scales(iscales), pair(ipair), timeUtil(itimeUtil)
+{
+    if(ipair.ratio == 0)
+    {
+        logger->error("PathController: The gear ratio cannot be zero! Check if you are using integer division.");
+        throw std::invalid_argument("PathController: The gear ratio cannot be zero! Check if you are using "
+            "integer division.");
+    }
+
+    route.reserve(ROUTE_CAPACITY);
+}
+
+PathController::~PathController()
+{
+    dtorCalled.store(true, std::memory_order_release);
+
+    //Wait for the follower and generator to exit before freeing the paths
+    //they use
+    delete task;
+    delete generatorTask;
+}
+
+PathHandle PathController::generatePath(std::initializer_list<Point> iwaypoints, const std::string &ipathId)
+{
+    return generatePath(toWaypoints(iwaypoints.begin(), iwaypoints.end()), ipathId);
+}
+
+PathHandle PathController::generatePath(const std::vector<Waypoint> &ipoints, const std::string &ipathId)
+{
+    if(ipoints.empty())
+    {
+        //No point in generating a path
+        logger->warn("PathController: Not generating a path because no waypoints were given.");
+        return PathHandle{};
+    }
+
+    generationLock.take(TIMEOUT_MAX);
+    TrajectoryPair path;
+    try
+    {
+        path = buildPath(ipoints, ipathId);
+    }
+    catch(const std::runtime_error &)
+    {
+        generationPool.reset();
+        generationLock.give();
+        throw;
+    }
+
+    //Replace the old path in place, so its handle stays the same
+    pathsLock.take(TIMEOUT_MAX);
+    cancelPendingLocked(ipathId);
+    const PathHandle handle = paths.insertCopy(ipathId, path, routeSet);
+    pathsLock.give();
+    generationPool.reset();
+    generationLock.give();
+
+    if(!handle.isValid())
+    {
+        std::string message = "PathController: Could not store path " + ipathId + ".";
+        logger->error(message);
+        throw std::runtime_error(message);
+    }
+    return handle;
+}
+
+std::shared_ptr<PathGeneration> PathController::generatePathAsync(std::initializer_list<Point> iwaypoints,
+    const std::string &ipathId)
+{
+    return generatePathAsync(toWaypoints(iwaypoints.begin(), iwaypoints.end()), ipathId);
+}
+
+std::shared_ptr<PathGeneration> PathController::generatePathAsync(const std::vector<Waypoint> &ipoints,
+    const std::string &ipathId)
+{
+    auto generation = std::make_shared<PathGeneration>(ipathId, ipoints);
+    if(ipoints.empty())
+    {
+        logger->warn("PathController: Not generating a path because no waypoints were given.");
+        generation->fail("No waypoints were given");
+        return generation;
+    }
+
+    pathsLock.take(TIMEOUT_MAX);
+    //A newer path replaces any that is still pending under the same name,
+    //and takes over its handle
+    cancelPendingLocked(ipathId);
+    generation->set = routeSet;
+    generation->handle = paths.reserve(ipathId, routeSet);
+    pendingPaths.emplace(ipathId, generation);
+    generationQueue.push_back(generation);
+    pathsLock.give();
+
+    logger->info("PathController: Queued path " + ipathId);
+    return generation;
+}
+
+PathHandle PathController::addPath(const CompiledPath &ipath)
+{
+    if(std::abs(ipath.wheelbaseWidth - scales.wheelbaseWidth.convert(meter)) > 1e-6)
+    {
+        logger->warn("PathController: Path " + std::string(ipath.name) + " was compiled for a wheelbase of " +
+            std::to_string(ipath.wheelbaseWidth) + " m; recompile it with sim/bin/pathCompiler");
+    }
+
+    pathsLock.take(TIMEOUT_MAX);
+    cancelPendingLocked(ipath.name);
+    const PathHandle handle = paths.insert(ipath.name,
+        TrajectoryPair{{ipath.leftVelocity, ipath.rightVelocity}, ipath.length, ipath.dt, false}, routeSet);
+    pathsLock.give();
+    return handle;
+}
+
+void PathController::removePath(const std::string &ipathId)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    removePathLocked(ipathId);
+    pathsLock.give();
+}
+
+std::vector<std::string> PathController::getPaths()
+{
+    pathsLock.take(TIMEOUT_MAX);
+    std::vector<std::string> keys = paths.getNames();
+    pathsLock.give();
+    return keys;
+}
+
+PathHandle PathController::getHandle(const std::string &ipathId)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    const PathHandle handle = paths.find(ipathId);
+    pathsLock.give();
+    return handle;
+}
+
+void PathController::setRouteSet(std::uint16_t iset)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    routeSet = iset;
+    pathsLock.give();
+}
+
+std::size_t PathController::removeRouteSet(std::uint16_t iset)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    std::vector<std::string> cancelled;
+    for(const auto &pending : pendingPaths)
+    {
+        if(pending.second->set == iset)
+        {
+            cancelled.push_back(pending.first);
+        }
+    }
+    for(const std::string &id : cancelled)
+    {
+        cancelPendingLocked(id);
+    }
+    const std::size_t removed = paths.removeSet(iset);
+    pathsLock.give();
+
+    logger->info("PathController: Removed " + std::to_string(removed) + " paths in route set " +
+        std::to_string(iset));
+    return removed;
+}
+
+PathController::MemoryUsage PathController::getMemoryUsage()
+{
+    generationLock.take(TIMEOUT_MAX);
+    const GenerationPool::Usage generation = generationPool.getUsage();
+    generationLock.give();
+
+    pathsLock.take(TIMEOUT_MAX);
+    const MemoryUsage usage{paths.getArenaBytes(), paths.getPeakArenaBytes(), generation.peak, generation.reserved};
+    pathsLock.give();
+    return usage;
+}
+
+void PathController::setCacheDirectory(const std::string &idirectory)
+{
+    generationLock.take(TIMEOUT_MAX);
+    cacheDirectory = idirectory;
+    generationLock.give();
+}
+
+void PathController::setArcLengthTolerance(double itolerance)
+{
+    generationLock.take(TIMEOUT_MAX);
+    arcLengthTolerance = itolerance;
+    generationLock.give();
+}
+
+void PathController::setProfile(PathProfile iprofile)
+{
+    generationLock.take(TIMEOUT_MAX);
+    profile = iprofile;
+    generationLock.give();
+}
+
+void PathController::setPoseSource(const std::shared_ptr<PoseSource> &isource)
+{
+    std::atomic_store(&poseSource, isource);
+}
+
+void PathController::setRamseteGains(double ib, double izeta)
+{
+    ramseteB.store(ib, std::memory_order_relaxed);
+    ramseteZeta.store(izeta, std::memory_order_relaxed);
+}
+
+void PathController::setStreaming(bool istreaming)
+{
+    streaming.store(istreaming, std::memory_order_release);
+}
+
+void PathController::setControlPeriod(double iperiod)
+{
+    controlPeriod.store(std::max(iperiod, 0.0), std::memory_order_relaxed);
+}
+
+void PathController::setTarget(std::string ipathId)
+{
+    const PathHandle handle = getHandle(ipathId);
+    if(!handle.isValid())
+    {
+        logger->warn("PathController: Target was set to non-existent path with name: " + ipathId);
+    }
+    setTarget(handle);
+}
+
+void PathController::setTarget(std::string ipathId, bool ibackwards)
+{
+    const PathHandle handle = getHandle(ipathId);
+    if(!handle.isValid())
+    {
+        logger->warn("PathController: Target was set to non-existent path with name: " + ipathId);
+    }
+    setTarget(handle, ibackwards);
+}
+
+void PathController::setTarget(PathHandle ihandle)
+{
+    startPath(ihandle, 0);
+}
+
+void PathController::setTarget(PathHandle ihandle, bool ibackwards)
+{
+    startPath(ihandle, ibackwards ? -1 : 1);
+}
+
+void PathController::queueTarget(const std::string &ipathId)
+{
+    const PathHandle handle = getHandle(ipathId);
+    if(!handle.isValid())
+    {
+        logger->warn("PathController: Queued non-existent path with name: " + ipathId);
+    }
+    queueTarget(handle);
+}
+
+void PathController::queueTarget(PathHandle ihandle)
+{
+    waitForGeneration(ihandle);
+
+    pathsLock.take(TIMEOUT_MAX);
+    if(!isRunning.load(std::memory_order_acquire))
+    {
+        route.clear();
+        currentPath = ihandle;
+        isRunning.store(true, std::memory_order_release);
+    }
+    route.push_back(ihandle);
+    pathsLock.give();
+
+    logger->info("PathController: Queued target");
+}
+
+int PathController::getCurrentLeg() const
+{
+    return currentLeg.load(std::memory_order_acquire);
+}
+
+void PathController::waitForGeneration(const std::string &ipathId)
+{
+    std::shared_ptr<PathGeneration> pending;
+    pathsLock.take(TIMEOUT_MAX);
+    auto found = pendingPaths.find(ipathId);
+    if(found != pendingPaths.end())
+    {
+        pending = found->second;
+
+        //Generate the path that is needed now before the rest of the queue
+        auto queued = std::find(generationQueue.begin(), generationQueue.end(), pending);
+        if(queued != generationQueue.end())
+        {
+            generationQueue.erase(queued);
+            generationQueue.push_front(pending);
+        }
+    }
+    pathsLock.give();
+
+    if(pending)
+    {
+        logger->info("PathController: Waiting for path " + ipathId + " to be generated");
+        pending->wait();
+    }
+}
+
+void PathController::waitForGeneration(PathHandle ihandle)
+{
+    //Nothing to wait for, or to look up, unless a path is queued
+    std::string pathId;
+    pathsLock.take(TIMEOUT_MAX);
+    if(!pendingPaths.empty())
+    {
+        pathId = paths.getName(ihandle);
+    }
+    pathsLock.give();
+
+    if(!pathId.empty())
+    {
+        waitForGeneration(pathId);
+    }
+}
+
+void PathController::controllerSet(std::string ivalue)
+{
+    setTarget(ivalue);
+}
+
+std::string PathController::getTarget()
+{
+    pathsLock.take(TIMEOUT_MAX);
+    std::string target = stream ? MOVE_TO_PATH : paths.getName(currentPath);
+    pathsLock.give();
+    return target;
+}
+
+void PathController::waitUntilSettled()
+{
+    logger->info("PathController: Waiting to settle");
+
+    auto rate = timeUtil.getRate();
+    while(!isSettled())
+    {
+        rate->delayUntil(10_ms);
+    }
+
+    logger->info("PathController: Done waiting to settle");
+}
+
+void PathController::moveTo(std::initializer_list<Point> iwaypoints)
+{
+    moveTo(toWaypoints(iwaypoints.begin(), iwaypoints.end()));
+}
+
+void PathController::moveTo(const std::vector<Waypoint> &ipoints)
+{
+    if(streaming.load(std::memory_order_acquire))
+    {
+        generationLock.take(TIMEOUT_MAX);
+        const double tolerance = arcLengthTolerance;
+        generationLock.give();
+        std::shared_ptr<TrajectoryStream> next = streamTrajectory(ipoints, maxVel, maxAccel,
+            scales.wheelbaseWidth.convert(meter), tolerance);
+
+        pathsLock.take(TIMEOUT_MAX);
+        if(isRunning.load(std::memory_order_acquire))
+        {
+            pathsLock.give();
+            logger->info("PathController: Ignoring streamed path because a path is already running");
+            return;
+        }
+        stream = next;
+        currentPath = PathHandle{};
+        direction.store(1, std::memory_order_release);
+        currentLeg.store(0, std::memory_order_release);
+        isRunning.store(true, std::memory_order_release);
+        pathsLock.give();
+
+        waitUntilSettled();
+        return;
+    }
+
+    const PathHandle handle = generatePath(ipoints, MOVE_TO_PATH);
+    setTarget(handle);
+    waitUntilSettled();
+    removePath(MOVE_TO_PATH);
+}
+
+Point PathController::getError() const
+{
+    return Point{errorX.load(std::memory_order_relaxed) * meter, errorY.load(std::memory_order_relaxed) * meter,
+        errorTheta.load(std::memory_order_relaxed) * radian};
+}
+
+bool PathController::isSettled()
+{
+    return isDisabled() || !isRunning.load(std::memory_order_acquire);
+}
+
+void PathController::reset()
+{
+    //Interrupt executeRoute() by disabling the controller
+    flipDisable(true);
+
+    auto rate = timeUtil.getRate();
+    while(isRunning.load(std::memory_order_acquire))
+    {
+        rate->delayUntil(1_ms);
+    }
+
+    flipDisable(false);
+}
+
+void PathController::flipDisable()
+{
+    flipDisable(!disabled.load(std::memory_order_acquire));
+}
+
+void PathController::flipDisable(bool iisDisabled)
+{
+    logger->info("PathController: flipDisable " + std::to_string(iisDisabled));
+    disabled.store(iisDisabled, std::memory_order_release);
+    //loop() stops the chassis once executeRoute() notices
+}
+
+bool PathController::isDisabled() const
+{
+    return disabled.load(std::memory_order_acquire);
+}
+
+void PathController::startThread()
+{
+    if(!task)
+    {
+        task = new CrossplatformThread(trampoline, this);
+    }
+    if(!generatorTask)
+    {
+        generatorTask = new CrossplatformThread(generatorTrampoline, this);
+    }
+}
+
+void PathController::trampoline(void * context)
+{
+    if(context)
+    {
+        static_cast<PathController *>(context)->loop();
+    }
+}
+
+void PathController::loop()
+{
+    auto rate = timeUtil.getRate();
+
+    while(!dtorCalled.load(std::memory_order_acquire))
+    {
+        //moveTo() sets both under the lock, so a stream is never mistaken
+        //for an empty route
+        pathsLock.take(TIMEOUT_MAX);
+        const bool running = isRunning.load(std::memory_order_acquire);
+        std::shared_ptr<TrajectoryStream> streamed = stream;
+        pathsLock.give();
+
+        //A target set while disabled is dropped, so reset() never waits on it
+        if(running && streamed)
+        {
+            if(!isDisabled())
+            {
+                executeStream(*streamed, timeUtil.getRate());
+            }
+            model->stop();
+
+            pathsLock.take(TIMEOUT_MAX);
+            stream = nullptr;
+            currentLeg.store(-1, std::memory_order_release);
+            isRunning.store(false, std::memory_order_release);
+            pathsLock.give();
+        }
+        else if(running)
+        {
+            std::size_t nextLeg = 0;
+            bool more = true;
+            while(more)
+            {
+                if(isDisabled())
+                {
+                    logger->info("PathController: Dropping the route because the controller is disabled");
+                }
+                else
+                {
+                    nextLeg = executeRoute(nextLeg, timeUtil.getRate());
+                    //Stop the chassis after the path because:
+                    //(1) the last segment might not have zero velocity
+                    //(2) we might have exited early from being disabled
+                    model->stop();
+                }
+
+                //A leg queued just as the route finished is followed from
+                //rest; queueTarget() holds the lock too, so none is lost
+                pathsLock.take(TIMEOUT_MAX);
+                more = !isDisabled() && nextLeg < route.size();
+                if(!more)
+                {
+                    route.clear();
+                    currentLeg.store(-1, std::memory_order_release);
+                    isRunning.store(false, std::memory_order_release);
+                }
+                pathsLock.give();
+            }
+        }
+
+        rate->delayUntil(10_ms);
+    }
+}
+
+void PathController::generatorTrampoline(void * context)
+{
+    if(context)
+    {
+        static_cast<PathController *>(context)->generatorLoop();
+    }
+}
+
+void PathController::generatorLoop()
+{
+    pros::c::task_set_priority(nullptr, GENERATOR_PRIORITY);
+    auto rate = timeUtil.getRate();
+
+    while(!dtorCalled.load(std::memory_order_acquire))
+    {
+        std::shared_ptr<PathGeneration> generation;
+        pathsLock.take(TIMEOUT_MAX);
+        if(!generationQueue.empty())
+        {
+            generation = generationQueue.front();
+            generationQueue.pop_front();
+            generation->status.store(PathGeneration::Status::generating, std::memory_order_release);
+        }
+        pathsLock.give();
+
+        if(!generation)
+        {
+            rate->delayUntil(10_ms);
+            continue;
+        }
+
+        const std::string &id = generation->pathId;
+        TrajectoryPair path{};
+        std::string error;
+        generationLock.take(TIMEOUT_MAX);
+        try
+        {
+            path = buildPath(generation->points, id);
+        }
+        catch(const std::runtime_error &e)
+        {
+            error = e.what();
+        }
+
+        //The path was replaced or removed while it generated if it is no
+        //longer the pending one; its new owner already failed it
+        pathsLock.take(TIMEOUT_MAX);
+        auto pending = pendingPaths.find(id);
+        if(pending != pendingPaths.end() && pending->second == generation)
+        {
+            pendingPaths.erase(pending);
+            if(error.empty() && !paths.insertCopy(id, path, generation->set).isValid())
+            {
+                error = "Could not store the path";
+            }
+
+            if(error.empty())
+            {
+                generation->status.store(PathGeneration::Status::ready, std::memory_order_release);
+            }
+            else
+            {
+                //Give up the handle reserved for it, unless an older path
+                //is still saved under it
+                if(paths.get(generation->handle) == nullptr)
+                {
+                    paths.remove(generation->handle);
+                }
+                generation->fail(error);
+            }
+        }
+        pathsLock.give();
+        generationPool.reset();
+        generationLock.give();
+    }
+}
+
+std::size_t PathController::executeRoute(std::size_t ifirstLeg, std::unique_ptr<AbstractRate> rate)
+{
+    //The legs being played are pinned, so removing or replacing them
+    //doesn't free the columns until they are let go of
+    std::size_t leg = ifirstLeg;
+    PathPin pin{};
+    std::string pathId;
+    if(!findLeg(leg, pin, pathId))
+    {
+        return leg;
+    }
+    TrajectoryPair path = pin.trajectory;
+    logger->info("PathController: Running with path: " + pathId);
+    currentLeg.store(static_cast<int>(leg), std::memory_order_release);
+
+    const int reversed = direction.load(std::memory_order_acquire);
+    const double period = controlPeriod.load(std::memory_order_relaxed);
+    Tracking tracking = startTracking();
+
+    //The leg after this one, once it is known, and how many of this leg's
+    //last steps also play its first ones
+    std::size_t nextLeg = leg + 1;
+    PathPin nextPin{};
+    TrajectoryPair next{};
+    std::string nextId;
+    bool hasNext = false;
+    int overlap = 0;
+    double slowdown = slowdownStart(path) * path.dt;
+
+    //Play by the clock from when the leg started, so the period can be
+    //anything and a late loop doesn't put the rest of the route behind
+    auto timer = timeUtil.getTimer();
+    double legStart = timer->millis().convert(second);
+    double lastDrive = legStart;
+    while(!isDisabled() && !dtorCalled.load(std::memory_order_acquire))
+    {
+        const double now = timer->millis().convert(second);
+        const double time = now - legStart;
+
+        //Look for the next leg as soon as this one starts slowing down, so
+        //the two can be blended
+        if(time >= slowdown && !hasNext)
+        {
+            hasNext = findLeg(nextLeg, nextPin, nextId);
+            if(hasNext)
+            {
+                next = nextPin.trajectory;
+                //Too late to blend if the overlap would have started already
+                const int blend = blendSteps(path, next);
+                overlap = ((path.length - blend) * path.dt >= time) ? blend : 0;
+            }
+            else
+            {
+                //Check again at the end for a leg queued in the meantime
+                slowdown = path.duration();
+            }
+        }
+
+        const double blendStart = (path.length - overlap) * path.dt;
+        if(time >= path.duration())
+        {
+            if(!hasNext)
+            {
+                unpinLegs(pin, nextPin);
+                return nextLeg;
+            }
+
+            //Continue into the next leg, past the steps already blended
+            unpinLegs(pin, PathPin{});
+            pin = nextPin;
+            nextPin = PathPin{};
+            leg = nextLeg;
+            nextLeg = leg + 1;
+            legStart += blendStart;
+            path = next;
+            pathId = nextId;
+            hasNext = false;
+            slowdown = std::max(slowdownStart(path), overlap) * path.dt;
+            overlap = 0;
+            logger->info("PathController: Running with path: " + pathId);
+            currentLeg.store(static_cast<int>(leg), std::memory_order_release);
+            continue;
+        }
+
+        double left = path.sample(0, time);
+        double right = path.sample(1, time);
+        if(time >= blendStart)
+        {
+            //Legs made with the same acceleration sum to a steady speed
+            left += next.sample(0, time - blendStart);
+            right += next.sample(1, time - blendStart);
+        }
+
+        driveStep(left * reversed, right * reversed, now - lastDrive, tracking);
+        lastDrive = now;
+        rate->delayUntil(((period > 0) ? period : path.dt) * second);
+    }
+    unpinLegs(pin, nextPin);
+    return leg + 1;
+}
+
+void PathController::executeStream(TrajectoryStream &istream, std::unique_ptr<AbstractRate> rate)
+{
+    const int reversed = direction.load(std::memory_order_acquire);
+    Tracking tracking = startTracking();
+    const double dt = istream.getDt();
+
+    //Generate a chunk whenever less than one is left, so the buffer always
+    //holds the next STREAM_CHUNK_STEPS steps and no more than twice that
+    RingBuffer<WheelStep, STREAM_BUFFER_STEPS> buffer;
+    double elapsed = 0;
+    while(!isDisabled() && !dtorCalled.load(std::memory_order_acquire))
+    {
+        if(buffer.size() < static_cast<std::size_t>(STREAM_CHUNK_STEPS))
+        {
+            Segment left;
+            Segment right;
+            for(int i = 0; i < STREAM_CHUNK_STEPS && istream.next(left, right); i++)
+            {
+                buffer.push(WheelStep{static_cast<float>(left.velocity), static_cast<float>(right.velocity)});
+            }
+        }
+
+        WheelStep step;
+        if(buffer.pop(&step, 1) == 0)
+        {
+            break;
+        }
+        driveStep(step.left * reversed, step.right * reversed, elapsed, tracking);
+        elapsed = dt;
+        rate->delayUntil(dt * second);
+    }
+}
+
+PathController::Tracking PathController::startTracking()
+{
+    errorX.store(0, std::memory_order_relaxed);
+    errorY.store(0, std::memory_order_relaxed);
+    errorTheta.store(0, std::memory_order_relaxed);
+
+    Tracking tracking{std::atomic_load(&poseSource), ramseteB.load(std::memory_order_relaxed),
+        ramseteZeta.load(std::memory_order_relaxed), Pose{0, 0, 0}, Pose{0, 0, 0}, 0, 0};
+    if(tracking.source)
+    {
+        tracking.start = tracking.source->getPose();
+    }
+    return tracking;
+}
+
+void PathController::driveStep(double ileft, double iright, double ielapsed, Tracking &tracking)
+{
+    const double halfWidth = scales.wheelbaseWidth.convert(meter) / 2;
+    double left = ileft;
+    double right = iright;
+
+    if(tracking.source)
+    {
+        const Pose &start = tracking.start;
+        Pose &reference = tracking.reference;
+
+        //Advance the reference over the last step, for as long as it really
+        //lasted, along the chord of its arc
+        const double swept = tracking.turnRate * ielapsed;
+        reference.x += tracking.velocity * ielapsed * std::cos(reference.theta + swept / 2);
+        reference.y += tracking.velocity * ielapsed * std::sin(reference.theta + swept / 2);
+        reference.theta += swept;
+
+        const double velocity = (left + right) / 2;
+        const double turnRate = (right - left) / (2 * halfWidth);
+        tracking.velocity = velocity;
+        tracking.turnRate = turnRate;
+
+        //Where the robot is, in the frame it started the route in
+        const Pose pose = tracking.source->getPose();
+        const double dx = pose.x - start.x;
+        const double dy = pose.y - start.y;
+        const double x = dx * std::cos(start.theta) + dy * std::sin(start.theta);
+        const double y = dy * std::cos(start.theta) - dx * std::sin(start.theta);
+        const double theta = pose.theta - start.theta;
+
+        //Error in the robot's frame
+        const double ex = (reference.x - x) * std::cos(theta) + (reference.y - y) * std::sin(theta);
+        const double ey = (reference.y - y) * std::cos(theta) - (reference.x - x) * std::sin(theta);
+        const double etheta = std::remainder(reference.theta - theta, 2 * M_PI);
+        errorX.store(ex, std::memory_order_relaxed);
+        errorY.store(ey, std::memory_order_relaxed);
+        errorTheta.store(etheta, std::memory_order_relaxed);
+
+        //RAMSETE: the gain grows with speed, so the correction stays
+        //gentle near the ends of the path where the robot is slow
+        const double gain = 2 * tracking.zeta * std::sqrt(turnRate * turnRate + tracking.b * velocity * velocity);
+        const double sinc = (std::abs(etheta) < 1e-9) ? 1 : std::sin(etheta) / etheta;
+        const double commandVelocity = velocity * std::cos(etheta) + gain * ex;
+        const double commandTurnRate = turnRate + gain * etheta + tracking.b * velocity * sinc * ey;
+        left = commandVelocity - commandTurnRate * halfWidth;
+        right = commandVelocity + commandTurnRate * halfWidth;
+    }
+
+    const double leftRPM = convertLinearToRotational(left * mps).convert(rpm);
+    const double rightRPM = convertLinearToRotational(right * mps).convert(rpm);
+
+    model->left(leftRPM / toUnderlyingType(pair.internalGearset));
+    model->right(rightRPM / toUnderlyingType(pair.internalGearset));
+}
+
+bool PathController::findLeg(std::size_t &ileg, PathPin &out, std::string &outId)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    for(; ileg < route.size(); ileg++)
+    {
+        const PathPin pin = paths.pin(route[ileg]);
+        if(pin.trajectory.isValid())
+        {
+            out = pin;
+            outId = paths.getName(route[ileg]);
+            pathsLock.give();
+            return true;
+        }
+        logger->warn("PathController: Skipping a leg whose path was removed or never saved");
+    }
+    pathsLock.give();
+    return false;
+}
+
+void PathController::unpinLegs(const PathPin &ipin, const PathPin &inextPin)
+{
+    pathsLock.take(TIMEOUT_MAX);
+    paths.unpin(ipin);
+    paths.unpin(inextPin);
+    pathsLock.give();
+}
+
+int PathController::slowdownStart(const TrajectoryPair &path)
+{
+    //Center speed, which is what the acceleration limit holds on straights
+    auto speed = [&path](int i) { return std::abs(path.velocity[0][i] + path.velocity[1][i]); };
+
+    int start = path.length - 1;
+    while(start > 0 && speed(start - 1) > speed(start))
+    {
+        start--;
+    }
+    return std::max(start, 0);
+}
+
+int PathController::blendSteps(const TrajectoryPair &from, const TrajectoryPair &to)
+{
+    //Steps only line up between legs with the same timestep
+    if(from.dt != to.dt || from.length == 0 || to.length == 0)
+    {
+        return 0;
+    }
+
+    auto speed = [&to](int i) { return std::abs(to.velocity[0][i] + to.velocity[1][i]); };
+    int speedup = 1;
+    while(speedup < to.length && speed(speedup) > speed(speedup - 1))
+    {
+        speedup++;
+    }
+    return std::min(from.length - slowdownStart(from), speedup);
+}
+
+
+PathController::TrajectoryPair PathController::buildPath(const std::vector<Waypoint> &points,
+    const std::string &ipathId)
+{
+    //moveTo()'s paths are thrown away after one use, so caching them would
+    //only fill the card
+    const bool cached = ipathId != MOVE_TO_PATH;
+    const std::uint64_t key = cacheKey(points);
+    TrajectoryPair path;
+    if(!cached || !loadCachedPath(key, path, generationPool))
+    {
+        try
+        {
+            logger->info("PathController: Generating path " + ipathId);
+            path = generateTrajectory(points, maxVel, maxAccel, maxJerk, scales.wheelbaseWidth.convert(meter),
+                arcLengthTolerance, profile, generationPool);
+        }
+        catch(const std::runtime_error &e)
+        {
+            std::string message = "PathController: Could not generate path " + ipathId + ". " + e.what();
+            logger->error(message);
+            throw std::runtime_error(message);
+        }
+        if(cached)
+        {
+            saveCachedPath(key, path);
+        }
+    }
+
+    logger->info("PathController: Path " + ipathId + " is " + std::to_string(path.length) + " segments, " +
+        std::to_string(path.bytes()) + " bytes; generating it took " +
+        std::to_string(generationPool.getUsage().used) + " bytes");
+    return path;
+}
+
+void PathController::startPath(PathHandle ihandle, int idirection)
+{
+    waitForGeneration(ihandle);
+
+    pathsLock.take(TIMEOUT_MAX);
+    const bool running = isRunning.load(std::memory_order_acquire);
+    if(!running)
+    {
+        //The route keeps its capacity, so this doesn't allocate
+        route.assign(1, ihandle);
+        currentPath = ihandle;
+        //An ignored target leaves the direction to the path being followed
+        if(idirection != 0)
+        {
+            direction.store(idirection, std::memory_order_release);
+        }
+        isRunning.store(true, std::memory_order_release);
+    }
+    pathsLock.give();
+
+    logger->info(running ? "PathController: Ignoring target because a path is being followed" :
+        "PathController: Set target");
+}
+
+void PathController::removePathLocked(const std::string &ipathId)
+{
+    cancelPendingLocked(ipathId);
+    paths.remove(ipathId);
+}
+
+void PathController::cancelPendingLocked(const std::string &ipathId)
+{
+    auto pending = pendingPaths.find(ipathId);
+    if(pending != pendingPaths.end())
+    {
+        auto queued = std::find(generationQueue.begin(), generationQueue.end(), pending->second);
+        if(queued != generationQueue.end())
+        {
+            generationQueue.erase(queued);
+        }
+        pending->second->fail("The path was replaced or removed before it was generated");
+        pendingPaths.erase(pending);
+    }
+}
+
+PathController::TrajectoryPair PathController::generateTrajectory(const std::vector<Waypoint> &ipoints,
+    double imaxVel, double imaxAccel, double imaxJerk, double iwheelbaseWidth, double iarcLengthTolerance,
+    PathProfile iprofile)
+{
+    //Only the result outlives the call
+    GenerationPool pool;
+    const TrajectoryPair pooled = generateTrajectory(ipoints, imaxVel, imaxAccel, imaxJerk, iwheelbaseWidth,
+        iarcLengthTolerance, iprofile, pool);
+
+    TrajectoryPair trajectory = TrajectoryPair::allocate(pooled.length, pooled.dt);
+    if(!trajectory.isValid())
+    {
+        throw std::runtime_error("Could not allocate trajectory. " + getPathErrorMessage(ipoints, pooled.length));
+    }
+    std::memcpy(trajectory.column(0), pooled.column(0), pooled.bytes());
+    return trajectory;
+}
+
+PathController::TrajectoryPair PathController::generateTrajectory(const std::vector<Waypoint> &ipoints,
+    double imaxVel, double imaxAccel, double imaxJerk, double iwheelbaseWidth, double iarcLengthTolerance,
+    PathProfile iprofile, GenerationPool &ipool)
+{
+    if(iprofile == PathProfile::wheel)
+    {
+        //Straight into the velocity columns, with no segments in between
+        auto stream = streamTrajectory(ipoints, imaxVel, imaxAccel, iwheelbaseWidth, iarcLengthTolerance, &ipool);
+        const int length = stream->getLength();
+        TrajectoryPair trajectory = TrajectoryPair::allocate(length, static_cast<float>(stream->getDt()), ipool);
+        if(!trajectory.isValid())
+        {
+            throw std::runtime_error("Could not allocate trajectory. " + getPathErrorMessage(ipoints, length));
+        }
+
+        Segment left;
+        Segment right;
+        for(int i = 0; stream->next(left, right); i++)
+        {
+            trajectory.column(0)[i] = left.velocity;
+            trajectory.column(1)[i] = right.velocity;
+        }
+        return trajectory;
+    }
+
+    PoolVector<Segment> left{PoolAllocator<Segment>(&ipool)};
+    PoolVector<Segment> right{PoolAllocator<Segment>(&ipool)};
+    generateCenterSegments(ipoints, imaxVel, imaxAccel, imaxJerk, iwheelbaseWidth, iarcLengthTolerance, &ipool,
+        left, right);
+    const int length = static_cast<int>(left.size());
+
+    TrajectoryPair trajectory = TrajectoryPair::fromSegments({left.data(), right.data()}, length, ipool);
+    if(!trajectory.isValid())
+    {
+        throw std::runtime_error("Could not allocate trajectory. " + getPathErrorMessage(ipoints, length));
+    }
+    return trajectory;
+}
+
+std::vector<PathController::PathResult> PathController::generateTrajectories(
+    const std::vector<PathRequest> &irequests, double iwheelbaseWidth, double iarcLengthTolerance, unsigned ithreads)
+{
+    std::vector<PathResult> results(irequests.size());
+
+    //Each worker takes the next request nobody has started; generation only
+    //touches its own request and result, so the workers share nothing else
+    std::atomic_size_t next{0};
+    auto work = [&]() {
+        //Each worker reuses one pool for all of its paths, copying out only
+        //the results
+        GenerationPool pool;
+        for(std::size_t i = next++; i < irequests.size(); i = next++)
+        {
+            const PathRequest &request = irequests[i];
+            try
+            {
+                const TrajectoryPair pooled = generateTrajectory(request.points, request.maxVel, request.maxAccel,
+                    request.maxJerk, iwheelbaseWidth, iarcLengthTolerance, request.profile, pool);
+                TrajectoryPair trajectory = TrajectoryPair::allocate(pooled.length, pooled.dt);
+                if(!trajectory.isValid())
+                {
+                    throw std::runtime_error("Could not allocate trajectory. " +
+                        getPathErrorMessage(request.points, pooled.length));
+                }
+                std::memcpy(trajectory.column(0), pooled.column(0), pooled.bytes());
+                results[i].trajectory = trajectory;
+            }
+            catch(const std::runtime_error &e)
+            {
+                results[i].error = e.what();
+            }
+            pool.reset();
+        }
+    };
+
+#ifdef THREADS_STD
+    if(ithreads == 0)
+    {
+        ithreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    ithreads = static_cast<unsigned>(std::min<std::size_t>(ithreads, irequests.size()));
+
+    //The calling thread is one of the workers
+    std::vector<std::thread> workers;
+    for(unsigned i = 1; i < ithreads; i++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for(std::thread &worker : workers)
+    {
+        worker.join();
+    }
+#else
+    work();
+#endif
+
+    return results;
+}
+
+PathController::SegmentPair PathController::generateSegments(const std::vector<Waypoint> &ipoints,
+    double imaxVel, double imaxAccel, double imaxJerk, double iwheelbaseWidth, double iarcLengthTolerance,
+    PathProfile iprofile)
+{
+    SegmentPair segments;
+    if(iprofile == PathProfile::wheel)
+    {
+        auto stream = streamTrajectory(ipoints, imaxVel, imaxAccel, iwheelbaseWidth, iarcLengthTolerance);
+        try
+        {
+            segments.left.resize(stream->getLength());
+            segments.right.resize(stream->getLength());
+        }
+        catch(const std::bad_alloc &)
+        {
+            throw std::runtime_error("Could not allocate trajectory. " +
+                getPathErrorMessage(ipoints, stream->getLength()));
+        }
+
+        for(int i = 0; stream->next(segments.left[i], segments.right[i]); i++)
+        {
+        }
+        return segments;
+    }
+
+    GenerationPool pool;
+    PoolVector<Segment> left{PoolAllocator<Segment>(&pool)};
+    PoolVector<Segment> right{PoolAllocator<Segment>(&pool)};
+    generateCenterSegments(ipoints, imaxVel, imaxAccel, imaxJerk, iwheelbaseWidth, iarcLengthTolerance, &pool,
+        left, right);
+    try
+    {
+        segments.left.assign(left.begin(), left.end());
+        segments.right.assign(right.begin(), right.end());
+    }
+    catch(const std::bad_alloc &)
+    {
+        throw std::runtime_error("Could not allocate trajectory. " +
+            getPathErrorMessage(ipoints, static_cast<int>(left.size())));
+    }
+    return segments;
+}
+
+void PathController::generateCenterSegments(const std::vector<Waypoint> &ipoints, double imaxVel,
+    double imaxAccel, double imaxJerk, double iwheelbaseWidth, double iarcLengthTolerance, GenerationPool * ipool,
+    PoolVector<Segment> &outLeft, PoolVector<Segment> &outRight)
+{
+    double totalLength = 0;
+    PoolVector<Spline> splines = fitSplines(ipoints, iarcLengthTolerance, totalLength, ipool);
+
+    TrajectoryConfig config = {0.010, imaxVel, imaxAccel, imaxJerk, 0, ipoints.front().angle, totalLength, 0,
+        ipoints.front().angle, 0};
+    TrajectoryInfo info = pf_trajectory_prepare(config);
+
+    const int length = info.length;
+    if(length < 0)
+    {
+        throw std::runtime_error("Length was negative. " + getPathErrorMessage(ipoints, length));
+    }
+
+    PoolVector<Segment> trajectory{PoolAllocator<Segment>(ipool)};
+    try
+    {
+        trajectory.resize(length);
+        outLeft.resize(length);
+        outRight.resize(length);
+    }
+    catch(const std::bad_alloc &)
+    {
+        throw std::runtime_error("Could not allocate trajectory. " + getPathErrorMessage(ipoints, length));
+    }
+    if(pf_trajectory_create(info, config, trajectory.data()) < 0)
+    {
+        throw std::runtime_error("Could not create trajectory. " + getPathErrorMessage(ipoints, length));
+    }
+
+    //Place each segment on the splines, as pathfinder_generate() does
+    SplineCursor cursor(splines, iarcLengthTolerance);
+    for(Segment &segment : trajectory)
+    {
+        cursor.place(segment);
+    }
+
+    pathfinder_modify_tank(trajectory.data(), length, outLeft.data(), outRight.data(), iwheelbaseWidth);
+}
+
+std::unique_ptr<TrajectoryStream> PathController::streamTrajectory(const std::vector<Waypoint> &ipoints,
+    double imaxVel, double imaxAccel, double iwheelbaseWidth, double iarcLengthTolerance, GenerationPool * ipool)
+{
+    double totalLength = 0;
+    PoolVector<Spline> splines = fitSplines(ipoints, iarcLengthTolerance, totalLength, ipool);
+    if(!(totalLength > 0))
+    {
+        throw std::runtime_error("The path has no length. " + getPathErrorMessage(ipoints, 0));
+    }
+
+    try
+    {
+        return std::unique_ptr<TrajectoryStream>(new TrajectoryStream(std::move(splines), imaxVel, imaxAccel,
+            iwheelbaseWidth, iarcLengthTolerance, 0.010));
+    }
+    catch(const std::bad_alloc &)
+    {
+        throw std::runtime_error("Could not allocate trajectory. " + getPathErrorMessage(ipoints, 0));
+    }
+}
+
+PoolVector<Spline> PathController::fitSplines(const std::vector<Waypoint> &ipoints, double iarcLengthTolerance,
+    double &totalLength, GenerationPool * ipool)
+{
+    if(ipoints.size() < 2)
+    {
+        throw std::runtime_error("Too few waypoints. " + getPathErrorMessage(ipoints, 0));
+    }
+
+    //Fit a spline between each pair of waypoints and measure it, as
+    //pathfinder_prepare() does but to a tolerance instead of a sample count
+    PoolVector<Spline> splines(ipoints.size() - 1, Spline{}, PoolAllocator<Spline>(ipool));
+    totalLength = 0;
+    for(std::size_t i = 0; i < splines.size(); i++)
+    {
+        pf_fit_hermite_cubic(ipoints[i], ipoints[i + 1], &splines[i]);
+        totalLength += splineDistance(splines[i], iarcLengthTolerance);
+    }
+    return splines;
+}
+
+std::uint64_t PathController::cacheKey(const std::vector<Waypoint> &points) const
+{
+    //FNV-1a over every input that changes the generated segments
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](double value) {
+        unsigned char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(double));
+        for(unsigned char byte : bytes)
+        {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    for(const Waypoint &point : points)
+    {
+        mix(point.x);
+        mix(point.y);
+        mix(point.angle);
+    }
+    mix(maxVel);
+    mix(maxAccel);
+    mix(maxJerk);
+    mix(scales.straight);
+    mix(scales.turn);
+    mix(scales.wheelDiameter.convert(meter));
+    mix(scales.wheelbaseWidth.convert(meter));
+    mix(arcLengthTolerance);
+    mix(static_cast<double>(profile));
+    return hash;
+}
+
+std::string PathController::cacheFile(std::uint64_t key) const
+{
+    //8.3 names, which every SD card file system supports
+    char name[16];
+    std::snprintf(name, sizeof(name), "%08" PRIx32 ".pth", static_cast<std::uint32_t>(key ^ (key >> 32)));
+    return cacheDirectory + "/" + name;
+}
+
+bool PathController::loadCachedPath(std::uint64_t key, TrajectoryPair &out, GenerationPool &ipool) const
+{
+    if(cacheDirectory.empty())
+    {
+        return false;
+    }
+
+    std::FILE * file = std::fopen(cacheFile(key).c_str(), "rb");
+    if(file == nullptr)
+    {
+        return false;
+    }
+
+    //The file name holds only half the key, so check all of it
+    CacheHeader header;
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "PATH", 4) == 0 &&
+        header.version == CACHE_VERSION && header.key == key && header.length > 0;
+
+    TrajectoryPair path{};
+    if(valid)
+    {
+        //The columns are contiguous, so they are read in one go
+        path = TrajectoryPair::allocate(header.length, header.dt, ipool);
+        valid = path.isValid() && std::fread(path.column(0), sizeof(float), 2 * header.length, file) ==
+            2 * static_cast<std::size_t>(header.length);
+    }
+    std::fclose(file);
+
+    if(!valid)
+    {
+        logger->warn("PathController: Ignoring invalid cache file " + cacheFile(key));
+        return false;
+    }
+
+    logger->info("PathController: Loaded path from " + cacheFile(key));
+    out = path;
+    return true;
+}
+
+void PathController::saveCachedPath(std::uint64_t key, const TrajectoryPair &path) const
+{
+    if(cacheDirectory.empty())
+    {
+        return;
+    }
+
+    std::FILE * file = std::fopen(cacheFile(key).c_str(), "wb");
+    if(file == nullptr)
+    {
+        logger->warn("PathController: Could not open cache file " + cacheFile(key));
+        return;
+    }
+
+    CacheHeader header = {{'P', 'A', 'T', 'H'}, CACHE_VERSION, key, path.length, path.dt};
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(path.velocity[0], sizeof(float), path.length, file) == static_cast<std::size_t>(path.length) &&
+        std::fwrite(path.velocity[1], sizeof(float), path.length, file) == static_cast<std::size_t>(path.length);
+    std::fclose(file);
+
+    if(!written)
+    {
+        //A partial file fails validation, so it is regenerated next time
+        logger->warn("PathController: Could not write cache file " + cacheFile(key));
+    }
+}
+
+QAngularSpeed PathController::convertLinearToRotational(QSpeed linear) const
+{
+    return (linear * (360_deg / (scales.wheelDiameter * 1_pi))) * pair.ratio;
+}
+
+Waypoint PathController::toWaypoint(const Point &ipoint)
+{
+    return Waypoint{ipoint.x.convert(meter), ipoint.y.convert(meter), ipoint.theta.convert(radian)};
+}
+
+Waypoint PathController::toWaypoint(const Waypoint &ipoint)
+{
+    return ipoint;
+}
+
+std::string PathController::getPathErrorMessage(const std::vector<Waypoint> &points, int length)
+{
+    auto pointToString = [](Waypoint point) {
+        return "PathfinderPoint{x=" + std::to_string(point.x) + ", y=" + std::to_string(point.y) +
+            ", theta=" + std::to_string(point.angle) + "}";
+    };
+
+    std::string message = "The path is impossible with waypoints: ";
+    for(const Waypoint &point : points)
+    {
+        message += pointToString(point) + ", ";
+    }
+    return message + "length: " + std::to_string(length);
+}
+
+//----------------------------------------------------------------------------//
+//                           Path Controller Factory                          //
+//----------------------------------------------------------------------------//
+
+std::shared_ptr<PathController> PathControllerFactory::create(double imaxVel, double imaxAccel, double imaxJerk,
+    const ChassisController &ichassis)
+{
+    auto controller = std::make_shared<PathController>(TimeUtilFactory::create(), imaxVel, imaxAccel, imaxJerk,
+        ichassis.getChassisModel(), ichassis.getChassisScales(), ichassis.getGearsetRatioPair());
+    controller->startThread();
+    return controller;
+}
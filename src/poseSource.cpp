@@ -0,0 +1,48 @@
+#include "main.h"
+#include "poseSource.hpp"
+#include <cmath>
+
+//----------------------------------------------------------------------------//
+//                              Encoder Odometry                              //
+//----------------------------------------------------------------------------//
+
+EncoderOdometry::EncoderOdometry(const std::shared_ptr<ChassisModel> &imodel, const ChassisScales &iscales,
+    double iratio)
+    : model(imodel), ticksPerMeter(iscales.straight * iratio), wheelbaseWidth(iscales.wheelbaseWidth.convert(meter))
+{
+    auto ticks = model->getSensorVals();
+    lastLeft = ticks[0];
+    lastRight = ticks[1];
+}
+
+Pose EncoderOdometry::getPose()
+{
+    //The drive encoders count degrees, which is what ChassisScales::straight
+    //is in
+    auto ticks = model->getSensorVals();
+
+    lock.take(TIMEOUT_MAX);
+    const double left = (ticks[0] - lastLeft) / ticksPerMeter;
+    const double right = (ticks[1] - lastRight) / ticksPerMeter;
+    lastLeft = ticks[0];
+    lastRight = ticks[1];
+
+    //Move along the chord of the arc the wheels drove, at the heading
+    //halfway through it
+    const double distance = (left + right) / 2;
+    const double turn = (right - left) / wheelbaseWidth;
+    pose.x += distance * std::cos(pose.theta + turn / 2);
+    pose.y += distance * std::sin(pose.theta + turn / 2);
+    pose.theta += turn;
+    Pose current = pose;
+    lock.give();
+
+    return current;
+}
+
+void EncoderOdometry::setPose(const Pose &ipose)
+{
+    lock.take(TIMEOUT_MAX);
+    pose = ipose;
+    lock.give();
+}
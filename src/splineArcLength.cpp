@@ -0,0 +1,124 @@
+#include "main.h"
+#include "splineArcLength.hpp"
+#include <cmath>
+
+//----------------------------------------------------------------------------//
+//                             Spline Arc Length                              //
+//----------------------------------------------------------------------------//
+
+namespace
+{
+    //Deepest an interval is subdivided; 2^-24 of a spline is far below any
+    //tolerance that matters
+    const int MAX_DEPTH = 24;
+    //Newton steps allowed when inverting arc length; it converges in 2-4
+    const int MAX_NEWTON_STEPS = 30;
+
+    /**
+     * speed along a spline: d(arc length)/d(progress)
+     */
+    double splineSpeed(const Spline &spline, double progress)
+    {
+        double slope = pf_spline_deriv_2(spline.a, spline.b, spline.c, spline.d, spline.e, spline.knot_distance,
+            progress);
+        return spline.knot_distance * std::sqrt(1 + slope * slope);
+    }
+
+    /**
+     * integrates speed over [from, to] given Simpson's estimate over the
+     * whole interval, splitting it until both halves agree with it
+     */
+    double adaptiveSimpson(const Spline &spline, double from, double to, double fromSpeed, double midSpeed,
+        double toSpeed, double whole, double tolerance, int depth)
+    {
+        double mid = (from + to) / 2;
+        double leftSpeed = splineSpeed(spline, (from + mid) / 2);
+        double rightSpeed = splineSpeed(spline, (mid + to) / 2);
+        double left = (mid - from) / 6 * (fromSpeed + 4 * leftSpeed + midSpeed);
+        double right = (to - mid) / 6 * (midSpeed + 4 * rightSpeed + toSpeed);
+        double difference = left + right - whole;
+
+        //Simpson's error falls 16x per halving, so |difference| / 15 bounds
+        //the error of the halves and adding it back corrects most of it
+        if(depth >= MAX_DEPTH || std::abs(difference) <= 15 * tolerance)
+        {
+            return left + right + difference / 15;
+        }
+        return adaptiveSimpson(spline, from, mid, fromSpeed, leftSpeed, midSpeed, left, tolerance / 2, depth + 1) +
+            adaptiveSimpson(spline, mid, to, midSpeed, rightSpeed, toSpeed, right, tolerance / 2, depth + 1);
+    }
+}
+
+double splineArcLength(const Spline &spline, double fromProgress, double toProgress, double tolerance)
+{
+    if(toProgress <= fromProgress)
+    {
+        return 0;
+    }
+
+    double fromSpeed = splineSpeed(spline, fromProgress);
+    double midSpeed = splineSpeed(spline, (fromProgress + toProgress) / 2);
+    double toSpeed = splineSpeed(spline, toProgress);
+    double whole = (toProgress - fromProgress) / 6 * (fromSpeed + 4 * midSpeed + toSpeed);
+    return adaptiveSimpson(spline, fromProgress, toProgress, fromSpeed, midSpeed, toSpeed, whole, tolerance, 0);
+}
+
+double splineDistance(Spline &spline, double tolerance)
+{
+    spline.arc_length = splineArcLength(spline, 0, 1, tolerance);
+    return spline.arc_length;
+}
+
+double splineCurvature(const Spline &spline, double progress)
+{
+    //y(x) in the spline's frame; rotating into the field frame keeps
+    //curvature the same
+    const double x = progress * spline.knot_distance;
+    const double slope = pf_spline_deriv_2(spline.a, spline.b, spline.c, spline.d, spline.e, spline.knot_distance,
+        progress);
+    const double bend = ((20 * spline.a * x + 12 * spline.b) * x + 6 * spline.c) * x + 2 * spline.d;
+    return bend / std::pow(1 + slope * slope, 1.5);
+}
+
+double splineProgressForDistance(const Spline &spline, double distance, double tolerance, double fromProgress,
+    double fromDistance)
+{
+    if(distance <= fromDistance)
+    {
+        return fromProgress;
+    }
+
+    //Arc length only grows with progress (speed >= knot_distance > 0), so
+    //Newton's method converges; the bracket catches any step that overshoots
+    double low = fromProgress;
+    double high = 1;
+    double progress = fromProgress + (distance - fromDistance) / splineSpeed(spline, fromProgress);
+    for(int i = 0; i < MAX_NEWTON_STEPS; i++)
+    {
+        if(progress <= low || progress >= high)
+        {
+            progress = (low + high) / 2;
+        }
+
+        //Measure from the nearest point known to be before the target
+        double error = fromDistance + splineArcLength(spline, fromProgress, progress, tolerance / 2) - distance;
+        if(std::abs(error) <= tolerance)
+        {
+            break;
+        }
+
+        if(error < 0)
+        {
+            //Short of the target; measure the rest from here
+            low = progress;
+            fromProgress = progress;
+            fromDistance = distance + error;
+        }
+        else
+        {
+            high = progress;
+        }
+        progress -= error / splineSpeed(spline, progress);
+    }
+    return (progress < 0) ? 0 : (progress > 1) ? 1 : progress;
+}
@@ -28,6 +28,275 @@ double expCurve(double input, double power, double maxValue)
     return maxValue * std::copysign(std::pow(std::abs(input) / std::abs(maxValue), power), input);
 }
 
+//----------------------------------------------------------------------------//
+//                                   Sensors                                  //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+Seqlock<SensorSnapshot> sensorSnapshot;
+//Smart ports in SensedMotor order
+const std::uint8_t SENSED_MOTOR_PORTS[NUM_SENSED_MOTORS] = {10, 3, 1, 2, 20, 9, 7, 8};
+
+//--------- Functions --------//
+
+SensorSnapshot sampleSensors()
+{
+    SensorSnapshot sensors;
+    sensors.timestamp = pros::millis();
+    for(int i = 0; i < NUM_SENSED_MOTORS; i++)
+    {
+        std::uint8_t port = SENSED_MOTOR_PORTS[i];
+        sensors.motors[i].position = pros::c::motor_get_position(port);
+        sensors.motors[i].targetPosition = pros::c::motor_get_target_position(port);
+        sensors.motors[i].velocity = pros::c::motor_get_actual_velocity(port);
+        sensors.motors[i].current = pros::c::motor_get_current_draw(port);
+        sensors.motors[i].temperature = pros::c::motor_get_temperature(port);
+    }
+    return sensors;
+}
+
+SensorSnapshot getSensorSnapshot()
+{
+    if(!sensorSnapshot.hasValue())
+    {
+        return sampleSensors();
+    }
+    return sensorSnapshot.read();
+}
+
+void sensorHandler(void * param)
+{
+    std::uint32_t now = pros::millis();
+    while(true)
+    {
+        sensorSnapshot.write(sampleSensors());
+        pros::Task::delay_until(&now, REFRESH_MS);
+    }
+}
+
+//----------------------------------------------------------------------------//
+//                              Controller Input                              //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+Seqlock<ControllerSnapshot> controllerSnapshot;
+
+//Bit of a button in ControllerSnapshot's button masks
+static int buttonIndex(ControllerDigital button)
+{
+    return static_cast<int>(button) - static_cast<int>(ControllerDigital::L1);
+}
+
+ControllerReader::ControllerReader()
+{
+    if(controllerSnapshot.hasValue())
+    {
+        latest = controllerSnapshot.read();
+        std::copy(std::begin(latest.presses), std::end(latest.presses), lastPresses);
+        std::copy(std::begin(latest.releases), std::end(latest.releases), lastReleases);
+    }
+}
+
+void ControllerReader::update()
+{
+    latest = controllerSnapshot.read();
+
+    newPresses = 0;
+    newReleases = 0;
+    for(int i = 0; i < NUM_CONTROLLER_BUTTONS; i++)
+    {
+        if(latest.presses[i] != lastPresses[i])
+        {
+            newPresses |= 1 << i;
+        }
+        if(latest.releases[i] != lastReleases[i])
+        {
+            newReleases |= 1 << i;
+        }
+        lastPresses[i] = latest.presses[i];
+        lastReleases[i] = latest.releases[i];
+    }
+}
+
+double ControllerReader::getAnalog(ControllerAnalog axis) const
+{
+    return latest.analog[static_cast<int>(axis)];
+}
+
+bool ControllerReader::isPressed(ControllerDigital button) const
+{
+    return latest.held & (1 << buttonIndex(button));
+}
+
+bool ControllerReader::isNewPress(ControllerDigital button) const
+{
+    return newPresses & (1 << buttonIndex(button));
+}
+
+bool ControllerReader::isNewRelease(ControllerDigital button) const
+{
+    return newReleases & (1 << buttonIndex(button));
+}
+
+std::uint32_t ControllerReader::getTimestamp() const
+{
+    return latest.timestamp;
+}
+
+//--------- Functions --------//
+
+ControllerSnapshot sampleController(const ControllerSnapshot &last)
+{
+    ControllerSnapshot input = last;
+    input.timestamp = pros::millis();
+    for(int i = 0; i < NUM_CONTROLLER_AXES; i++)
+    {
+        input.analog[i] = masterController.getAnalog(static_cast<ControllerAnalog>(i));
+    }
+
+    input.held = 0;
+    for(int i = 0; i < NUM_CONTROLLER_BUTTONS; i++)
+    {
+        ControllerDigital button = static_cast<ControllerDigital>(static_cast<int>(ControllerDigital::L1) + i);
+        if(masterController.getDigital(button))
+        {
+            input.held |= 1 << i;
+        }
+    }
+
+    input.risen = input.held & ~last.held;
+    input.fallen = last.held & ~input.held;
+    for(int i = 0; i < NUM_CONTROLLER_BUTTONS; i++)
+    {
+        input.presses[i] += (input.risen >> i) & 1;
+        input.releases[i] += (input.fallen >> i) & 1;
+    }
+    return input;
+}
+
+void controllerHandler(void * param)
+{
+    ControllerSnapshot input{};
+    std::uint32_t now = pros::millis();
+    while(true)
+    {
+        input = sampleController(input);
+        controllerSnapshot.write(input);
+        pros::Task::delay_until(&now, REFRESH_MS);
+    }
+}
+
+//----------------------------------------------------------------------------//
+//                                  Telemetry                                 //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+TelemetryLog controlTelemetry;
+TelemetryLog puncherTelemetry;
+const char * telemetryFile = "/usd/telemetry.bin";
+static_assert(sizeof(TelemetryRecord) == 20, "Telemetry file layout changed");
+
+void TelemetryLog::log(TelemetryChannel channel, float a, float b, float c)
+{
+    TelemetryRecord record = {pros::millis(), channel, dropped, {a, b, c}};
+    if(records.push(record))
+    {
+        dropped = 0;
+    }
+    else if(dropped < UINT16_MAX)
+    {
+        dropped++;
+    }
+}
+
+std::size_t TelemetryLog::drain(TelemetryRecord * out, std::size_t maxCount)
+{
+    return records.pop(out, maxCount);
+}
+
+//--------- Functions --------//
+
+void telemetryHandler(void * param)
+{
+    std::FILE * sink = std::fopen(telemetryFile, "wb");
+    if(sink == nullptr)
+    {
+        sink = stdout;
+    }
+
+    TelemetryLog * logs[] = {&controlTelemetry, &puncherTelemetry};
+    TelemetryRecord batch[32];
+    std::uint32_t now = pros::millis();
+    while(true)
+    {
+        for(TelemetryLog * log : logs)
+        {
+            std::size_t count;
+            while((count = log->drain(batch, 32)) > 0)
+            {
+                std::fwrite(batch, sizeof(TelemetryRecord), count, sink);
+            }
+        }
+        std::fflush(sink);
+        pros::Task::delay_until(&now, TELEMETRY_PERIOD_MS);
+    }
+}
+
+//----------------------------------------------------------------------------//
+//                                  Profiling                                 //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+LoopProfiler opcontrolProfiler;
+LoopProfiler puncherProfiler;
+
+void LoopProfiler::enable(Clock icostClock, Clock iperiodClock)
+{
+    costClock = icostClock;
+    periodClock = iperiodClock;
+}
+
+void LoopProfiler::beginIteration()
+{
+    if(costClock == nullptr)
+    {
+        return;
+    }
+    current = LoopSample{};
+    current.start = periodClock();
+    lastMark = costClock();
+}
+
+void LoopProfiler::endSection(LoopSection section)
+{
+    if(costClock == nullptr)
+    {
+        return;
+    }
+    std::uint64_t now = costClock();
+    current.sections[section] += now - lastMark;
+    lastMark = now;
+}
+
+void LoopProfiler::endIteration()
+{
+    if(costClock == nullptr)
+    {
+        return;
+    }
+    //A full buffer means nobody is draining; drop the sample
+    samples.push(current);
+}
+
+std::size_t LoopProfiler::drain(LoopSample * out, std::size_t maxCount)
+{
+    return samples.pop(out, maxCount);
+}
+
 //----------------------------------------------------------------------------//
 //                                 Drivetrain                                 //
 //----------------------------------------------------------------------------//
@@ -50,18 +319,30 @@ ChassisControllerPID drivetrain = ChassisControllerFactory::create(
     //Wheel diameter, wheelbase width
     {4.1_in, 12.5_in}
 );
+//Limits of paths generated at runtime: m/s, m/s/s, m/s/s/s
+std::shared_ptr<PathController> drivetrainPaths = PathControllerFactory::create(1.0, 2.0, 10.0, drivetrain);
 bool slewEnabled = true;
 //Slew rates in units [-127, 127] per loop iteration
 double slewRate_y = 7;
 double slewRate_r = 7;
 //Variables for tracking change in y and r
-double d_y = 0;
-double d_r = 0;
 double y_last = 0;
 double r_last = 0;
 
 //--------- Functions --------//
 
+double slewLimit(double target, double last, double rate)
+{
+    double delta = target - last;
+
+    //If the value changed by more than the slew rate...
+    if(std::abs(delta) > rate)
+    {
+        return (delta < 0) ? last - rate : last + rate;
+    }
+    return target;
+}
+
 void driveRPM(double y, double r, bool preserveProportion)
 {
     //Scale down from 200 to 1
@@ -87,19 +368,8 @@ void driveVoltage(double y, double r, bool preserveProportion)
     //Slew control
     if(slewEnabled)
     {
-        d_y = y - y_last;
-        d_r = r - r_last;
-
-        //If y changed by more than the slew rate...
-        if(std::abs(d_y) > slewRate_y)
-        {
-            y = (d_y < 0) ? y_last - slewRate_y : y_last + slewRate_y;
-        }
-        //If r changed by more than the slew rate...
-        if(std::abs(d_r) > slewRate_r)
-        {
-            r = (d_r < 0) ? r_last - slewRate_r : r_last + slewRate_r;
-        }
+        y = slewLimit(y, y_last, slewRate_y);
+        r = slewLimit(r, r_last, slewRate_r);
 
         y_last = y;
         r_last = r;
@@ -121,6 +391,7 @@ void driveVoltage(double y, double r, bool preserveProportion)
     }
 
     drivetrain.arcade(y, r);
+    controlTelemetry.log(TELEMETRY_DRIVE, y, r);
 }
 
 //----------------------------------------------------------------------------//
@@ -164,15 +435,20 @@ Motor capLiftMotor(20, false, AbstractMotor::gearset::red);
 
 //--------- Functions --------//
 
+double getCapLiftPos(const SensorSnapshot &sensors)
+{
+    return sensors.motors[CAP_LIFT].position * 3.0 / 5.0;
+}
+
 double getCapLiftPos()
 {
-    return capLiftMotor.getPosition() * 3.0 / 5.0;
+    return getCapLiftPos(getSensorSnapshot());
 }
 
 bool capLiftInterfering()
 {
     double capLiftPos = getCapLiftPos();
-    return capLiftPos > PuncherAngles::CURRENT->getLowerInterferenceBound() || PuncherAngles::CURRENT->getUpperInterferenceBound();
+    return capLiftPos > PuncherAngles::CURRENT->getLowerInterferenceBound() && capLiftPos < PuncherAngles::CURRENT->getUpperInterferenceBound();
 }
 
 void unobstructCapLift()
@@ -212,6 +488,13 @@ Motor angleAdjuster(7, false, AbstractMotor::gearset::red);
 
 //---------- Globals ---------//
 
+//The motors are globals, so the controller shares them without owning them.
+//Limits at the motor shaft: degrees/s, degrees/s/s
+std::shared_ptr<SyncedProfileController<2>> aimingProfiles = SyncedProfileControllerFactory::create<2>(
+    {std::shared_ptr<AbstractMotor>(std::shared_ptr<AbstractMotor>(), &angleAdjuster),
+        std::shared_ptr<AbstractMotor>(std::shared_ptr<AbstractMotor>(), &capLiftMotor)},
+    {{{300, 1500}, {360, 1500}}});
+
 int numLaunches = 0;
 bool puncherReady = false;
 
@@ -239,9 +522,11 @@ void waitForPuncherReady()
 {
     SettledUtil puncherSettledUtil = SettledUtilFactory::create(3, 5, 30_ms);
 
-    while(!puncherSettledUtil.isSettled(puncher.getTargetPosition() - puncher.getPosition()))
+    SensorSnapshot sensors = getSensorSnapshot();
+    while(!puncherSettledUtil.isSettled(sensors.motors[PUNCHER].targetPosition - sensors.motors[PUNCHER].position))
     {
         pros::delay(REFRESH_MS);
+        sensors = getSensorSnapshot();
     }
     return;
 }
@@ -291,7 +576,7 @@ void setPuncherAngle(PuncherAngle &pAngle, int speed, bool blocking)
     {
         //Wait for angle adjuster to be done
         auto angleSettledUtil = SettledUtilFactory::create(3, 5, 30_ms);
-        while(!angleSettledUtil.isSettled(pAngle.getAngleValue() - angleAdjuster.getPosition()))
+        while(!angleSettledUtil.isSettled(pAngle.getAngleValue() - getSensorSnapshot().motors[ANGLE_ADJUSTER].position))
         {
             pros::delay(REFRESH_MS);
         }
@@ -299,84 +584,302 @@ void setPuncherAngle(PuncherAngle &pAngle, int speed, bool blocking)
     return;
 }
 
-void doubleShot(PuncherAngle &firstAngle, PuncherAngle &secondAngle)
+bool aimAndClearCapLift(PuncherAngle &pAngle, bool blocking)
 {
-    //Set puncher to high flag
-    setPuncherAngle(firstAngle, 50, true);
+    //A new aim replaces one still under way, which would ignore it
+    if(!aimingProfiles->isSettled())
+    {
+        aimingProfiles->reset();
+    }
+
+    //Leave the cap lift to whatever drives it unless it is in the way, in
+    //which case send it past the nearer bound, as unobstructCapLift() does
+    double capLiftPos = getCapLiftPos();
+    bool clearing = capLiftPos > pAngle.getLowerInterferenceBound() && capLiftPos < pAngle.getUpperInterferenceBound();
+    double capLiftTarget = 0;
+    if(clearing)
+    {
+        double middle = (pAngle.getUpperInterferenceBound() + pAngle.getLowerInterferenceBound()) / 2.0;
+        capLiftTarget = (capLiftPos < middle) ? pAngle.getLowerInterferenceBound() - CAPLIFT_CLEARANCE :
+            pAngle.getUpperInterferenceBound() + CAPLIFT_CLEARANCE;
+    }
 
-    //Launch and wait for completion
-    launch(true);
+    //Cap lift angles are at the lift; the motor turns 5/3 as far. Another
+    //task could still start a move first, so only a move that was taken
+    //changes the current angle.
+    if(!aimingProfiles->setTarget({pAngle.getAngleValue(), capLiftTarget * 5.0 / 3.0}, {true, clearing}))
+    {
+        return false;
+    }
+    PuncherAngles::CURRENT = &pAngle;
 
-    //Once first launch is complete, load second ball, initiate launch,
-    //and wait for angle to be set to low flag
-    setIntake(200);
-    launch(false);
-    setPuncherAngle(secondAngle, 50, true);
+    pros::lcd::clear_line(3);
+    pros::lcd::print(3, "PAngle: %f, LIB: %f, UIB: %f", pAngle.getAngleValue(), pAngle.getLowerInterferenceBound(),
+        pAngle.getUpperInterferenceBound());
 
-    //Wait for launch to complete and stop intake
-    waitForPuncherReady();
-    setIntake(0);
+    if(blocking)
+    {
+        aimingProfiles->waitUntilSettled();
+    }
+    return clearing;
 }
 
 void puncherHandler(void * param)
 {
-    //Button booleans
-	bool launchButtonPressed = false;
-	bool launchButtonLastPressed = false;
-	bool togglePuncherAnglePressed = false;
-	bool togglePuncherAngleLastPressed = false;
+	ControllerReader input;
 
 	//0 = Low Flag, 1 = High Flag
 	bool puncherAngleLowHigh = 0;
 
     while(true)
     {
+        puncherProfiler.beginIteration();
+        input.update();
+        puncherProfiler.endSection(SECTION_INPUT);
+
         //--------------------------------------------------------------------//
 		//                               Puncher                              //
 		//--------------------------------------------------------------------//
 
 		//Puncher launch = Button Y
-		launchButtonPressed = masterController.getDigital(ControllerDigital::Y);
-		//If new press...
-		if(launchButtonPressed && !launchButtonLastPressed)
+		if(input.isNewPress(ControllerDigital::Y))
 		{
-			if(puncherReady)
-			{
-				//Initiate launch
-				launch(true);
-			}
+			//Initiate launch
+			puncherStateMachine.requestLaunch();
 		}
-		launchButtonLastPressed = launchButtonPressed;
 
 		//Angle adjuster toggle = Button X
-		togglePuncherAnglePressed = masterController.getDigital(ControllerDigital::X);
-		//If new press...
-		if(togglePuncherAnglePressed && !togglePuncherAngleLastPressed)
+		if(input.isNewPress(ControllerDigital::X))
 		{
 			puncherAngleLowHigh = !puncherAngleLowHigh;
 			
 			//Set new puncher angle
 			if(puncherAngleLowHigh == 0)
 			{
-				setPuncherAngle(PuncherAngles::NEAR_HIGH_FLAG);
+				puncherStateMachine.requestAngle(PuncherAngles::NEAR_HIGH_FLAG);
 			}
 			else
 			{
-				setPuncherAngle(PuncherAngles::NEAR_LOW_FLAG);
+				puncherStateMachine.requestAngle(PuncherAngles::NEAR_LOW_FLAG);
 			}
 		}
-		togglePuncherAngleLastPressed = togglePuncherAnglePressed;
 		
-		//Double shot macro
-		if(masterController.getDigital(ControllerDigital::B))
+		//Double shot macro = Button B
+		if(input.isNewPress(ControllerDigital::B))
 		{
-			doubleShot(PuncherAngles::NEAR_HIGH_FLAG, PuncherAngles::NEAR_LOW_FLAG);
+			puncherStateMachine.requestDoubleShot(PuncherAngles::NEAR_HIGH_FLAG, PuncherAngles::NEAR_LOW_FLAG);
 		}
 
+		//Advance whichever macro is running
+		SensorSnapshot sensors = getSensorSnapshot();
+		puncherStateMachine.update(sensors);
+		puncherTelemetry.log(TELEMETRY_PUNCHER, sensors.motors[PUNCHER].targetPosition,
+			sensors.motors[PUNCHER].position, sensors.motors[ANGLE_ADJUSTER].position);
+		puncherProfiler.endSection(SECTION_PUNCHER);
+		puncherProfiler.endIteration();
+
         pros::delay(REFRESH_MS);
     }
 }
 
+//----------------------------------------------------------------------------//
+//                           Puncher State Machine                            //
+//----------------------------------------------------------------------------//
+
+//---------- Globals ---------//
+
+PuncherStateMachine puncherStateMachine;
+
+//--------- Functions --------//
+
+PuncherStateMachine::PuncherStateMachine()
+    : puncherSettledUtil(SettledUtilFactory::createPtr(3, 5, 30_ms)),
+      angleSettledUtil(SettledUtilFactory::createPtr(3, 5, 30_ms))
+{
+}
+
+void PuncherStateMachine::requestLaunch()
+{
+    if(isBusy())
+    {
+        launchQueued = true;
+        return;
+    }
+    startLaunch();
+}
+
+void PuncherStateMachine::requestAngle(PuncherAngle &angle)
+{
+    //Don't move the angle adjuster or cap lift out from under a macro
+    if(isBusy())
+    {
+        queuedAngle = &angle;
+        return;
+    }
+    aim(angle);
+    state = State::AIMING;
+}
+
+void PuncherStateMachine::requestDoubleShot(PuncherAngle &firstAngle, PuncherAngle &secondAngle)
+{
+    if(isBusy())
+    {
+        return;
+    }
+    aim(firstAngle);
+    this->secondAngle = &secondAngle;
+    puncherReady = false;
+    state = State::AIMING;
+}
+
+void PuncherStateMachine::aim(PuncherAngle &angle)
+{
+    //The cap lift is the macro's until the macro finishes
+    if(aimAndClearCapLift(angle))
+    {
+        capLiftOwned = true;
+    }
+    angleSettledUtil->reset();
+}
+
+void PuncherStateMachine::startLaunch()
+{
+    puncherReady = false;
+
+    //Move cap lift if interfering, toward the nearer side of the range. An
+    //aim still under way already clears it at the new angle.
+    if(PuncherAngles::CURRENT != nullptr && capLiftInterfering())
+    {
+        if(aimingProfiles->isSettled())
+        {
+            aimAndClearCapLift(*PuncherAngles::CURRENT);
+        }
+        capLiftOwned = true;
+        state = State::CLEARING_CAP_LIFT;
+        return;
+    }
+    startFiring();
+}
+
+void PuncherStateMachine::startFiring()
+{
+    puncherTarget = numLaunches * 360 + 360;
+    movePuncherTo(360);
+
+    //Increment numLaunches after firing
+    numLaunches++;
+
+    puncherSettledUtil->reset();
+    state = State::FIRING;
+}
+
+void PuncherStateMachine::finishShot()
+{
+    //After a double shot's first shot, load the second ball and fire it while
+    //the angle adjuster moves to the second angle
+    if(secondAngle != nullptr)
+    {
+        setIntake(200);
+        intakeOwned = true;
+        aim(*secondAngle);
+        secondAngle = nullptr;
+        finishingDoubleShot = true;
+        startLaunch();
+        return;
+    }
+
+    if(finishingDoubleShot)
+    {
+        setIntake(0);
+        intakeOwned = false;
+        finishingDoubleShot = false;
+    }
+    finishMacro();
+}
+
+void PuncherStateMachine::finishMacro()
+{
+    capLiftOwned = false;
+    puncherReady = true;
+    state = State::IDLE;
+
+    //Start anything requested during the macro; a queued aim is a macro of
+    //its own unless a queued launch takes over
+    if(queuedAngle != nullptr)
+    {
+        aim(*queuedAngle);
+        queuedAngle = nullptr;
+        state = State::AIMING;
+    }
+    if(launchQueued)
+    {
+        launchQueued = false;
+        startLaunch();
+    }
+}
+
+void PuncherStateMachine::update(const SensorSnapshot &sensors)
+{
+    //Evaluated every tick so the settled timers keep running
+    bool angleSettled = PuncherAngles::CURRENT == nullptr ||
+        angleSettledUtil->isSettled(PuncherAngles::CURRENT->getAngleValue() - sensors.motors[ANGLE_ADJUSTER].position);
+    //The profiles end with the motors they moved holding their targets
+    bool aimed = aimingProfiles->isSettled();
+
+    switch(state)
+    {
+        case State::IDLE:
+            break;
+        case State::AIMING:
+            if(aimed && angleSettled)
+            {
+                //Fire a double shot's first shot; otherwise the aim was all
+                if(secondAngle != nullptr)
+                {
+                    startLaunch();
+                }
+                else
+                {
+                    finishMacro();
+                }
+            }
+            break;
+        case State::CLEARING_CAP_LIFT:
+            if(aimed)
+            {
+                startFiring();
+            }
+            break;
+        case State::FIRING:
+            if(puncherSettledUtil->isSettled(puncherTarget - sensors.motors[PUNCHER].position) &&
+                (!finishingDoubleShot || (aimed && angleSettled)))
+            {
+                finishShot();
+            }
+            break;
+    }
+}
+
+PuncherStateMachine::State PuncherStateMachine::getState() const
+{
+    return state;
+}
+
+bool PuncherStateMachine::isBusy() const
+{
+    return state != State::IDLE;
+}
+
+bool PuncherStateMachine::ownsCapLift() const
+{
+    return capLiftOwned;
+}
+
+bool PuncherStateMachine::ownsIntake() const
+{
+    return intakeOwned;
+}
+
 //----------------------------------------------------------------------------//
 //                                  Intake                                   //
 //----------------------------------------------------------------------------//
@@ -0,0 +1,241 @@
+#include "main.h"
+#include "trajectoryStream.hpp"
+#include "splineArcLength.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    //Spacing of the curvature samples profiles are built on (m), and the
+    //fewest samples taken on a spline
+    const double PROFILE_SAMPLE_SPACING = 0.005;
+    const int MIN_SAMPLES_PER_SPLINE = 16;
+}
+
+//----------------------------------------------------------------------------//
+//                                Spline Cursor                               //
+//----------------------------------------------------------------------------//
+
+SplineCursor::SplineCursor(const PoolVector<Spline> &isplines, double iarcLengthTolerance)
+    : splines(isplines), arcLengthTolerance(iarcLengthTolerance)
+{
+}
+
+void SplineCursor::place(Segment &segment)
+{
+    double distance = segment.position - splineStart;
+    while(distance > splines[index].arc_length && index + 1 < splines.size())
+    {
+        splineStart += splines[index].arc_length;
+        distance -= splines[index].arc_length;
+        index++;
+        lastProgress = 0;
+        lastDistance = 0;
+    }
+
+    const Spline &spline = splines[index];
+    double progress = 1;
+    if(distance < spline.arc_length)
+    {
+        progress = splineProgressForDistance(spline, distance, arcLengthTolerance, lastProgress, lastDistance);
+        lastProgress = progress;
+        lastDistance = distance;
+    }
+
+    Coord coords = pf_spline_coords(spline, progress);
+    segment.x = coords.x;
+    segment.y = coords.y;
+    segment.heading = pf_spline_angle(spline, progress);
+}
+
+//----------------------------------------------------------------------------//
+//                                Speed Profile                               //
+//----------------------------------------------------------------------------//
+
+SpeedProfile::SpeedProfile(PoolVector<Sample> isamples) : samples(std::move(isamples))
+{
+    //Fastest speed at each sample that can still be reached from the start
+    //(forward) and still stop by the end (backward); v^2 grows by at most
+    //2 * a * ds between samples
+    samples.front().velocity = 0;
+    for(std::size_t k = 1; k < samples.size(); k++)
+    {
+        const double ds = samples[k].distance - samples[k - 1].distance;
+        samples[k].velocity = std::min(samples[k].maxVel,
+            std::sqrt(samples[k - 1].velocity * samples[k - 1].velocity + 2 * samples[k - 1].maxAccel * ds));
+    }
+    samples.back().velocity = 0;
+    for(std::size_t k = samples.size() - 1; k-- > 0;)
+    {
+        const double ds = samples[k + 1].distance - samples[k].distance;
+        samples[k].velocity = std::min(samples[k].velocity,
+            std::sqrt(samples[k + 1].velocity * samples[k + 1].velocity + 2 * samples[k + 1].maxAccel * ds));
+    }
+
+    //Time at each sample; acceleration is constant between samples, so the
+    //average speed is the mean of the ends
+    samples.front().time = 0;
+    for(std::size_t k = 1; k < samples.size(); k++)
+    {
+        const double ds = samples[k].distance - samples[k - 1].distance;
+        const double speed = samples[k - 1].velocity + samples[k].velocity;
+        samples[k].time = samples[k - 1].time + ((speed > 0) ? 2 * ds / speed : 0);
+    }
+}
+
+double SpeedProfile::getDuration() const
+{
+    return samples.back().time;
+}
+
+void SpeedProfile::at(double time, double &outDistance, double &outVelocity)
+{
+    time = std::min(time, samples.back().time);
+    while(sample + 2 < samples.size() && samples[sample + 1].time <= time)
+    {
+        sample++;
+    }
+
+    const Sample &from = samples[sample];
+    const Sample &to = samples[sample + 1];
+    const double ds = to.distance - from.distance;
+    const double accel = (ds > 0) ? (to.velocity * to.velocity - from.velocity * from.velocity) / (2 * ds) : 0;
+    const double elapsed = time - from.time;
+
+    outVelocity = std::max(0.0, from.velocity + accel * elapsed);
+    outDistance = std::min(to.distance, from.distance + from.velocity * elapsed + accel * elapsed * elapsed / 2);
+}
+
+PoolVector<SpeedProfile::Sample> sampleSplines(const PoolVector<Spline> &splines, double iarcLengthTolerance,
+    const std::function<void(std::size_t, double, SpeedProfile::Sample &)> &limit)
+{
+    auto count = [&splines](std::size_t i) {
+        return std::max(MIN_SAMPLES_PER_SPLINE,
+            static_cast<int>(std::ceil(splines[i].arc_length / PROFILE_SAMPLE_SPACING)));
+    };
+
+    //Size the samples up front, so a pool doesn't keep every size they grow
+    //through
+    std::size_t total = 1;
+    for(std::size_t i = 0; i < splines.size(); i++)
+    {
+        total += count(i);
+    }
+    PoolVector<SpeedProfile::Sample> samples(splines.get_allocator());
+    samples.reserve(total);
+
+    double splineStart = 0;
+    for(std::size_t i = 0; i < splines.size(); i++)
+    {
+        const Spline &spline = splines[i];
+
+        const int samplesOnSpline = count(i);
+        double distance = splineStart;
+        for(int k = 0; k <= samplesOnSpline; k++)
+        {
+            const double progress = static_cast<double>(k) / samplesOnSpline;
+            if(k > 0)
+            {
+                distance += splineArcLength(spline, static_cast<double>(k - 1) / samplesOnSpline, progress,
+                    iarcLengthTolerance / samplesOnSpline);
+            }
+
+            SpeedProfile::Sample sample{distance, 0, 0, 0, 0};
+            limit(i, progress, sample);
+            if(k == 0 && !samples.empty())
+            {
+                //A knot belongs to both splines, and the limits may jump there
+                SpeedProfile::Sample &knot = samples.back();
+                knot.maxVel = std::min(knot.maxVel, sample.maxVel);
+                knot.maxAccel = std::min(knot.maxAccel, sample.maxAccel);
+                continue;
+            }
+            samples.push_back(sample);
+        }
+        splineStart = distance;
+    }
+    return samples;
+}
+
+//----------------------------------------------------------------------------//
+//                              Trajectory Stream                             //
+//----------------------------------------------------------------------------//
+
+TrajectoryStream::TrajectoryStream(PoolVector<Spline> isplines, double imaxVel, double imaxAccel,
+    double iwheelbaseWidth, double iarcLengthTolerance, double idt)
+    : splines(std::move(isplines)), cursor(splines, iarcLengthTolerance), dt(idt), halfWidth(iwheelbaseWidth / 2),
+      //The outer wheel travels (1 + |curvature| * w/2) times as far as the
+      //center, so the center is held to the wheel limits divided by that
+      profile(sampleSplines(splines, iarcLengthTolerance,
+          [this, imaxVel, imaxAccel](std::size_t i, double progress, SpeedProfile::Sample &sample) {
+              const double scale = 1 + std::abs(splineCurvature(splines[i], progress)) * halfWidth;
+              sample.maxVel = imaxVel / scale;
+              sample.maxAccel = imaxAccel / scale;
+          }))
+{
+    length = static_cast<int>(std::ceil(profile.getDuration() / dt - 1e-9));
+    lastCenter.dt = dt;
+}
+
+int TrajectoryStream::getLength() const
+{
+    return length;
+}
+
+double TrajectoryStream::getDt() const
+{
+    return dt;
+}
+
+int TrajectoryStream::getGenerated() const
+{
+    return step;
+}
+
+bool TrajectoryStream::next(Segment &outLeft, Segment &outRight)
+{
+    if(step >= length)
+    {
+        return false;
+    }
+
+    //The center's state at the end of the step
+    Segment center{};
+    center.dt = dt;
+    profile.at((step + 1) * dt, center.position, center.velocity);
+    center.acceleration = (center.velocity - lastCenter.velocity) / dt;
+    center.jerk = (center.acceleration - lastCenter.acceleration) / dt;
+    cursor.place(center);
+    lastCenter = center;
+
+    //Offset the center to each wheel
+    Segment left = center;
+    Segment right = center;
+    const double cosAngle = std::cos(center.heading);
+    const double sinAngle = std::sin(center.heading);
+    left.x = center.x - halfWidth * sinAngle;
+    left.y = center.y + halfWidth * cosAngle;
+    right.x = center.x + halfWidth * sinAngle;
+    right.y = center.y - halfWidth * cosAngle;
+    if(step > 0)
+    {
+        advanceWheel(left, lastLeft);
+        advanceWheel(right, lastRight);
+    }
+    lastLeft = left;
+    lastRight = right;
+    step++;
+
+    outLeft = left;
+    outRight = right;
+    return true;
+}
+
+void TrajectoryStream::advanceWheel(Segment &wheel, const Segment &last) const
+{
+    const double distance = std::hypot(wheel.x - last.x, wheel.y - last.y);
+    wheel.position = last.position + distance;
+    wheel.velocity = distance / dt;
+    wheel.acceleration = (wheel.velocity - last.velocity) / dt;
+    wheel.jerk = (wheel.acceleration - last.acceleration) / dt;
+}